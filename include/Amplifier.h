@@ -11,6 +11,11 @@
 
 // Pre-built libraries
 #include <Arduino.h>	// For arduino functions
+#include <atomic>		// For std::atomic_signal_fence
+
+// Custom libraries
+#include "MotorControl.h"	 // Current trim and position hold
+#include "SharedMemoryDataTypes.h"	 // Shared enumerations
 
 // Hardware serial ports
 #define HWSerialA Serial5	 // AdEx
@@ -30,8 +35,20 @@
 #define PIN_AMPLIFIER_SAFETY 9		 // Safety switch input (can be overriden on control board as well)
 
 // Constants
-const int16_t CONST_PWM_ZERO = 2047;	// Zero output value
-const int16_t CONST_PWM_MAX	 = 1;		// Maximum PWM value
+const int16_t CONST_PWM_ZERO  = 2047;	 // Zero output value
+const int16_t CONST_PWM_MAX	  = 1;		 // Maximum PWM value
+const uint8_t CONST_AMP_COUNT = 3;		 // Number of amplifiers (A, B, C)
+
+// Initialization sequencer timing
+const uint32_t CONST_AMP_RESET_HOLD_US	 = 500000;	  // Enable held low to reset the amplifiers
+const uint32_t CONST_AMP_PORT_SETTLE_US	 = 20000;	  // Wait after opening a port before the first query
+const uint32_t CONST_AMP_STEP_TIMEOUT_US = 100000;	  // Wait for a response before resending the step's query
+const uint8_t  CONST_AMP_STEP_RETRIES	 = 2;		  // Resends per step before the amplifier is marked failed
+const uint32_t CONST_AMP_INITIAL_BAUD	 = 9600;	  // Amplifier baud rate after reset
+
+// Baud rates probed after reset, fastest first
+const uint32_t CONST_AMP_BAUD_CANDIDATES[]	  = { 1000000, 460800, 230400, 115200 };
+const uint8_t  CONST_AMP_BAUD_CANDIDATE_COUNT = sizeof( CONST_AMP_BAUD_CANDIDATES ) / sizeof( CONST_AMP_BAUD_CANDIDATES[0] );
 
 
 
@@ -59,17 +76,446 @@ const int16_t CONST_PWM_MAX	 = 1;		// Maximum PWM value
 
 /**
  * @brief Struct containing ASCII serial commands
+ * 
+ * Indexed by EnumsClass::AmplifierQueryEnum, so a query is identified by a
+ * small integer rather than by comparing command strings.
  */
 struct AsciiStruct {
 
-	String setReset			 = "r\r";				  // Reset
-	String getCurrentReading = "g r0x0c\r";			  // HWSerial command to get current reading
-	String getBaud			 = "g r0x90\r";			  // HWSerial command to get current baud
-	String getEncoderCount	 = "g r0x17\r";			  // HWSerial command to get encoder count
-	String getName			 = "g f0x92\r";			  // HWSerial command to get amp name
-	String setIdle			 = "";					  // HWSerial command for idle
-	String setBaud115237	 = "s r0x90 115237\r";	  // HWSerial command to set baud rate to 115237
-	String setCurrentMode	 = "s r0x24 3\r";		  // HWSerial command to set amplifier in PWM current mode
+	const char* command[uint8_t( EnumsClass::AmplifierQueryEnum::COUNT )] = {
+		"",						// IDLE
+		"r\r",					// RESET: Reset
+		"",						// GET_REGISTER: Poll table register (command stored in the table entry)
+		"g r0x90\r",			// GET_BAUD: Get current baud
+		"g f0x92\r",			// GET_NAME: Get amp name
+		"s r0x90 ",			// SET_BAUD: Set baud rate (rate and \r appended when sent)
+		"s r0x24 3\r",			// SET_CURRENT_MODE: Set amplifier in PWM current mode
+		"g r0x90\r",			// RESYNC: Known query (baud rate) used to realign the link
+	};
+};
+
+
+// Copley binary serial protocol
+const uint8_t CONST_COPLEY_BINARY_NODE		   = 0x00;	  // Node ID of the directly connected amplifier
+const uint8_t CONST_COPLEY_BINARY_CHECKSUM_KEY = 0x5A;	  // XOR of every byte in a valid packet
+const uint8_t CONST_COPLEY_BINARY_OP_GET	   = 0x0C;	  // Get parameter opcode
+const uint8_t CONST_COPLEY_BINARY_HEADER_SIZE  = 4;		  // Node, checksum, word count, opcode / error
+const uint8_t CONST_COPLEY_BINARY_GET_SIZE	   = 6;		  // Header plus one parameter ID word
+
+// Copley registers
+const uint16_t CONST_COPLEY_REG_CURRENT		= 0x0C;	   // Actual current (0.01 A)
+const uint16_t CONST_COPLEY_REG_POSITION	= 0x17;	   // Actual motor position (counts)
+const uint16_t CONST_COPLEY_REG_BUS_VOLTAGE = 0x1E;	   // Bus voltage (0.1 V)
+const uint16_t CONST_COPLEY_REG_DRIVE_TEMP	= 0x20;	   // Drive temperature (degrees C)
+const uint16_t CONST_COPLEY_REG_BAUD		= 0x90;	   // Serial baud rate
+const uint16_t CONST_COPLEY_REG_STATUS		= 0xA0;	   // Event status register
+const uint16_t CONST_COPLEY_REG_FAULT_LATCH = 0xA4;	   // Latched fault register
+
+
+/**
+ * @brief Build a binary get-parameter packet
+ */
+inline void BuildCopleyBinaryGet( uint8_t* packet, uint16_t parameter ) {
+	packet[0] = CONST_COPLEY_BINARY_NODE;
+	packet[2] = 1;
+	packet[3] = CONST_COPLEY_BINARY_OP_GET;
+	packet[4] = uint8_t( parameter >> 8 );
+	packet[5] = uint8_t( parameter & 0xFF );
+	packet[1] = CONST_COPLEY_BINARY_CHECKSUM_KEY ^ packet[0] ^ packet[2] ^ packet[3] ^ packet[4] ^ packet[5];
+}
+
+
+/**
+ * @brief Struct containing Copley binary serial commands
+ * 
+ * Indexed by EnumsClass::AmplifierQueryEnum like AsciiStruct. Only register
+ * reads have a binary form; queries with length 0 always go out as ASCII.
+ * Packet layout: node, checksum, data word count, opcode, then big-endian words.
+ */
+struct BinaryStruct {
+
+	uint8_t command[uint8_t( EnumsClass::AmplifierQueryEnum::COUNT )][CONST_COPLEY_BINARY_GET_SIZE] = {};	 // Packets
+	uint8_t length[uint8_t( EnumsClass::AmplifierQueryEnum::COUNT )]								= {};	 // Packet size in bytes
+
+	void AddGet( EnumsClass::AmplifierQueryEnum query, uint16_t parameter ) {
+		BuildCopleyBinaryGet( command[uint8_t( query )], parameter );
+		length[uint8_t( query )] = CONST_COPLEY_BINARY_GET_SIZE;
+	}
+};
+
+
+/**
+ * @brief Build a binary packet with any opcode and data words
+ * 
+ * @return Packet size in bytes
+ */
+inline uint16_t BuildCopleyBinaryPacket( uint8_t* packet, uint8_t opcode, const uint16_t* words, uint8_t wordCount ) {
+	packet[0]		 = CONST_COPLEY_BINARY_NODE;
+	packet[2]		 = wordCount;
+	packet[3]		 = opcode;
+	uint8_t checksum = CONST_COPLEY_BINARY_CHECKSUM_KEY ^ packet[0] ^ packet[2] ^ packet[3];
+	for ( uint8_t i = 0; i < wordCount; i++ ) {
+		packet[4 + 2 * i] = uint8_t( words[i] >> 8 );
+		packet[5 + 2 * i] = uint8_t( words[i] & 0xFF );
+		checksum ^= packet[4 + 2 * i] ^ packet[5 + 2 * i];
+	}
+	packet[1] = checksum;
+	return CONST_COPLEY_BINARY_HEADER_SIZE + 2 * uint16_t( wordCount );
+}
+
+
+// Copley trace facility (binary opcode 0x11, sub-command in the first data word)
+const uint8_t  CONST_COPLEY_BINARY_OP_TRACE		= 0x11;	   // Trace opcode
+const uint16_t CONST_COPLEY_TRACE_GET_REF_PERIOD = 0x01;	   // Read the trace reference period (ns)
+const uint16_t CONST_COPLEY_TRACE_SET_CHANNELS	= 0x03;	   // Select the variables recorded per sample
+const uint16_t CONST_COPLEY_TRACE_SET_PERIOD	= 0x05;	   // Sample every N reference periods
+const uint16_t CONST_COPLEY_TRACE_START			= 0x06;	   // Start recording
+const uint16_t CONST_COPLEY_TRACE_STOP			= 0x07;	   // Stop recording
+const uint16_t CONST_COPLEY_TRACE_GET_DATA		= 0x08;	   // Upload recorded samples (empty reply once drained)
+const uint16_t CONST_COPLEY_TRACE_VAR_CURRENT	= 0x03;	   // Trace variable: actual current (0.01 A)
+const uint16_t CONST_COPLEY_TRACE_VAR_POSITION	= 0x1C;	   // Trace variable: actual motor position (counts)
+
+// Trace capture sizing
+const uint16_t CONST_TRACE_MAX_SAMPLES		 = 1000;	  // Samples kept per amplifier (1 s at 1 kHz)
+const uint32_t CONST_TRACE_SAMPLE_PERIOD_US	 = 1000;	  // Requested sample period
+const uint16_t CONST_TRACE_FRAME_SIZE		 = 516;		  // Largest binary packet (255 data words)
+const uint32_t CONST_TRACE_STEP_TIMEOUT_US	 = 50000;	  // Wait for a trace reply before giving up
+const uint8_t  CONST_TRACE_CONFIGURE_STEPS	 = 3;		  // Reference period, channels, sample period
+
+
+/**
+ * @brief One amplifier's trace capture
+ * 
+ * The drive records current and position internally at the trace rate; the
+ * host only exchanges a few packets to configure, start and stop it, then
+ * uploads the whole buffer once the event is over. Sensor polling on the port
+ * is paused only while those packets are in flight.
+ */
+struct TraceCaptureStruct {
+
+	EnumsClass::TraceCaptureStateEnum state			  = EnumsClass::TraceCaptureStateEnum::IDLE;	// Capture state
+	uint8_t							  configureStep	  = 0;											// Configuration packet being exchanged
+	volatile bool					  isAwaiting	  = false;										// Trace packet sent, reply not complete (receive path owns the capture while set)
+	uint32_t						  deadlineUs	  = 0;											// Time by which the reply must arrive
+	uint32_t						  refPeriodNs	  = 0;											// Drive trace reference period
+	uint16_t						  periodDivisor	  = 1;											// Reference periods per sample
+	uint32_t						  samplePeriodNs  = CONST_TRACE_SAMPLE_PERIOD_US * 1000;		// Actual sample period
+	uint32_t						  startUs		  = 0;											// Host time of the first sample
+	uint16_t						  sampleCount	  = 0;											// Samples uploaded
+	int32_t							  current[CONST_TRACE_MAX_SAMPLES];								// Current samples (0.01 A)
+	int32_t							  position[CONST_TRACE_MAX_SAMPLES];							// Position samples (counts)
+	uint8_t							  frame[CONST_TRACE_FRAME_SIZE];								// Reply being assembled
+	uint16_t						  frameCount	  = 0;											// Bytes in frame
+
+	// Frame one received byte, true once a whole packet with a valid checksum is in frame
+	bool ReceiveByte( uint8_t incoming ) {
+		if ( frameCount >= CONST_TRACE_FRAME_SIZE ) frameCount = 0;
+		frame[frameCount++] = incoming;
+		if ( frameCount < CONST_COPLEY_BINARY_HEADER_SIZE ) return false;
+		if ( frameCount < CONST_COPLEY_BINARY_HEADER_SIZE + 2 * uint16_t( frame[2] ) ) return false;
+		uint8_t checksum = 0;
+		for ( uint16_t i = 0; i < frameCount; i++ ) checksum ^= frame[i];
+		return checksum == CONST_COPLEY_BINARY_CHECKSUM_KEY;
+	}
+
+	// Data word from the assembled frame
+	uint16_t Word( uint8_t index ) const {
+		return ( uint16_t( frame[4 + 2 * index] ) << 8 ) | frame[5 + 2 * index];
+	}
+};
+
+
+// Register poll table
+const uint8_t CONST_POLL_TABLE_CAPACITY		= 24;	 // Maximum poll table entries across all amplifiers
+const uint8_t CONST_POLL_ASCII_SIZE			= 12;	 // Room for "g r0xNNNN\r"
+const uint8_t CONST_POLL_ASCII_REPLY_BYTES	= 14;	 // Worst-case ASCII reply ("v -2147483648\r")
+const uint8_t CONST_POLL_BINARY_REPLY_BYTES = 8;	 // Binary reply with a 32-bit value
+
+
+/**
+ * @brief One register polled from one amplifier
+ * 
+ * The value is written to the raw and/or scaled destination (either may be
+ * nullptr). Registers that need more than a store (encoder offset, limit
+ * tracking) are also handled by register number in ParseQueryX.
+ */
+struct PollEntryStruct {
+
+	uint16_t parameter						   = 0;		   // Copley register
+	uint8_t	 amp							   = 0;		   // Amplifier index (0 = A, 1 = B, 2 = C)
+	uint8_t	 rateDivisor					   = 1;		   // Polled on every Nth pass of the port's table
+	int32_t* raw							   = nullptr;  // Destination for the register value
+	float*	 scaled							   = nullptr;  // Destination for value * scale
+	float	 scale							   = 1.0f;	   // Scale to engineering units
+	char	 ascii[CONST_POLL_ASCII_SIZE]	   = {};	   // ASCII command
+	uint8_t	 binary[CONST_COPLEY_BINARY_GET_SIZE] = {};	   // Binary command
+};
+
+
+/**
+ * @brief Declarative list of registers to poll
+ */
+struct PollTableStruct {
+
+	PollEntryStruct entry[CONST_POLL_TABLE_CAPACITY];	 // Entries in poll order
+	uint8_t			count = 0;							 // Entries in use
+
+	bool Add( uint16_t parameter, uint8_t amp, uint8_t rateDivisor, int32_t* raw, float* scaled, float scale ) {
+		if ( count >= CONST_POLL_TABLE_CAPACITY ) return false;
+		PollEntryStruct& e = entry[count++];
+		e.parameter		   = parameter;
+		e.amp			   = amp;
+		e.rateDivisor	   = rateDivisor ? rateDivisor : 1;
+		e.raw			   = raw;
+		e.scaled		   = scaled;
+		e.scale			   = scale;
+		snprintf( e.ascii, sizeof( e.ascii ), "g r0x%02x\r", parameter );
+		BuildCopleyBinaryGet( e.binary, parameter );
+		return true;
+	}
+
+	// Next entry due for this amplifier within one table's length, advancing the port's cursor and pass count (-1 if none)
+	int8_t Next( uint8_t amp, uint8_t& cursor, uint32_t& pass ) const {
+		for ( uint8_t i = 0; i < count; i++ ) {
+			uint8_t index = cursor;
+			if ( ++cursor >= count ) {
+				cursor = 0;
+				pass++;
+			}
+			if ( entry[index].amp == amp && ( pass % entry[index].rateDivisor ) == 0 ) return int8_t( index );
+		}
+		return -1;
+	}
+};
+
+
+// HWSerial receive ring size (power of two)
+const uint8_t CONST_AMP_RX_RING_SIZE = 64;
+
+
+/**
+ * @brief Fixed-capacity receive ring for one HWSerial port
+ * 
+ * Holds the bytes of the response line being assembled. Nothing here touches
+ * the heap, and a full ring drops bytes (the line is then parsed as malformed).
+ */
+struct AmpRxRingStruct {
+
+	char	 buffer[CONST_AMP_RX_RING_SIZE];	// Ring storage
+	uint8_t	 head	   = 0;						// Next write position
+	uint8_t	 tail	   = 0;						// Next read position
+	uint32_t overflows = 0;						// Bytes dropped because the ring was full
+
+	bool Push( char c ) {
+		uint8_t next = ( head + 1 ) & ( CONST_AMP_RX_RING_SIZE - 1 );
+		if ( next == tail ) {
+			overflows++;
+			return false;
+		}
+		buffer[head] = c;
+		head		 = next;
+		return true;
+	}
+
+	bool Pop( char& c ) {
+		if ( head == tail ) return false;
+		c	 = buffer[tail];
+		tail = ( tail + 1 ) & ( CONST_AMP_RX_RING_SIZE - 1 );
+		return true;
+	}
+
+	uint8_t Peek( uint8_t offset ) const { return uint8_t( buffer[( tail + offset ) & ( CONST_AMP_RX_RING_SIZE - 1 )] ); }
+	bool	IsEmpty() const { return head == tail; }
+	uint8_t Count() const { return ( head - tail ) & ( CONST_AMP_RX_RING_SIZE - 1 ); }
+	void	Clear() { tail = head; }
+};
+
+
+/**
+ * @brief Struct for a parsed amplifier response
+ */
+struct AmpResponseStruct {
+
+	EnumsClass::AmplifierResponseEnum type	= EnumsClass::AmplifierResponseEnum::NONE;	  // "v", "ok", "e" or malformed
+	int32_t							  value = 0;										  // Value for "v <int>", error code for "e <code>"
+};
+
+
+/**
+ * @brief One parsed response queued for the verbose dump
+ *
+ * The receive path runs in an ISR, so it queues what it parsed and Loop()
+ * does the printing.
+ */
+struct AmpPacketLogStruct {
+
+	uint8_t							  amp	   = 0;											 // Amplifier index
+	EnumsClass::AmplifierQueryEnum	  query	   = EnumsClass::AmplifierQueryEnum::IDLE;		 // Query the response answered
+	AmpResponseStruct				  response = {};										 // Parsed response
+};
+
+
+/**
+ * @brief Struct for one amplifier's initialization sequence
+ * 
+ * Steps advance when the amplifier answers (or after a fixed hold for reset
+ * and port opening), so all three amplifiers come up in parallel.
+ */
+struct AmpInitStruct {
+
+	EnumsClass::AmplifierInitStepEnum step								= EnumsClass::AmplifierInitStepEnum::RESETTING;	   // Current step
+	uint32_t						  stepStartUs						= 0;												   // Time the current step started
+	uint32_t						  stepDurationUs[uint8_t( EnumsClass::AmplifierInitStepEnum::COUNT )] = {};				   // Time spent in each step
+	uint8_t							  retries							= 0;												   // Resends of the current step's query
+	volatile bool					  isResponseReceived				= false;											   // Response to the step's query has arrived (set by the receive ISR)
+	uint8_t							  baudIndex							= 0;												   // Candidate baud rate being probed
+	char							  name[CONST_AMP_RX_RING_SIZE]		= {};												   // Amplifier name (copied to shared memory from loop context)
+	AmpResponseStruct				  response;																				   // Response to the step's query
+};
+
+
+/**
+ * @brief Struct for the per-port sensor query pipeline
+ * 
+ * Each HWSerial port keeps at most one query in flight. The response to a
+ * sensor query immediately triggers the next query on the same port, so the
+ * three amplifiers are polled in parallel rather than in turn.
+ */
+struct SensorPollStruct {
+
+	volatile bool	  isQueryInFlight = false;	  // Query awaiting a response on this port
+	volatile uint32_t deadlineUs	  = 0;		  // Time by which the outstanding query must be answered
+	uint32_t		  deadlineWindowUs = 0;		  // Allowed round trip at the negotiated baud rate
+	volatile bool	  isResyncing	  = false;	  // Waiting for the known-answer query after a fault
+	uint8_t			  resyncAttempts  = 0;		  // Consecutive resync attempts without a matching answer
+	bool			  isLinkLost	  = false;	  // Retries exhausted, resyncing at the backoff rate
+	uint8_t			  nextQuery		  = 0;		  // Poll table cursor
+	uint32_t		  pass			  = 0;		  // Completed passes over the poll table (32 bits, so divisors stay in phase)
+	uint8_t			  entryInFlight	  = 0;		  // Poll table entry awaiting a response
+	volatile uint32_t samplesReceived = 0;		  // Completed sensor responses
+	uint32_t		  parseCyclesLast = 0;		  // CPU cycles spent parsing the last response
+	uint32_t		  parseCyclesMax  = 0;		  // Worst-case CPU cycles spent parsing a response (this stats window)
+	uint32_t		  parseCyclesTotal = 0;		  // CPU cycles spent parsing in this stats window
+};
+
+
+// Receive path
+const bool	   CONST_AMP_RX_IN_ISR		   = true;	   // Parse responses from the receive timer (false: serialEvent after loop, for comparison)
+const uint32_t CONST_AMP_RX_SERVICE_HZ	   = 5000;	   // Receive timer rate
+const uint16_t CONST_AMP_RX_EXTRA_BUFFER   = 256;	   // Added to each UART's receive buffer
+
+
+/**
+ * @brief Latest current and position from one amplifier
+ */
+struct AmpSampleStruct {
+
+	float	 currentAmps  = 0.0f;	 // Latest measured current
+	int32_t	 encoderCount = 0;		 // Latest compensated encoder count
+	uint32_t requestUs	  = 0;		 // Send time of the query behind the newest value
+	uint32_t currentUs	  = 0;		 // Send time of the query behind the current
+	uint32_t positionUs	  = 0;		 // Send time of the query behind the encoder count
+	uint32_t sequence	  = 0;		 // Samples published
+};
+
+
+/**
+ * @brief Single-writer handoff of the latest sample (the receive ISR publishes)
+ */
+using AmpSamplePublisherStruct = SnapshotStruct<AmpSampleStruct>;
+
+
+/**
+ * @brief Loop length against sample age, to show how one drives the other
+ */
+struct SampleAgeStatsStruct {
+
+	uint32_t lastLoopStartUs = 0;	 // Start of the previous loop()
+	uint32_t loopCount		 = 0;	 // Loops measured
+	uint32_t loopSumUs		 = 0;	 // Sum of loop lengths
+	uint32_t loopMaxUs		 = 0;	 // Longest loop
+	uint32_t ageCount		 = 0;	 // Ages measured
+	uint32_t ageSumUs		 = 0;	 // Sum of sample ages
+	uint32_t ageMaxUs		 = 0;	 // Oldest sample seen by the output ISR
+	uint32_t torn			 = 0;	 // Reads that gave up on a sample being rewritten
+
+	void Clear() {
+		loopCount = loopSumUs = loopMaxUs = 0;
+		ageCount = ageSumUs = ageMaxUs = torn = 0;
+	}
+};
+
+
+// Round-trip histogram resolution
+const uint8_t  CONST_AMP_RTT_BUCKETS	= 64;	 // Histogram buckets (last bucket collects everything slower)
+const uint16_t CONST_AMP_RTT_BUCKET_US	= 64;	 // Width of each histogram bucket
+
+
+/**
+ * @brief Struct for per-port link statistics
+ * 
+ * Each query is timestamped when sent and when its terminating byte arrives.
+ * Round-trip times go into a fixed histogram so percentiles cost nothing until
+ * they are printed.
+ */
+struct AmpLinkStatsStruct {
+
+	uint32_t sendUs										 = 0;			   // Time the outstanding query was sent
+	bool	 isAwaitingResponse							 = false;		   // Query sent and not yet answered
+	uint32_t windowStartUs								 = 0;			   // Time the statistics were last cleared
+	uint32_t queriesSent								 = 0;			   // Queries written to the port
+	uint32_t responsesReceived							 = 0;			   // Complete responses received
+	uint32_t timeouts									 = 0;			   // Queries abandoned after their deadline
+	uint32_t malformed									 = 0;			   // Responses that did not parse
+	uint32_t overwritten								 = 0;			   // Queries sent while the previous one was still outstanding
+	uint32_t resyncs									 = 0;			   // Flush-and-resync cycles after a timeout or malformed response
+	uint32_t bytesReceived								 = 0;			   // Bytes read from the port
+	uint32_t rttMinUs									 = UINT32_MAX;	   // Fastest round trip
+	uint32_t rttMaxUs									 = 0;			   // Slowest round trip
+	uint32_t histogram[CONST_AMP_RTT_BUCKETS]			 = {};			   // Round-trip counts by bucket
+
+	void RecordSend( uint32_t nowUs ) {
+		if ( isAwaitingResponse ) overwritten++;
+		sendUs			   = nowUs;
+		isAwaitingResponse = true;
+		queriesSent++;
+	}
+
+	void RecordResponse( uint32_t nowUs ) {
+		if ( !isAwaitingResponse ) return;
+		uint32_t rttUs	   = nowUs - sendUs;
+		isAwaitingResponse = false;
+		responsesReceived++;
+		if ( rttUs < rttMinUs ) rttMinUs = rttUs;
+		if ( rttUs > rttMaxUs ) rttMaxUs = rttUs;
+		uint32_t bucket = rttUs / CONST_AMP_RTT_BUCKET_US;
+		histogram[bucket < CONST_AMP_RTT_BUCKETS ? bucket : CONST_AMP_RTT_BUCKETS - 1]++;
+	}
+
+	// Upper edge of the bucket holding the given percentile
+	uint32_t PercentileUs( uint8_t percent ) const {
+		uint32_t target	= ( uint64_t( responsesReceived ) * percent + 99 ) / 100;
+		uint32_t counted = 0;
+		for ( uint8_t bucket = 0; bucket < CONST_AMP_RTT_BUCKETS; bucket++ ) {
+			counted += histogram[bucket];
+			if ( counted >= target && counted > 0 ) return ( bucket + 1 ) * uint32_t( CONST_AMP_RTT_BUCKET_US );
+		}
+		return 0;
+	}
+
+	void Clear( uint32_t nowUs ) {
+		windowStartUs	  = nowUs;
+		queriesSent		  = 0;
+		responsesReceived = 0;
+		timeouts		  = 0;
+		malformed		  = 0;
+		overwritten		  = 0;
+		resyncs			  = 0;
+		bytesReceived	  = 0;
+		rttMinUs		  = UINT32_MAX;
+		rttMaxUs		  = 0;
+		for ( uint8_t bucket = 0; bucket < CONST_AMP_RTT_BUCKETS; bucket++ ) histogram[bucket] = 0;
+	}
 };
 
 
@@ -132,22 +578,716 @@ struct AsciiStruct {
 // };
 
 
+// Fixed-point drive mapping (heading in centidegrees, magnitude in Q15 where 1 << 15 = 100 %)
+const int32_t CONST_Q15_ONE			  = 1 << 15;												// 1.0 in Q15
+const int32_t CONST_MAP_CDEG_FULL	  = 36000;													// Full turn
+const int32_t CONST_MAP_CDEG_A		  = 3500;													// Motor A angle (35)
+const int32_t CONST_MAP_CDEG_B		  = 14500;													// Motor B angle (145)
+const int32_t CONST_MAP_CDEG_C		  = 27000;													// Motor C angle (270)
+const int32_t CONST_MAP_CDEG_AB		  = CONST_MAP_CDEG_B - CONST_MAP_CDEG_A;					// Sweep A to B (110)
+const int32_t CONST_MAP_CDEG_BC		  = CONST_MAP_CDEG_C - CONST_MAP_CDEG_B;					// Sweep B to C (125)
+const int32_t CONST_MAP_CDEG_CA		  = CONST_MAP_CDEG_FULL - CONST_MAP_CDEG_C + CONST_MAP_CDEG_A;	// Sweep C to A (125)
+const int16_t CONST_MAP_PWM_TOLERANCE = 1;														// Max |fixed - float| in PWM counts over the full sweep
+
+
 /**
  * @brief Struct for mapping motor angles
  */
 struct MappingStruct {
 
-	float		targetRadius   = 0.0f;				   // Radius for polar conversion
-	float		targetAngleDeg = 0.0f;				   // Angle of actuation
-	float		contributionA  = 0.0f;				   // Contribution for motor A
-	float		contributionB  = 0.0f;				   // Contribution for motor B
-	float		contributionC  = 0.0f;				   // Contribution for motor C
-	const float thetaA		   = radians( 35.0f );	   // Motor A angle (35)
-	const float thetaB		   = radians( 145.0f );	   // Motor B angle (145)
-	const float thetaC		   = radians( 270.0f );	   // Motor C angle (270)
-	const float angleAB		   = radians( 110.0f );	   // Sweep angle between angles A and B (110)
-	const float angleBC		   = radians( 125.0f );	   // Sweep angle between angles B and C (125)
-	const float angleAC		   = radians( 125.0f );	   // Sweep angle between angles A and C (125)
+	float		targetRadius   = 0.0f;										 // Radius for polar conversion
+	float		targetAngleDeg = 0.0f;										 // Angle of actuation
+	float		contributionA  = 0.0f;										 // Contribution for motor A
+	float		contributionB  = 0.0f;										 // Contribution for motor B
+	float		contributionC  = 0.0f;										 // Contribution for motor C
+	const float thetaA		   = radians( CONST_MAP_CDEG_A / 100.0f );		 // Motor A angle (35)
+	const float thetaB		   = radians( CONST_MAP_CDEG_B / 100.0f );		 // Motor B angle (145)
+	const float thetaC		   = radians( CONST_MAP_CDEG_C / 100.0f );		 // Motor C angle (270)
+	const float angleAB		   = radians( CONST_MAP_CDEG_AB / 100.0f );	 // Sweep angle between angles A and B (110)
+	const float angleBC		   = radians( CONST_MAP_CDEG_BC / 100.0f );	 // Sweep angle between angles B and C (125)
+	const float angleAC		   = radians( CONST_MAP_CDEG_CA / 100.0f );	 // Sweep angle between angles A and C (125)
+};
+
+
+
+/**
+ * @brief Map a Q15 contribution to a PWM value (integer twin of MapPercentageToPwmABC)
+ */
+inline int16_t MapQ15ToPwm( int32_t percentQ15 ) {
+	int32_t pwm = 2048 - ( ( percentQ15 * 2047 ) >> 15 );
+	return int16_t( pwm < 4 ? 4 : ( pwm > 2044 ? 2044 : pwm ) );
+}
+
+
+// Predictive encoder limit guard
+const float	   CONST_LIMIT_MARGIN_COUNTS	   = 100.0f;	// Predicted distance to the limit over which drive is scaled down to zero
+const uint32_t CONST_LIMIT_DEFAULT_INTERVAL_US = 20000;		// Encoder sample interval assumed until one is measured (50 Hz)
+const uint32_t CONST_LIMIT_MAX_INTERVAL_US	   = 200000;	// Longer gaps are not used for velocity or interval estimates
+
+
+/**
+ * @brief Per-motor encoder limit guard
+ * 
+ * Velocity comes from consecutive timestamped encoder samples. Each tick the
+ * guard predicts where the count will be when the next sample arrives, and
+ * scales the drive down linearly over the last CONST_LIMIT_MARGIN_COUNTS
+ * before the limit, reaching zero at it. Only motion toward the limit
+ * (increasing count) is anticipated. Overshoot is recorded per session,
+ * which runs for as long as the limits stay enabled.
+ */
+struct EncoderLimitGuardStruct {
+
+	// Estimate
+	int32_t	 lastCount		= 0;								  // Encoder count of the newest sample
+	uint32_t lastPositionUs = 0;								  // Time of the newest sample
+	bool	 hasPosition	= false;							  // A sample has been seen
+	float	 velocityCps	= 0.0f;								  // Filtered velocity (counts/s)
+	float	 intervalUs		= CONST_LIMIT_DEFAULT_INTERVAL_US;	  // Filtered encoder sample interval
+	float	 predictedCount = 0.0f;								  // Count expected at the next sample
+	float	 scale			= 1.0f;								  // Drive scale applied on the last tick
+
+	// Session
+	uint32_t sessionStartUs		= 0;		// Time limits were enabled
+	uint32_t crossings			= 0;		// Times the count went past the limit
+	uint32_t samplesOver		= 0;		// Encoder samples past the limit
+	int32_t	 maxOvershootCounts = 0;		// Furthest past the limit
+	int32_t	 sumOvershootCounts = 0;		// Sum of each crossing's furthest point
+	int32_t	 crossingPeakCounts = 0;		// Furthest point of the crossing in progress
+	bool	 isOver				= false;	// Count currently past the limit
+	uint32_t ticksScaled		= 0;		// Ticks with the drive scaled down
+	float	 minScale			= 1.0f;		// Smallest scale applied
+
+	void StartSession( uint32_t nowUs ) {
+		sessionStartUs	   = nowUs;
+		crossings		   = 0;
+		samplesOver		   = 0;
+		maxOvershootCounts = 0;
+		sumOvershootCounts = 0;
+		crossingPeakCounts = 0;
+		isOver			   = false;
+		ticksScaled		   = 0;
+		minScale		   = 1.0f;
+	}
+
+	/**
+	 * @brief Take a new encoder sample (ignored if already seen)
+	 */
+	void OnPosition( int32_t count, uint32_t sampleUs, int32_t limit ) {
+
+		if ( hasPosition && sampleUs == lastPositionUs ) return;
+
+		if ( hasPosition ) {
+			uint32_t dtUs = sampleUs - lastPositionUs;
+			if ( dtUs > 0 && dtUs < CONST_LIMIT_MAX_INTERVAL_US ) {
+				velocityCps += 0.5f * ( ( count - lastCount ) * 1000000.0f / dtUs - velocityCps );
+				intervalUs += 0.1f * ( dtUs - intervalUs );
+			} else {
+				velocityCps = 0.0f;
+			}
+		}
+		lastCount	   = count;
+		lastPositionUs = sampleUs;
+		hasPosition	   = true;
+
+		// Overshoot
+		int32_t over = count - limit;
+		if ( over > 0 ) {
+			if ( !isOver ) {
+				crossings++;
+				crossingPeakCounts = 0;
+				isOver			   = true;
+			}
+			samplesOver++;
+			if ( over > crossingPeakCounts ) crossingPeakCounts = over;
+			if ( over > maxOvershootCounts ) maxOvershootCounts = over;
+		} else if ( isOver ) {
+			sumOvershootCounts += crossingPeakCounts;
+			isOver = false;
+		}
+	}
+
+	/**
+	 * @brief Drive scale for this tick, 0 to 1
+	 */
+	float Update( int32_t limit, uint32_t nowUs ) {
+
+		if ( !hasPosition ) return scale = 1.0f;
+
+		// Until the next sample arrives (or now, if it is overdue)
+		float horizonUs = fmaxf( intervalUs, float( nowUs - lastPositionUs ) );
+		predictedCount	= lastCount + fmaxf( velocityCps, 0.0f ) * horizonUs / 1000000.0f;
+
+		scale = constrain( ( limit - predictedCount ) / CONST_LIMIT_MARGIN_COUNTS, 0.0f, 1.0f );
+		if ( scale < 1.0f ) ticksScaled++;
+		if ( scale < minScale ) minScale = scale;
+		return scale;
+	}
+};
+
+
+// Polar range-of-motion map
+const uint16_t CONST_ROM_BINS			= 360;								// Heading bins over one turn
+const int32_t  CONST_ROM_BIN_CDEG		= CONST_MAP_CDEG_FULL / CONST_ROM_BINS;	// Width of one bin (centidegrees)
+const int32_t  CONST_ROM_BACKOFF_Q15	= 29491;							// Bin cap after a limit crossing, as a fraction of the command (0.9)
+const uint32_t CONST_ROM_EEPROM_MAGIC	= 0x524F4D31;						// "ROM1"
+const uint16_t CONST_ROM_EEPROM_VERSION = 1;								// Bump when the stored layout changes
+const int	   CONST_ROM_EEPROM_ADDRESS = 0;								// Start of the stored map in EEPROM
+
+static_assert( CONST_MAP_CDEG_FULL % CONST_ROM_BINS == 0, "ROM bins must divide a full turn evenly" );
+
+
+/**
+ * @brief Stored form of the range-of-motion map
+ */
+struct RomMapImageStruct {
+
+	uint32_t magic					= 0;	 // CONST_ROM_EEPROM_MAGIC when written by this firmware
+	uint16_t version				= 0;	 // CONST_ROM_EEPROM_VERSION
+	uint16_t binCount				= 0;	 // CONST_ROM_BINS
+	uint16_t maxQ15[CONST_ROM_BINS] = {};	 // Largest safe magnitude per heading bin (Q15)
+	uint32_t checksum				= 0;	 // Over everything above
+
+	uint32_t Checksum() const {
+		uint32_t sum = magic ^ ( uint32_t( version ) << 16 ) ^ binCount;
+		for ( uint16_t i = 0; i < CONST_ROM_BINS; i++ ) sum = ( sum << 5 ) + sum + maxQ15[i];
+		return sum;
+	}
+
+	bool IsValid() const {
+		return magic == CONST_ROM_EEPROM_MAGIC && version == CONST_ROM_EEPROM_VERSION && binCount == CONST_ROM_BINS && checksum == Checksum();
+	}
+};
+
+
+/**
+ * @brief Largest safe command magnitude per heading
+ * 
+ * Built during a guided sweep: while recording, each output tick credits the
+ * commanded heading's bin with the commanded magnitude if every motor is
+ * inside its encoder limit, and caps the bin below the command if any motor
+ * is past it. Bins the sweep never reached are filled from the smaller of
+ * their nearest recorded neighbours. Clamping is one table read per command.
+ */
+struct RomMapStruct {
+
+	RomMapImageStruct Image;						// Bins, as stored
+	bool			  isVisited[CONST_ROM_BINS];	// Bin reached during the recording
+	uint32_t		  ticksRecorded = 0;			// Output ticks credited to a bin
+	uint32_t		  ticksOver		= 0;			// Of those, ticks with a motor past its limit
+	uint32_t		  clampedTicks	= 0;			// Commands reduced by the map
+
+	static uint16_t Bin( int32_t headingCdeg ) {
+		int32_t heading = headingCdeg % CONST_MAP_CDEG_FULL;
+		if ( heading < 0 ) heading += CONST_MAP_CDEG_FULL;
+		return uint16_t( heading / CONST_ROM_BIN_CDEG );
+	}
+
+	/**
+	 * @brief Command magnitude limited to the bin's maximum
+	 */
+	int32_t ClampQ15( int32_t headingCdeg, int32_t magnitudeQ15 ) {
+		int32_t maximum = Image.maxQ15[Bin( headingCdeg )];
+		if ( magnitudeQ15 <= maximum ) return magnitudeQ15;
+		clampedTicks++;
+		return maximum;
+	}
+
+	/**
+	 * @brief Clear every bin for a new recording
+	 */
+	void StartRecording() {
+		for ( uint16_t i = 0; i < CONST_ROM_BINS; i++ ) {
+			Image.maxQ15[i] = 0;
+			isVisited[i]	= false;
+		}
+		ticksRecorded = 0;
+		ticksOver	  = 0;
+	}
+
+	/**
+	 * @brief Credit or cap the commanded heading's bin (output ISR)
+	 */
+	void Record( int32_t headingCdeg, int32_t magnitudeQ15, bool isWithinLimits ) {
+
+		uint16_t  bin	  = Bin( headingCdeg );
+		uint16_t& maximum = Image.maxQ15[bin];
+		int32_t	  value	  = magnitudeQ15 < 0 ? 0 : ( magnitudeQ15 > CONST_Q15_ONE ? CONST_Q15_ONE : magnitudeQ15 );
+
+		if ( isWithinLimits ) {
+			if ( value > maximum ) maximum = uint16_t( value );
+		} else {
+			int32_t capped = ( value * CONST_ROM_BACKOFF_Q15 ) >> 15;
+			if ( !isVisited[bin] || capped < maximum ) maximum = uint16_t( capped );
+			ticksOver++;
+		}
+		isVisited[bin] = true;
+		ticksRecorded++;
+	}
+
+	/**
+	 * @brief Fill the bins the sweep missed and seal the image
+	 * 
+	 * @return Number of bins reached (0 leaves the map invalid)
+	 */
+	uint16_t FinishRecording() {
+
+		uint16_t visited = 0;
+		for ( uint16_t i = 0; i < CONST_ROM_BINS; i++ ) visited += isVisited[i];
+		if ( visited == 0 ) {
+			Image.magic = 0;
+			return 0;
+		}
+
+		// Nearest recorded bin on either side, keeping the smaller
+		uint16_t filled[CONST_ROM_BINS];
+		for ( uint16_t i = 0; i < CONST_ROM_BINS; i++ ) {
+			if ( isVisited[i] ) {
+				filled[i] = Image.maxQ15[i];
+				continue;
+			}
+			uint16_t up = i, down = i;
+			while ( !isVisited[up] ) up = ( up + 1 ) % CONST_ROM_BINS;
+			while ( !isVisited[down] ) down = ( down + CONST_ROM_BINS - 1 ) % CONST_ROM_BINS;
+			filled[i] = Image.maxQ15[up] < Image.maxQ15[down] ? Image.maxQ15[up] : Image.maxQ15[down];
+		}
+		for ( uint16_t i = 0; i < CONST_ROM_BINS; i++ ) Image.maxQ15[i] = filled[i];
+
+		Seal();
+		return visited;
+	}
+
+	/**
+	 * @brief Fill every bin from limits measured at evenly spaced headings
+	 * 
+	 * Each bin takes the smaller of the two headings either side of it,
+	 * backed off like a limit crossing during a recording. A heading given
+	 * as CONST_Q15_ONE found no limit, so bins between two of those stay
+	 * uncapped.
+	 */
+	void FillFromHeadings( const uint16_t* limitQ15, uint16_t headingCount ) {
+		for ( uint16_t i = 0; i < CONST_ROM_BINS; i++ ) {
+			uint16_t below = uint16_t( uint32_t( i ) * headingCount / CONST_ROM_BINS );
+			uint16_t above = ( below + 1 ) % headingCount;
+			int32_t	 lower = limitQ15[below] < limitQ15[above] ? limitQ15[below] : limitQ15[above];
+			Image.maxQ15[i] = uint16_t( lower >= CONST_Q15_ONE ? CONST_Q15_ONE : ( lower * CONST_ROM_BACKOFF_Q15 ) >> 15 );
+			isVisited[i]	= true;
+		}
+		Seal();
+	}
+
+	void Seal() {
+		Image.magic	   = CONST_ROM_EEPROM_MAGIC;
+		Image.version  = CONST_ROM_EEPROM_VERSION;
+		Image.binCount = CONST_ROM_BINS;
+		Image.checksum = Image.Checksum();
+	}
+};
+
+
+// Automated encoder limit sweep
+const uint8_t  CONST_SWEEP_HEADINGS		   = 36;																		// Headings per sweep (10 deg apart)
+const uint8_t  CONST_SWEEP_START_PERCENT   = 4;																			// First magnitude tried at each heading
+const uint8_t  CONST_SWEEP_STEP_PERCENT	   = 2;																			// Magnitude step
+const uint8_t  CONST_SWEEP_MAX_PERCENT	   = 50;																		// Highest magnitude tried
+const uint8_t  CONST_SWEEP_MAX_STEPS	   = ( CONST_SWEEP_MAX_PERCENT - CONST_SWEEP_START_PERCENT ) / CONST_SWEEP_STEP_PERCENT + 1;	// Magnitudes per heading
+const uint16_t CONST_SWEEP_DWELL_MS		   = 150;																		// Time at each magnitude before measuring
+const uint16_t CONST_SWEEP_RELEASE_STEP_MS = 10;																		// Time per step while ramping back to zero
+const uint16_t CONST_SWEEP_SETTLE_MS	   = 300;																		// Rest at zero before the next heading
+const float	   CONST_SWEEP_MOVING_CPS	   = 200.0f;																	// Encoder speed that counts as moving
+const float	   CONST_SWEEP_STALL_CPS	   = 50.0f;																		// Encoder speed that counts as stalled, once moving
+const uint8_t  CONST_SWEEP_STALL_STEPS	   = 2;																			// Consecutive stalled steps that mark the limit
+const uint32_t CONST_SWEEP_MAX_MS		   = uint32_t( CONST_SWEEP_HEADINGS ) * ( CONST_SWEEP_MAX_STEPS * CONST_SWEEP_DWELL_MS + ( CONST_SWEEP_MAX_PERCENT / CONST_SWEEP_STEP_PERCENT ) * CONST_SWEEP_RELEASE_STEP_MS + CONST_SWEEP_SETTLE_MS );	  // Longest possible sweep
+
+
+/**
+ * @brief Encoder and current response at one sweep magnitude
+ */
+struct RomSweepStepStruct {
+
+	uint8_t headingIndex	 = 0;				// Sweep heading
+	uint8_t magnitudePercent = 0;				// Commanded magnitude
+	float	speedCps		 = 0.0f;			// Fastest winding motor over the dwell (counts/s)
+	int16_t currentCa[3]	 = { 0, 0, 0 };		// Motor currents at the end of the dwell (centiamps)
+	int32_t count[3]		 = { 0, 0, 0 };		// Encoder counts at the end of the dwell
+};
+
+
+/**
+ * @brief Travel limit found at one sweep heading
+ */
+struct RomSweepPointStruct {
+
+	uint8_t limitPercent   = 0;						  // Largest magnitude that still moved the ring (or the sweep maximum)
+	bool	isStalled	   = false;					  // Limit found from a stall rather than the sweep maximum
+	int32_t count[3]	   = { 0, 0, 0 };			  // Encoder counts at the limit
+	float	currentAmps[3] = { 0.0f, 0.0f, 0.0f };	  // Motor currents at the limit
+};
+
+
+/**
+ * @brief State of the automated sweep (output ISR) and its calibration table
+ * 
+ * At each heading the magnitude starts at CONST_SWEEP_START_PERCENT and is
+ * raised one step per dwell. The ring is at its travel limit once it has
+ * moved and then the fastest winding motor stays below CONST_SWEEP_STALL_CPS
+ * for CONST_SWEEP_STALL_STEPS dwells. The magnitude is then ramped back to
+ * zero, the ring settles and the next heading starts, so the whole ring
+ * takes at most CONST_SWEEP_MAX_MS.
+ */
+struct RomSweepStruct {
+
+	// Progress (ISR)
+	EnumsClass::RomSweepStateEnum state				= EnumsClass::RomSweepStateEnum::IDLE;	  // Sweep phase
+	uint8_t						  headingIndex		= 0;									  // Heading being swept
+	float						  magnitudePercent	= 0.0f;									  // Magnitude being commanded
+	uint32_t					  stateStartUs		= 0;									  // Start of the current dwell or phase
+	int32_t						  stepStartCount[3] = { 0, 0, 0 };						  // Counts at the start of the dwell
+	bool						  hasMoved			= false;								  // Ring has moved at this heading
+	uint8_t						  stalledSteps		= 0;									  // Consecutive stalled dwells
+	uint8_t						  lastMovingPercent = 0;									  // Magnitude of the last dwell that moved the ring
+	bool						  isStopQueued		= false;								  // Stop event already sent to loop()
+
+	// Session
+	uint32_t startUs		 = 0;		   // micros() at the start of the sweep
+	uint32_t finishUs		 = 0;		   // micros() at the end of the sweep
+	bool	 wasLimitEnabled = false;	   // Limit enforcement to restore afterwards
+
+	// Calibration table
+	RomSweepPointStruct Point[CONST_SWEEP_HEADINGS];							// Limit per heading
+	RomSweepStepStruct	Step[CONST_SWEEP_HEADINGS * CONST_SWEEP_MAX_STEPS];	// Every dwell, in order
+	uint16_t			stepCount = 0;											// Dwells recorded
+
+	static float HeadingDeg( uint8_t index ) {
+		return index * 360.0f / CONST_SWEEP_HEADINGS;
+	}
+};
+
+
+// Slew limiter transition measurement
+const int16_t  CONST_SLEW_STEP_COUNTS  = 20;	// Command change in one tick that counts as a step
+const uint16_t CONST_SLEW_SETTLE_TICKS = 50;	// Ticks at the command before a transition is closed
+
+
+/**
+ * @brief Move a limiter output one tick toward its target
+ * 
+ * Without the S-curve the output moves at most maxDelta per tick. With it,
+ * the rate itself changes by at most maxAccel per tick, and is capped at
+ * the speed from which the output can still stop at the target, so steps
+ * become S-shaped ramps. Constant work per call.
+ * 
+ * @param target PWM the command asks for
+ * @param output Limiter output (updated)
+ * @param rate PWM change on the previous tick (updated)
+ */
+inline void StepSlewLimiter( float target, float& output, float& rate, float maxDelta, float maxAccel, bool isSCurve ) {
+
+	float error = target - output;
+
+	if ( !isSCurve ) {
+		rate = constrain( error, -maxDelta, maxDelta );
+		output += rate;
+		return;
+	}
+
+	// Close enough to stop this tick
+	if ( fabsf( error ) <= maxAccel && fabsf( rate ) <= maxAccel ) {
+		rate   = error;
+		output = target;
+		return;
+	}
+
+	// Fastest rate that still stops in time: v + (v - a) + ... + a <= |error|
+	float stoppingRate = 0.5f * ( sqrtf( maxAccel * maxAccel + 8.0f * maxAccel * fabsf( error ) ) - maxAccel );
+	float desiredRate  = copysignf( fminf( maxDelta, stoppingRate ), error );
+	rate += constrain( desiredRate - rate, -maxAccel, maxAccel );
+	output += rate;
+}
+
+
+/**
+ * @brief Peak current through one command transition
+ * 
+ * A transition starts when the command steps by more than
+ * CONST_SLEW_STEP_COUNTS in one tick and ends CONST_SLEW_SETTLE_TICKS after
+ * the limiter output reaches the command. The peak comes from the polled
+ * current samples, so it is measured with or without the limiter.
+ */
+struct SlewTransitionStruct {
+
+	int16_t	 lastTarget		= CONST_PWM_ZERO;	 // Command on the previous tick
+	bool	 isActive		= false;			 // Transition in progress
+	int16_t	 stepCounts		= 0;				 // Command change that started it
+	uint16_t ticks			= 0;				 // Ticks since it started
+	uint16_t settledTicks	= 0;				 // Ticks with the output at the command
+	float	 peakAmps		= 0.0f;				 // Largest current so far
+	float	 latestAmps		= 0.0f;				 // Most recent current
+	uint32_t transitions	= 0;				 // Completed transitions
+	int16_t	 lastStepCounts = 0;				 // Step of the last completed transition
+	uint16_t lastTicks		= 0;				 // Length of the last completed transition
+	float	 lastPeakAmps	= 0.0f;				 // Peak current of the last completed transition
+	float	 lastFinalAmps	= 0.0f;				 // Settled current of the last completed transition
+	float	 worstPeakAmps	= 0.0f;				 // Largest peak since the stats were cleared
+
+	void Update( int16_t target, int16_t output, float amps ) {
+
+		int16_t step = target - lastTarget;
+		lastTarget	 = target;
+		latestAmps	 = amps;
+
+		if ( abs( step ) > CONST_SLEW_STEP_COUNTS ) {
+			if ( !isActive ) {
+				isActive   = true;
+				stepCounts = 0;
+				ticks	   = 0;
+				peakAmps   = 0.0f;
+			}
+			stepCounts += step;
+			settledTicks = 0;
+		}
+
+		if ( !isActive ) return;
+
+		ticks++;
+		if ( fabsf( amps ) > peakAmps ) peakAmps = fabsf( amps );
+		settledTicks = ( output == target ) ? settledTicks + 1 : 0;
+
+		if ( settledTicks >= CONST_SLEW_SETTLE_TICKS ) {
+			isActive	   = false;
+			lastStepCounts = stepCounts;
+			lastTicks	   = ticks;
+			lastPeakAmps   = peakAmps;
+			lastFinalAmps  = fabsf( amps );
+			if ( peakAmps > worstPeakAmps ) worstPeakAmps = peakAmps;
+			transitions++;
+		}
+	}
+};
+
+
+/**
+ * @brief Sector blend of the two motors either side of a heading, in Q15
+ * 
+ * @param heading Heading in centidegrees (0..35999)
+ * @param magnitudeQ15 Magnitude in Q15 (0 to CONST_Q15_ONE)
+ * @param percent Output contributions for A, B, C
+ */
+constexpr void MapHeadingToContributionsQ15( int32_t heading, int32_t magnitudeQ15, int32_t* percent ) {
+
+	percent[0] = 0;
+	percent[1] = 0;
+	percent[2] = 0;
+
+	// Between C and A (wraps through 0)
+	if ( heading >= CONST_MAP_CDEG_C || heading < CONST_MAP_CDEG_A ) {
+		int32_t fromC = ( heading >= CONST_MAP_CDEG_C ) ? heading - CONST_MAP_CDEG_C : heading + CONST_MAP_CDEG_FULL - CONST_MAP_CDEG_C;
+		percent[2]	  = ( ( CONST_MAP_CDEG_CA - fromC ) * magnitudeQ15 ) / CONST_MAP_CDEG_CA;
+		percent[0]	  = ( fromC * magnitudeQ15 ) / CONST_MAP_CDEG_CA;
+	}
+	// Between A and B
+	else if ( heading < CONST_MAP_CDEG_B ) {
+		int32_t fromA = heading - CONST_MAP_CDEG_A;
+		percent[0]	  = ( ( CONST_MAP_CDEG_AB - fromA ) * magnitudeQ15 ) / CONST_MAP_CDEG_AB;
+		percent[1]	  = ( fromA * magnitudeQ15 ) / CONST_MAP_CDEG_AB;
+	}
+	// Between B and C
+	else {
+		int32_t fromB = heading - CONST_MAP_CDEG_B;
+		percent[1]	  = ( ( CONST_MAP_CDEG_BC - fromB ) * magnitudeQ15 ) / CONST_MAP_CDEG_BC;
+		percent[2]	  = ( fromB * magnitudeQ15 ) / CONST_MAP_CDEG_BC;
+	}
+}
+
+
+/**
+ * @brief Map heading and magnitude to three PWM values with integer math only
+ * 
+ * Same sector blend as MapPolarTermsToCommandOutput, with both rounding steps
+ * truncating, so results stay within CONST_MAP_PWM_TOLERANCE of the float path.
+ * 
+ * @param headingCdeg Heading in centidegrees (any value, wrapped to 0..35999)
+ * @param magnitudeQ15 Magnitude in Q15 (0 to CONST_Q15_ONE)
+ * @param pwm Output PWM values for A, B, C
+ */
+inline void MapPolarTermsToPwmQ15( int32_t headingCdeg, int32_t magnitudeQ15, int16_t* pwm ) {
+
+	int32_t heading = headingCdeg % CONST_MAP_CDEG_FULL;
+	if ( heading < 0 ) heading += CONST_MAP_CDEG_FULL;
+
+	int32_t percent[3] = {};
+	MapHeadingToContributionsQ15( heading, magnitudeQ15, percent );
+
+	pwm[0] = MapQ15ToPwm( percent[0] );
+	pwm[1] = MapQ15ToPwm( percent[1] );
+	pwm[2] = MapQ15ToPwm( percent[2] );
+}
+
+
+// Heading lookup table (one entry per degree, plus a copy of 0 so interpolation wraps without a branch)
+const int32_t CONST_MAP_LUT_STEP_CDEG = 100;											 // Heading step between entries
+const int32_t CONST_MAP_LUT_SIZE	  = CONST_MAP_CDEG_FULL / CONST_MAP_LUT_STEP_CDEG + 1;	 // Entries
+
+static_assert( CONST_MAP_CDEG_A < CONST_MAP_CDEG_B && CONST_MAP_CDEG_B < CONST_MAP_CDEG_C && CONST_MAP_CDEG_C < CONST_MAP_CDEG_FULL, "Motor angles must be ordered A < B < C within one turn" );
+static_assert( CONST_MAP_CDEG_A % CONST_MAP_LUT_STEP_CDEG == 0 && CONST_MAP_CDEG_B % CONST_MAP_LUT_STEP_CDEG == 0 && CONST_MAP_CDEG_C % CONST_MAP_LUT_STEP_CDEG == 0,
+			   "Motor angles must fall on table entries for interpolation to match the sector blend" );
+
+
+/**
+ * @brief Unit-magnitude contributions at one table heading (Q15)
+ */
+struct MapContributionStruct {
+
+	uint16_t a = 0;	   // Contribution for motor A
+	uint16_t b = 0;	   // Contribution for motor B
+	uint16_t c = 0;	   // Contribution for motor C
+};
+
+
+/**
+ * @brief Heading-to-contribution table, generated at compile time from the motor angles
+ * 
+ * The blend is linear between motor angles, and every motor angle lands on an
+ * entry, so interpolating between entries reproduces the sector blend without
+ * picking a sector or dividing by a sweep angle.
+ */
+struct MapLookupTableStruct {
+
+	MapContributionStruct entry[CONST_MAP_LUT_SIZE] = {};	 // Contributions by heading step
+
+	constexpr MapLookupTableStruct() {
+		for ( int32_t i = 0; i < CONST_MAP_LUT_SIZE; i++ ) {
+			int32_t percent[3] = {};
+			MapHeadingToContributionsQ15( ( i * CONST_MAP_LUT_STEP_CDEG ) % CONST_MAP_CDEG_FULL, CONST_Q15_ONE, percent );
+			entry[i].a = uint16_t( percent[0] );
+			entry[i].b = uint16_t( percent[1] );
+			entry[i].c = uint16_t( percent[2] );
+		}
+	}
+};
+
+constexpr MapLookupTableStruct CONST_MAP_LUT;	 // Regenerated whenever CONST_MAP_CDEG_A/B/C change
+
+
+/**
+ * @brief Map heading and magnitude to three PWM values through CONST_MAP_LUT
+ * 
+ * Two table loads, an interpolation and one multiply per motor. Stays within
+ * CONST_MAP_PWM_TOLERANCE of the float path like MapPolarTermsToPwmQ15.
+ * 
+ * @param headingCdeg Heading in centidegrees (any value, wrapped to 0..35999)
+ * @param magnitudeQ15 Magnitude in Q15 (0 to CONST_Q15_ONE)
+ * @param pwm Output PWM values for A, B, C
+ */
+inline void MapPolarTermsToPwmLut( int32_t headingCdeg, int32_t magnitudeQ15, int16_t* pwm ) {
+
+	int32_t heading = headingCdeg % CONST_MAP_CDEG_FULL;
+	if ( heading < 0 ) heading += CONST_MAP_CDEG_FULL;
+
+	int32_t						 index = heading / CONST_MAP_LUT_STEP_CDEG;
+	int32_t						 frac  = heading - index * CONST_MAP_LUT_STEP_CDEG;
+	const MapContributionStruct& lo	   = CONST_MAP_LUT.entry[index];
+	const MapContributionStruct& hi	   = CONST_MAP_LUT.entry[index + 1];
+
+	int32_t a = lo.a + ( ( int32_t( hi.a ) - lo.a ) * frac ) / CONST_MAP_LUT_STEP_CDEG;
+	int32_t b = lo.b + ( ( int32_t( hi.b ) - lo.b ) * frac ) / CONST_MAP_LUT_STEP_CDEG;
+	int32_t c = lo.c + ( ( int32_t( hi.c ) - lo.c ) * frac ) / CONST_MAP_LUT_STEP_CDEG;
+
+	pwm[0] = MapQ15ToPwm( ( a * magnitudeQ15 ) >> 15 );
+	pwm[1] = MapQ15ToPwm( ( b * magnitudeQ15 ) >> 15 );
+	pwm[2] = MapQ15ToPwm( ( c * magnitudeQ15 ) >> 15 );
+}
+
+
+
+/**
+ * @brief Three-cable force allocation with a minimum-tension floor
+ * 
+ * Cable i pulls along u_i (the motor angle), so a tension vector t produces
+ * the force U * t. The minimum-norm solution is t = pinv(U) * F. Adding any
+ * multiple of the null vector n (every component positive for a ring) leaves
+ * the force unchanged, so the smallest multiple that lifts every cable to the
+ * floor gives the lowest tensions that still hold the floor. Every step is
+ * closed-form, and all three cables blend smoothly across motor angles.
+ * Tensions are fractions of full scale (same units as MapPercentageToPwmABC).
+ */
+struct CableAllocatorStruct {
+
+	float	 pinv[3][2]		 = {};	  // Minimum-norm solution per unit force (x, y)
+	float	 nullInverse[3]	 = {};	  // 1 / null vector component, per cable
+	float	 null[3]		 = {};	  // Null vector (tensions with zero net force)
+	uint32_t saturations	 = 0;	  // Requests scaled down to keep every cable at or below full scale
+	uint32_t cyclesLast		 = 0;	  // CPU cycles for the last allocation
+	uint32_t cyclesMax		 = 0;	  // Worst-case CPU cycles for an allocation
+
+	CableAllocatorStruct() {
+
+		const int32_t angleCdeg[3] = { CONST_MAP_CDEG_A, CONST_MAP_CDEG_B, CONST_MAP_CDEG_C };
+		float		  ux[3];
+		float		  uy[3];
+		for ( uint8_t i = 0; i < 3; i++ ) {
+			ux[i] = cosf( radians( angleCdeg[i] / 100.0f ) );
+			uy[i] = sinf( radians( angleCdeg[i] / 100.0f ) );
+		}
+
+		// pinv(U) = U^T * inverse( U * U^T )
+		float xx = 0.0f, xy = 0.0f, yy = 0.0f;
+		for ( uint8_t i = 0; i < 3; i++ ) {
+			xx += ux[i] * ux[i];
+			xy += ux[i] * uy[i];
+			yy += uy[i] * uy[i];
+		}
+		float det = xx * yy - xy * xy;
+		for ( uint8_t i = 0; i < 3; i++ ) {
+			pinv[i][0] = ( ux[i] * yy - uy[i] * xy ) / det;
+			pinv[i][1] = ( uy[i] * xx - ux[i] * xy ) / det;
+		}
+
+		// n_i = u_j x u_k for the other two cables (cyclic)
+		for ( uint8_t i = 0; i < 3; i++ ) {
+			uint8_t j	   = ( i + 1 ) % 3;
+			uint8_t k	   = ( i + 2 ) % 3;
+			null[i]		   = ux[j] * uy[k] - uy[j] * ux[k];
+			nullInverse[i] = 1.0f / null[i];
+		}
+	}
+
+	// Lift the minimum-norm tensions along the null vector until the lowest cable reaches the floor
+	void Lift( const float* minimum, float floor, float* tension ) const {
+		float lift = ( floor - minimum[0] ) * nullInverse[0];
+		for ( uint8_t i = 1; i < 3; i++ ) {
+			float needed = ( floor - minimum[i] ) * nullInverse[i];
+			if ( needed > lift ) lift = needed;
+		}
+		for ( uint8_t i = 0; i < 3; i++ ) tension[i] = minimum[i] + lift * null[i];
+	}
+
+	/**
+	 * @brief Tensions that produce force (fx, fy) with every cable at or above the floor
+	 * 
+	 * Requests that would push a cable past full scale are shortened along
+	 * their own direction, so the rendered heading is kept.
+	 */
+	void Allocate( float fx, float fy, float floor, float* tension ) {
+
+		float minimum[3];
+		for ( uint8_t i = 0; i < 3; i++ ) minimum[i] = pinv[i][0] * fx + pinv[i][1] * fy;
+		Lift( minimum, floor, tension );
+
+		float highest = tension[0] > tension[1] ? tension[0] : tension[1];
+		if ( tension[2] > highest ) highest = tension[2];
+		if ( highest <= 1.0f ) return;
+
+		// Peak tension is convex in the force scale, so one chord step from zero force stays within full scale
+		float idle[3];
+		float zero[3] = {};
+		Lift( zero, floor, idle );
+		float idleHighest = idle[0] > idle[1] ? idle[0] : idle[1];
+		if ( idle[2] > idleHighest ) idleHighest = idle[2];
+		float scale = ( idleHighest < 1.0f ) ? ( 1.0f - idleHighest ) / ( highest - idleHighest ) : 0.0f;
+		for ( uint8_t i = 0; i < 3; i++ ) minimum[i] *= scale;
+		Lift( minimum, floor, tension );
+		saturations++;
+	}
 };
 
 // /**
@@ -290,8 +1430,8 @@ class AmplifierClass {
 	*  Controls  *
 	**************/
 	public:
-	void Begin();	 // Initialize class
-	void Loop();	 // Called every loop
+	void Begin( EnumsClass::AmplifierProtocolEnum protocol = EnumsClass::AmplifierProtocolEnum::ASCII );	 // Initialize class, selecting the sensor query protocol
+	void Loop();																						 // Called every loop
 
 
 	// void Update();													// Update (called every loop)
@@ -299,9 +1439,20 @@ class AmplifierClass {
 
 	void ReadSensors();			 // Reads the current and encoders on the amplifier
 	void ZeroMotorEncoders();	 // Zero motor encoders
-	void DriveMotorOutputs();	 // Drives the motor output
-	void TestEncoderLimits();
+	void PrintLinkStats();		 // Print and clear per-amplifier round-trip statistics
+	void ArmTraceCapture();		 // Configure the drive trace on every ready amplifier
+	void TriggerTraceCapture();	 // Start recording (e.g. at prompt onset)
+	void LogTraceCapture();		 // Write uploaded trace samples to the session log
+	void ServiceReceive();		 // Drain and parse all three UARTs (receive timer)
+	void RecordLoopStart();		 // Measure loop() length for the sample age report
+	bool ReadLatestSample( uint8_t amp, AmpSampleStruct& destination );	   // Latest current and position without locking
+	void ComputeMotorOutputs();	 // Work out the raw PWM for this tick (compute phase)
+	void ActuateMotorOutputs();	 // Limit, shape and write the PWM (actuate phase)
+	bool TestEncoderLimits();	 // Step the automated limit sweep (output ISR), true while it owns the raw PWM
 	void ApplyEncoderLimits();
+	void PublishSensorSnapshot();	 // Publish the sensor frame this tick works from (output ISR)
+	void PublishDriveSnapshot();	 // Publish the drive output of this tick (output ISR)
+	void PrintEncoderLimitSession();	// Print the overshoot statistics of the current limit session
 
 	private:
 	void		  ReadSafetySwitchState();	  // Returns the state of the safety switch state
@@ -309,9 +1460,58 @@ class AmplifierClass {
 	CommandStruct Command;																	  // Struct for commands
 	void		  CommandPWM();																  // Send PWM signals to amplifiers
 	void		  CommandZero();															  // Send zero signal to amplifiers
-	void		  Reset();																	  // Reset amplifier
+	void		  Reset();																	  // Start reset pulse on all amplifiers
 	void		  MapPolarTermsToCommandOutput( float theta, float magnitude );				  // Map polar inputs to command output
 	void		  MapPercentageToPwmABC( float percentA, float percentB, float percentC );	  // Map percentage to PWM
+	void		  MapPolarTermsToCommandOutputQ15( int32_t headingCdeg, int32_t magnitudeQ15 );	  // Integer twin of MapPolarTermsToCommandOutput
+	void		  AllocateCableForces();														  // Render the target force over all three cables (output ISR)
+	CableAllocatorStruct Allocator;																  // Three-cable force allocation
+	bool				 isForceAllocationActive = false;										  // Allocator owned the raw PWM on the last tick
+	bool				 ServiceSetpointPlayback();												  // Play the setpoint stream (output ISR), true while it owns the raw PWM
+	bool				 isPlaybackActive = false;												  // Stream owned the raw PWM on the last tick
+	bool				 ServiceHapticCue();													  // Play the task cue (output ISR), true while it owns the raw PWM
+	bool				 isCueActive = false;													  // Cue owned the raw PWM on the last tick
+
+	// Encoder limit guard
+	EncoderLimitGuardStruct	 GuardA;																// Limit guard for amp A
+	EncoderLimitGuardStruct	 GuardB;																// Limit guard for amp B
+	EncoderLimitGuardStruct	 GuardC;																// Limit guard for amp C
+	EncoderLimitGuardStruct& GetGuard( uint8_t amp );												// Limit guard by amplifier index
+	bool					 isLimitSessionActive = false;											// Limits were enforced on the last tick
+
+	// Automated limit sweep
+	RomSweepStruct Sweep;																			// Sweep state and calibration table
+	bool		   isSweepActive = false;															// Sweep owned the raw PWM on the last tick
+	void		   BeginSweepHeading( uint32_t nowUs );												// Start ramping at the current sweep heading
+	void		   ReadSweepResponse( int32_t* count, float* currentAmps );							// Latest counts and currents for the sweep
+
+	// Range-of-motion map
+	RomMapStruct RomMap;																			// Largest safe magnitude per heading
+	int32_t		 commandHeadingCdeg	 = 0;															// Heading of the last polar command
+	int32_t		 commandMagnitudeQ15 = 0;															// Magnitude of the last polar command, before the map
+	bool		 hasPolarCommand	 = false;														// A polar command was mapped on this tick
+	int32_t		 LimitMagnitudeToRomMap( int32_t headingCdeg, int32_t magnitudeQ15 );				// Note the command and clamp it to the map
+	void		 RecordRomMap();																	// Credit the map with this tick's command (output ISR)
+	void		 LoadRomMap();																		// Read the stored map, if any
+	void		 SaveRomMap();																		// Store the map
+
+	// Slew / jerk limiter
+	SlewTransitionStruct  TransitionA;																// Command transitions on amp A
+	SlewTransitionStruct  TransitionB;																// Command transitions on amp B
+	SlewTransitionStruct  TransitionC;																// Command transitions on amp C
+	SlewTransitionStruct& GetTransition( uint8_t amp );												// Transition stats by amplifier index
+	void				  ApplySlewLimit();															// Shape steps in the outgoing PWM (output ISR)
+	void				  ResetSlewLimit();															// Restart the limiter from zero output
+	uint32_t			  slewCyclesLast = 0;														// CPU cycles for the last limiter pass
+	uint32_t			  slewCyclesMax	 = 0;														// Worst-case CPU cycles for a limiter pass
+
+	// Closed-loop control
+	MotorControllerStruct  ControlA;																// Current trim and position hold for amp A
+	MotorControllerStruct  ControlB;																// Current trim and position hold for amp B
+	MotorControllerStruct  ControlC;																// Current trim and position hold for amp C
+	MotorControllerStruct& GetControl( uint8_t amp );												// Controller by amplifier index
+	void				   ApplyClosedLoopControl();												// Correct the outgoing PWM from the latest samples (output ISR)
+	void				   ResetClosedLoopControl();												// Clear integrators and holds
 	// void		  Enable();																	  // Enable amplifier
 	// void		  Disable();																  // Disables amplifier (for emergencies, requires system restart)
 	// void		  DisableA();																  // Disable amplfier and clear memory
@@ -324,17 +1524,73 @@ class AmplifierClass {
 	private:
 	AsciiStruct ASCII;
 	// HWSerialStruct HWSerial;
-	void InitializeAmplifierA();	// Initialize HWSerialA
-	void InitializeAmplifierB();	// Initialize HWSerialB
-	void InitializeAmplifierC();	// Initialize HWSerialC
-
-	void SendQueryA( String newQuery );		// Send a query to HWSerialA
-	void SendQueryB( String newQuery );		// Send a query to HWSerialB
-	void SendQueryC( String newQuery );		// Send a query to HWSerialC
-	void ParseQueryA();						// Parse queryA
-	void ParseQueryB();						// Parse queryB
-	void ParseQueryC();						// Parse queryC
-	bool isVerboseOutputEnabled = false;	// Flag for debug output
+	void							  ServiceInitialization();																	 // Advance the initialization sequence of every amplifier
+	void							  ServiceInitializationStep( uint8_t amp );													 // Advance one amplifier's initialization sequence
+	void							  AdvanceInitialization( uint8_t amp, EnumsClass::AmplifierInitStepEnum nextStep );			 // Move an amplifier to its next step
+	void							  FallBackBaud( uint8_t amp );																 // Reset an amplifier and probe the next slower baud rate
+	void							  FinishInitialization();																	 // Start sensor polling once every amplifier is done
+	void							  PrintBootReport();																		 // Print where initialization time went
+	AmpInitStruct&					  GetInit( uint8_t amp );																	 // Initialization state by amplifier index
+	SensorPollStruct&				  GetPoll( uint8_t amp );																	 // Pipeline state by amplifier index
+	AmpRxRingStruct&				  GetRx( uint8_t amp );																		 // Receive ring by amplifier index
+	HardwareSerial&					  GetPort( uint8_t amp );																	 // HWSerial port by amplifier index
+	uint8_t							  GetEnablePin( uint8_t amp );																 // Enable pin by amplifier index
+	void							  SendQuery( uint8_t amp, EnumsClass::AmplifierQueryEnum newQuery );						 // Send a query by amplifier index
+	AmpInitStruct					  InitA;																					 // Initialization state for amp A
+	AmpInitStruct					  InitB;																					 // Initialization state for amp B
+	AmpInitStruct					  InitC;																					 // Initialization state for amp C
+	uint32_t						  initStartUs			   = 0;																 // Time initialization started
+	bool							  isInitializationComplete = false;															 // All amplifiers ready or failed
+	EnumsClass::AmplifierProtocolEnum requestedProtocol		   = EnumsClass::AmplifierProtocolEnum::ASCII;						 // Protocol to switch to once initialized
+
+	void			  SendQueryA( EnumsClass::AmplifierQueryEnum newQuery );			   // Send a query to HWSerialA
+	void			  SendQueryB( EnumsClass::AmplifierQueryEnum newQuery );			   // Send a query to HWSerialB
+	void			  SendQueryC( EnumsClass::AmplifierQueryEnum newQuery );			   // Send a query to HWSerialC
+	void			  ParseQueryA();													   // Parse queryA
+	void			  ParseQueryB();													   // Parse queryB
+	void			  ParseQueryC();													   // Parse queryC
+	AmpResponseStruct ParseAsciiResponse( AmpRxRingStruct& ring );						   // Parse "v <int>" / "ok" / "e <code>" out of a ring
+	void			  CopyAsciiResponseText( AmpRxRingStruct& ring, char* destination );	   // Copy the text after "v " (init-time only)
+	AmpRxRingStruct	  RxA;																   // Response line being received on HWSerialA
+	AmpRxRingStruct	  RxB;																   // Response line being received on HWSerialB
+	AmpRxRingStruct	  RxC;																   // Response line being received on HWSerialC
+	AmpLinkStatsStruct LinkA;																   // Round-trip statistics for HWSerialA
+	AmpLinkStatsStruct LinkB;																   // Round-trip statistics for HWSerialB
+	AmpLinkStatsStruct LinkC;																   // Round-trip statistics for HWSerialC
+
+	// Sample handoff
+	AmpSamplePublisherStruct SampleA;																// Latest sample from amp A
+	AmpSamplePublisherStruct SampleB;																// Latest sample from amp B
+	AmpSamplePublisherStruct SampleC;																// Latest sample from amp C
+	SampleAgeStatsStruct	 SampleAge;																// Loop length and sample age
+	void					 MeasureSampleAge();													// Age of the samples the output ISR is about to use
+	uint8_t					 rxExtraBufferA[CONST_AMP_RX_EXTRA_BUFFER];								// Extra UART receive memory for amp A
+	uint8_t					 rxExtraBufferB[CONST_AMP_RX_EXTRA_BUFFER];								// Extra UART receive memory for amp B
+	uint8_t					 rxExtraBufferC[CONST_AMP_RX_EXTRA_BUFFER];								// Extra UART receive memory for amp C
+
+	// Trace capture
+	TraceCaptureStruct	TraceA;																  // Trace capture for amp A
+	TraceCaptureStruct	TraceB;																  // Trace capture for amp B
+	TraceCaptureStruct	TraceC;																  // Trace capture for amp C
+	TraceCaptureStruct& GetTrace( uint8_t amp );											  // Trace capture by amplifier index
+	volatile bool&		GetPollingPaused( uint8_t amp );									  // Trace ownership flag by amplifier index
+	void				ServiceTraceCapture( uint8_t amp );									  // Advance one amplifier's trace capture
+	void				SendTraceCommand( uint8_t amp );									  // Send the packet for the current trace step
+	void				HandleTraceResponse( uint8_t amp );									  // Act on a complete trace reply
+	void				ServiceTraceDeadline( uint8_t amp );								  // Fail the trace step whose reply is overdue
+	void				EndTraceTransaction( uint8_t amp, EnumsClass::TraceCaptureStateEnum nextState );	// Hand the port back to polling
+	uint32_t			traceTriggerUs = 0;													  // Host time the capture was triggered
+	bool			  isVerboseOutputEnabled = false;									   // Flag for debug output
+	EventQueueStruct<AmpPacketLogStruct, 16> PacketLog;										   // Responses parsed in the receive ISR, printed from Loop()
+	void			  PrintPacketLog();														   // Print the queued verbose packet dump
+
+	// Binary protocol
+	BinaryStruct					  BINARY;															  // Binary packets for register reads
+	EnumsClass::AmplifierProtocolEnum activeProtocol = EnumsClass::AmplifierProtocolEnum::ASCII;		  // Protocol used for queries on the wire
+	bool							  IsResponseComplete( const AmpRxRingStruct& ring );				  // Check if a whole binary packet has arrived
+	AmpResponseStruct				  ParseBinaryResponse( AmpRxRingStruct& ring );						  // Parse a binary response packet out of a ring
+	AmpResponseStruct				  ParseResponse( AmpRxRingStruct& ring );							  // Parse with the active protocol
+	bool							  ReceiveByte( AmpRxRingStruct& ring, char incomingChar );			  // Frame a received byte, true once a response is complete
 
 	public:
 	void OnHWSerialAEvent();				 // Instance handler for HWSerialA
@@ -359,9 +1615,29 @@ class AmplifierClass {
 	SensorsStruct Sensors;
 
 	private:
-	void   ReadCurrents();	   // Send serial commands to read motor currents
-	void   ReadEncoders();	   // Send serial commands to read motor encoders
-	int8_t activeQuery = 0;	   // Which sensor to read next
+	void			 ReadCurrents();							// Send serial commands to read motor currents
+	void			 ReadEncoders();							// Send serial commands to read motor encoders
+	void			 SendNextSensorQueryA();					// Send the next sensor query in the poll sequence to amp A
+	void			 SendNextSensorQueryB();					// Send the next sensor query in the poll sequence to amp B
+	void			 SendNextSensorQueryC();					// Send the next sensor query in the poll sequence to amp C
+	SensorPollStruct PollA;										// Sensor pipeline state for amp A
+	SensorPollStruct PollB;										// Sensor pipeline state for amp B
+	SensorPollStruct PollC;										// Sensor pipeline state for amp C
+	volatile bool	 isSensorPollingEnabled		   = false;		// Sensor pipeline running
+	const uint8_t	 SENSOR_QUERY_RETRIES		   = 3;			// Resync attempts before the link is marked lost
+	const uint32_t	 SENSOR_RESPONSE_LATENCY_US	   = 1000;		// Amplifier turnaround allowed on top of wire time
+	const uint8_t	 SENSOR_ROUND_TRIP_BYTES	   = 32;		// Worst-case bytes on the wire for one query and response
+	const uint32_t	 SENSOR_RESYNC_BACKOFF_US	   = 100000;	// Resync interval once the link is marked lost
+	void			 ServiceSensorTransaction( uint8_t amp );	// Start an idle port or enforce the deadline of a busy one
+	void			 Resynchronize( uint8_t amp );				// Flush the port and send the known-answer query
+	void			 CompleteResync( uint8_t amp, const AmpResponseStruct& response );	  // Resume polling if the known answer came back
+	AmpLinkStatsStruct& GetLink( uint8_t amp );					// Link statistics by amplifier index
+	volatile bool	 isPollingPausedA			   = false;		// Port A lent to the trace capture
+	volatile bool	 isPollingPausedB			   = false;		// Port B lent to the trace capture
+	volatile bool	 isPollingPausedC			   = false;		// Port C lent to the trace capture
+	PollTableStruct	 PollTable;									// Registers polled from each amplifier
+	void			 BuildPollTable();							// Fill the poll table
+	void			 PrintPollBudget();							// Report expected sample rates and wire use per port
 
 
 
@@ -371,10 +1647,14 @@ class AmplifierClass {
 	public:
 	void StartMeasuringRangeOfMotionLimits();	 // Start measuring the range of motion
 	void StopMeasuringRangeOfMotionLimits();	 // Stop measuring the range of motion
-	void StartTestingRangeOfMotionLimits();		 // Start RoM test
-	void StopTestingRangeOfMotionLimits();		 // Stop measuring current limits
-	void IncreaseRangeOfMotionMagnitude();		 // Increase magnitude
-	void DecreaseRangeOfMotionMagnitude();		 // Decreate magnitude
+	void StartTestingRangeOfMotionLimits();		 // Start the automated limit sweep
+	void StopTestingRangeOfMotionLimits();		 // Abandon the automated limit sweep
+	void IncreaseRangeOfMotionMagnitude();		 // Raise the sweep magnitude one step
+	void DecreaseRangeOfMotionMagnitude();		 // Lower the sweep magnitude one step
+	void FinishRangeOfMotionSweep();			 // Print the sweep table and apply it to the limits and heading map
+	void StartRomMap();							 // Start recording the heading map
+	void FinishRomMap();						 // Stop recording, fill gaps and store the heading map
+	void PrintRomMap();							 // Print the heading map
 
 
 
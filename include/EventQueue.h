@@ -0,0 +1,72 @@
+/**
+ * @file EventQueue.h
+ * @author Tomasz Trzpit
+ * @brief Fixed-size single-producer, single-consumer event ring
+ * @version 0.1
+ * @date 2025-10-06
+ *
+ * One context pushes and one context pops. The indices run freely and are
+ * masked on access, so a full ring needs no spare slot. Each side only
+ * writes its own index, with release ordering after the slot is written or
+ * read, so neither side ever sees a half-written event. A full ring drops
+ * the new event and counts it, rather than overwriting one not yet read.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+template <typename T, uint16_t CAPACITY>
+struct EventQueueStruct {
+
+	static_assert( CAPACITY >= 2 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "Capacity must be a power of two" );
+
+	// Producer side
+	bool Push( const T& event ) {
+		uint32_t head = headIndex.load( std::memory_order_relaxed );
+		uint32_t used = head - tailIndex.load( std::memory_order_acquire );
+		if ( used >= CAPACITY ) {
+			dropped++;
+			return false;
+		}
+		slot[head & ( CAPACITY - 1 )] = event;
+		headIndex.store( head + 1, std::memory_order_release );
+		pushed++;
+		if ( used + 1 > highWater ) highWater = used + 1;
+		return true;
+	}
+
+	// Consumer side
+	bool Pop( T& event ) {
+		uint32_t tail = tailIndex.load( std::memory_order_relaxed );
+		if ( tail == headIndex.load( std::memory_order_acquire ) ) return false;
+		event = slot[tail & ( CAPACITY - 1 )];
+		tailIndex.store( tail + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Consumer side, discards everything pushed so far
+	void Clear() {
+		tailIndex.store( headIndex.load( std::memory_order_acquire ), std::memory_order_release );
+	}
+
+	uint16_t Count() const {
+		return uint16_t( headIndex.load( std::memory_order_acquire ) - tailIndex.load( std::memory_order_acquire ) );
+	}
+
+	bool IsEmpty() const {
+		return Count() == 0;
+	}
+
+	// Stats (written by the producer)
+	volatile uint32_t pushed	= 0;	// Events queued
+	volatile uint32_t dropped	= 0;	// Events lost to a full ring
+	volatile uint16_t highWater = 0;	// Most events waiting at once
+
+	private:
+	T					  slot[CAPACITY] = {};	  // Events
+	std::atomic<uint32_t> headIndex{ 0 };		  // Next slot to write (producer)
+	std::atomic<uint32_t> tailIndex{ 0 };		  // Next slot to read (consumer)
+};
@@ -0,0 +1,163 @@
+/**
+ * @file HapticCue.h
+ * @author Tomasz Trzpit
+ * @brief Directional cue synthesized into a sample table during the trial delay, played by the output ISR
+ * @version 0.1
+ * @date 2025-10-06
+ *
+ * Nothing here touches hardware, so the synthesizer builds unchanged on the host.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+
+// Cue sizing
+const uint32_t CONST_CUE_TICK_US	 = 1000;		// Output ISR period (one table sample per tick)
+const uint16_t CONST_CUE_MAX_SAMPLES = 1500;		// Longest cue (1.5 s at the output rate)
+const uint16_t CONST_CUE_Q15_ONE	 = 1 << 15;		// 100 % magnitude (same scale as CONST_Q15_ONE)
+
+// Cue onset
+const uint32_t CONST_CUE_ONSET_GRACE_US = 20000;	// Past its onset by this much, a cue that has not begun is given up
+
+
+/**
+ * @brief Shape of a cue (settable at runtime from the keyboard)
+ *
+ * Ramp up, hold, ramp down, with raised-cosine ramps. The optional carrier
+ * adds a sine of carrierPercent on top of the magnitude, under the same
+ * envelope, for a vibrotactile cue. Cables only pull, so the result is
+ * clamped at zero.
+ */
+struct HapticCueProfileStruct {
+
+	float	 magnitudePercent = 30.0f;	  // Held magnitude
+	uint16_t rampUpMs		  = 50;		  // Envelope rise
+	uint16_t holdMs			  = 300;	  // Envelope plateau
+	uint16_t rampDownMs		  = 50;		  // Envelope fall
+	float	 carrierHz		  = 0.0f;	  // Vibrotactile carrier (0 = off)
+	float	 carrierPercent	  = 0.0f;	  // Carrier amplitude
+
+	uint32_t LengthMs() const {
+		return uint32_t( rampUpMs ) + holdMs + rampDownMs;
+	}
+};
+
+
+/**
+ * @brief Precomputed cue and its playback state
+ *
+ * loop() synthesizes the table and arms it with the onset time while the
+ * trial delay runs. The output ISR starts playback on the first tick at or
+ * after the onset time, stamps the onset with micros(), then plays one
+ * sample per tick. loop() only touches the table while the cue is neither
+ * armed nor playing.
+ */
+struct HapticCueStruct {
+
+	// Table (loop)
+	uint16_t magnitudeQ15[CONST_CUE_MAX_SAMPLES];	 // Magnitude per output tick
+	uint16_t sampleCount = 0;						 // Samples in the table
+	int32_t	 headingCdeg = 0;						 // Cue direction (centidegrees)
+
+	// Requests (loop -> ISR)
+	volatile bool	  isArmed		= false;	// Play from onsetTargetUs
+	volatile uint32_t onsetTargetUs = 0;		// micros() at which the cue should begin
+
+	// Playback (ISR)
+	volatile bool	  isPlaying	 = false;	   // Table being played
+	volatile bool	  hasStarted = false;	   // Onset reached since the cue was armed
+	volatile uint32_t onsetUs	 = 0;		   // micros() of the tick the cue began on
+	uint16_t		  index		 = 0;		   // Next sample to play
+
+
+	/**
+	 * @brief Fill the table for a cue toward the given heading
+	 *
+	 * @return false if the cue is busy or longer than the table
+	 */
+	bool Synthesize( const HapticCueProfileStruct& Profile, float headingDeg ) {
+
+		if ( isArmed || isPlaying || Profile.LengthMs() == 0 || Profile.LengthMs() > CONST_CUE_MAX_SAMPLES ) return false;
+
+		uint16_t holdEnd = Profile.rampUpMs + Profile.holdMs;
+		sampleCount		 = uint16_t( Profile.LengthMs() );
+		headingCdeg		 = int32_t( lroundf( headingDeg * 100.0f ) );
+
+		for ( uint16_t k = 0; k < sampleCount; k++ ) {
+
+			// Envelope
+			float envelope = 1.0f;
+			if ( k < Profile.rampUpMs ) {
+				envelope = 0.5f * ( 1.0f - cosf( float( M_PI ) * k / Profile.rampUpMs ) );
+			} else if ( k >= holdEnd ) {
+				envelope = 0.5f * ( 1.0f + cosf( float( M_PI ) * ( k - holdEnd ) / Profile.rampDownMs ) );
+			}
+
+			// Magnitude plus carrier
+			float percent = Profile.magnitudePercent;
+			if ( Profile.carrierHz > 0.0f ) {
+				percent += Profile.carrierPercent * sinf( 2.0f * float( M_PI ) * Profile.carrierHz * k * CONST_CUE_TICK_US / 1000000.0f );
+			}
+			percent *= envelope;
+			if ( percent < 0.0f ) percent = 0.0f;
+			if ( percent > 100.0f ) percent = 100.0f;
+
+			magnitudeQ15[k] = uint16_t( percent / 100.0f * CONST_CUE_Q15_ONE );
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Schedule the synthesized cue
+	 */
+	void Arm( uint32_t targetUs ) {
+		onsetTargetUs = targetUs;
+		hasStarted	  = false;
+		isArmed		  = true;
+	}
+
+	/**
+	 * @brief Withdraw an armed cue that has not begun
+	 *
+	 * @return true if withdrawn, false if the output ISR started it first
+	 */
+	bool Cancel() {
+		isArmed = false;
+		std::atomic_signal_fence( std::memory_order_seq_cst );
+		return !hasStarted;
+	}
+
+	/**
+	 * @brief Magnitude for this output tick
+	 *
+	 * @param nowUs micros() at this tick
+	 * @param magnitude Q15 magnitude to render
+	 * @return true while the cue owns the output
+	 */
+	bool Sample( uint32_t nowUs, int32_t& magnitude ) {
+
+		// Onset on the first tick at or after the target
+		if ( isArmed && int32_t( nowUs - onsetTargetUs ) >= 0 ) {
+			isArmed	   = false;
+			isPlaying  = true;
+			hasStarted = true;
+			onsetUs	   = nowUs;
+			index	   = 0;
+		}
+
+		if ( !isPlaying ) return false;
+
+		if ( index >= sampleCount ) {
+			isPlaying = false;
+			return false;
+		}
+
+		magnitude = magnitudeQ15[index++];
+		return true;
+	}
+};
@@ -0,0 +1,157 @@
+/**
+ * @file LoopProfiler.h
+ * @author Tomasz Trzpit
+ * @brief Scoped cycle-count probes for loop() subsystems and ISRs
+ * @version 0.1
+ * @date 2025-10-06
+ *
+ * On the Teensy the probes read the Cortex-M7 DWT cycle counter. Anywhere
+ * else they fall back to a monotonic clock counted in nanoseconds, so the
+ * same code builds and runs on the host.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined( TEENSYDUINO ) && defined( __IMXRT1062__ )
+#include <Arduino.h>	// For ARM_DWT_CYCCNT
+
+inline uint32_t ProfilerCycles() {
+	return ARM_DWT_CYCCNT;
+}
+
+inline float ProfilerCyclesPerUs() {
+	return F_CPU_ACTUAL / 1000000.0f;
+}
+
+inline uint32_t ProfilerMicros() {
+	return micros();
+}
+#else
+#include <chrono>	 // Host stub
+
+inline uint32_t ProfilerCycles() {
+	return uint32_t( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+
+inline float ProfilerCyclesPerUs() {
+	return 1000.0f;
+}
+
+inline uint32_t ProfilerMicros() {
+	return uint32_t( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+#endif
+
+
+// Histogram: power-of-two ranges, each split into CONST_PROFILE_SUB_BUCKETS
+const uint8_t  CONST_PROFILE_SUB_BITS	 = 2;								// log2 of the sub-buckets per range
+const uint8_t  CONST_PROFILE_SUB_BUCKETS = 1 << CONST_PROFILE_SUB_BITS;		// Sub-buckets per power of two (bucket edges within 25 %)
+const uint8_t  CONST_PROFILE_BUCKETS	 = 32 * CONST_PROFILE_SUB_BUCKETS;	// Covers the full 32-bit cycle range
+const uint32_t CONST_PROFILE_LOG_MS		 = 10000;							// Period of the periodic log write
+
+
+// Probed sections
+enum class ProfileProbeEnum : uint8_t { LOOP, ACTIONS, ARM_ENCODERS, AMPLIFIER, GAMEPAD, STATE_MACHINE, STATUS_WRITER, TICK_ISR, RECEIVE_ISR, COUNT };
+const char* const PROFILE_PROBE_NAMES[] = { "Loop", "Actions", "ArmEncoders", "Amplifier", "Gamepad", "StateMachine", "StatusWriter", "TickISR", "ReceiveISR" };
+
+static_assert( sizeof( PROFILE_PROBE_NAMES ) / sizeof( PROFILE_PROBE_NAMES[0] ) == uint8_t( ProfileProbeEnum::COUNT ), "One name per probe" );
+
+
+/**
+ * @brief Cycle statistics for one probed section
+ *
+ * Only the context that runs the section records into it. Clearing is a
+ * request the recording side acts on, so an ISR probe is never cleared
+ * halfway through an update from loop().
+ */
+struct ProfileProbeStruct {
+
+	volatile uint32_t calls								= 0;			 // Sections timed
+	uint32_t		  cyclesMin							= UINT32_MAX;	 // Shortest
+	uint32_t		  cyclesMax							= 0;			 // Longest
+	uint64_t		  cyclesTotal						= 0;			 // Sum
+	uint32_t		  histogram[CONST_PROFILE_BUCKETS]	= {};			 // Counts by bucket
+	uint32_t		  windowStartUs						= 0;			 // Time the stats were last cleared
+	volatile bool	  isClearRequested					= true;			 // Clear before the next record
+
+	static uint8_t Bucket( uint32_t cycles ) {
+		if ( cycles < CONST_PROFILE_SUB_BUCKETS ) return uint8_t( cycles );
+		uint8_t msb = 31 - __builtin_clz( cycles );
+		uint8_t sub = ( cycles >> ( msb - CONST_PROFILE_SUB_BITS ) ) & ( CONST_PROFILE_SUB_BUCKETS - 1 );
+		return uint8_t( ( msb - CONST_PROFILE_SUB_BITS + 1 ) * CONST_PROFILE_SUB_BUCKETS + sub );
+	}
+
+	// Largest cycle count that falls in the bucket
+	static uint32_t BucketUpperEdge( uint8_t bucket ) {
+		if ( bucket < CONST_PROFILE_SUB_BUCKETS ) return bucket;
+		uint8_t	 msb  = bucket / CONST_PROFILE_SUB_BUCKETS + CONST_PROFILE_SUB_BITS - 1;
+		uint32_t sub  = bucket % CONST_PROFILE_SUB_BUCKETS;
+		uint64_t base = ( uint64_t( CONST_PROFILE_SUB_BUCKETS + sub + 1 ) << ( msb - CONST_PROFILE_SUB_BITS ) ) - 1;
+		return base > UINT32_MAX ? UINT32_MAX : uint32_t( base );
+	}
+
+	void Record( uint32_t cycles ) {
+
+		if ( isClearRequested ) {
+			calls		= 0;
+			cyclesMin	= UINT32_MAX;
+			cyclesMax	= 0;
+			cyclesTotal = 0;
+			for ( uint8_t i = 0; i < CONST_PROFILE_BUCKETS; i++ ) histogram[i] = 0;
+			windowStartUs	 = ProfilerMicros();
+			isClearRequested = false;
+		}
+
+		calls++;
+		cyclesTotal += cycles;
+		if ( cycles < cyclesMin ) cyclesMin = cycles;
+		if ( cycles > cyclesMax ) cyclesMax = cycles;
+		histogram[Bucket( cycles )]++;
+	}
+
+	// Upper edge of the bucket holding the given percentile
+	uint32_t PercentileCycles( uint8_t percent ) const {
+		uint32_t target	 = ( uint64_t( calls ) * percent + 99 ) / 100;
+		uint32_t counted = 0;
+		for ( uint8_t bucket = 0; bucket < CONST_PROFILE_BUCKETS; bucket++ ) {
+			counted += histogram[bucket];
+			if ( counted >= target && counted > 0 ) return BucketUpperEdge( bucket );
+		}
+		return 0;
+	}
+};
+
+
+/**
+ * @brief Times the enclosing block into a probe
+ */
+struct ProfileScopeStruct {
+
+	ProfileProbeStruct& Probe;
+	uint32_t			startCycles;
+
+	explicit ProfileScopeStruct( ProfileProbeStruct& probe ) : Probe( probe ), startCycles( ProfilerCycles() ) { }
+	~ProfileScopeStruct() {
+		Probe.Record( ProfilerCycles() - startCycles );
+	}
+};
+
+
+/**
+ * @brief Every probe in the firmware
+ */
+struct LoopProfilerStruct {
+
+	ProfileProbeStruct Probe[uint8_t( ProfileProbeEnum::COUNT )];	 // Stats by section
+	uint32_t		   lastLogUs = 0;								 // Time of the last periodic log write
+
+	ProfileProbeStruct& Get( ProfileProbeEnum probe ) {
+		return Probe[uint8_t( probe )];
+	}
+
+	void ClearAll() {
+		for ( ProfileProbeStruct& probe : Probe ) probe.isClearRequested = true;
+	}
+};
@@ -0,0 +1,169 @@
+/**
+ * @file MotorControl.h
+ * @author Tomasz Trzpit
+ * @brief Per-motor current trim and position hold, plus a motor/cable plant model to check them against
+ * @version 0.1
+ * @date 2025-10-02
+ *
+ * Nothing here touches hardware, so the controller and plant model build
+ * unchanged on the host (test/test_motor_control).
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+
+// Motor scaling
+const float CONST_CONTROL_FULL_SCALE_AMPS = 1.89f;	  // Current at full PWM command
+const float CONST_CONTROL_CURRENT_SIGN	  = 1.0f;	  // Sign of the measured current for a pulling command
+const float CONST_CONTROL_MAX_SAMPLE_DT_S = 0.02f;	  // Longest sample interval used for integration and velocity
+
+
+/**
+ * @brief Controller gains (settable at runtime from Drive.Control)
+ */
+struct MotorControlGainsStruct {
+
+	float currentKp		= 0.5f;		   // Current trim per amp of current error
+	float currentKi		= 40.0f;	   // Current trim integral gain (1/s)
+	float positionKp	= 0.05f;	   // Hold current per count of position error (A/count)
+	float positionKd	= 0.001f;	   // Hold current per count/s of velocity (A s/count)
+	float trimLimitAmps = 0.4f;		   // Largest correction the current loop may add or remove
+};
+
+
+/**
+ * @brief One motor's current trim (PI) and position hold (PD)
+ *
+ * The open-loop command is the current target. Position hold adds a PD term
+ * on the encoder count, then the PI trim corrects the target for the drive's
+ * gain and offset error using the measured current. Samples arrive slower
+ * than the output rate, so the integral and velocity only move when a new
+ * sample arrives. Anti-windup clamps the integral to the trim limit and stops
+ * integrating while the output is saturated in the direction of the error.
+ */
+struct MotorControllerStruct {
+
+	float	 integralAmps	  = 0.0f;	 // Integral trim
+	float	 velocityCps	  = 0.0f;	 // Encoder velocity (counts/s)
+	int32_t	 holdCount		  = 0;		 // Position held while hold is active
+	bool	 isHolding		  = false;	 // Position hold active
+	int32_t	 lastCount		  = 0;		 // Encoder count of the previous position sample
+	uint32_t lastPositionUs	  = 0;		 // Time of the previous position sample
+	uint32_t lastCurrentUs	  = 0;		 // Time of the previous current sample
+	bool	 hasPosition	  = false;	 // A position sample has been seen
+	bool	 hasCurrent		  = false;	 // A current sample has been seen
+	float	 targetAmps		  = 0.0f;	 // Current target after position hold
+	float	 outputAmps		  = 0.0f;	 // Corrected command
+	uint32_t saturations	  = 0;		 // Ticks with the output clamped
+	uint32_t cyclesLast		  = 0;		 // CPU cycles for the last update
+	uint32_t cyclesMax		  = 0;		 // Worst-case CPU cycles for an update
+
+	void Reset() {
+		integralAmps = 0.0f;
+		velocityCps	 = 0.0f;
+		isHolding	 = false;
+		hasPosition	 = false;
+		hasCurrent	 = false;
+	}
+
+	void StartHold( int32_t count ) {
+		holdCount = count;
+		isHolding = true;
+	}
+
+	// New position sample: update the velocity estimate
+	void OnPosition( int32_t count, uint32_t sampleUs ) {
+		if ( hasPosition && sampleUs != lastPositionUs ) {
+			float dt = ( sampleUs - lastPositionUs ) / 1000000.0f;
+			if ( dt < CONST_CONTROL_MAX_SAMPLE_DT_S ) velocityCps = ( count - lastCount ) / dt;
+			else velocityCps = 0.0f;
+		}
+		lastCount	   = count;
+		lastPositionUs = sampleUs;
+		hasPosition	   = true;
+	}
+
+	/**
+	 * @brief Corrected current command
+	 *
+	 * @param Gains Controller gains
+	 * @param commandAmps Open-loop current command
+	 * @param measuredAmps Latest measured current
+	 * @param currentUs Time of the current sample (integrates only when it changes)
+	 * @param count Latest encoder count
+	 * @return Current to command, 0 to CONST_CONTROL_FULL_SCALE_AMPS
+	 */
+	float Update( const MotorControlGainsStruct& Gains, float commandAmps, float measuredAmps, uint32_t currentUs, int32_t count ) {
+
+		// Position hold
+		targetAmps = commandAmps;
+		if ( isHolding ) {
+			targetAmps += Gains.positionKp * float( holdCount - count ) - Gains.positionKd * velocityCps;
+		}
+		if ( targetAmps < 0.0f ) targetAmps = 0.0f;
+		if ( targetAmps > CONST_CONTROL_FULL_SCALE_AMPS ) targetAmps = CONST_CONTROL_FULL_SCALE_AMPS;
+
+		// Current trim
+		float error = targetAmps - measuredAmps;
+		float trim	= Gains.currentKp * error + integralAmps;
+		if ( trim > Gains.trimLimitAmps ) trim = Gains.trimLimitAmps;
+		if ( trim < -Gains.trimLimitAmps ) trim = -Gains.trimLimitAmps;
+		outputAmps = targetAmps + trim;
+
+		bool isSaturatedHigh = outputAmps > CONST_CONTROL_FULL_SCALE_AMPS;
+		bool isSaturatedLow	 = outputAmps < 0.0f;
+		if ( isSaturatedHigh ) outputAmps = CONST_CONTROL_FULL_SCALE_AMPS;
+		if ( isSaturatedLow ) outputAmps = 0.0f;
+		if ( isSaturatedHigh || isSaturatedLow ) saturations++;
+
+		// Integrate once per new current sample, unless that would push further into saturation
+		if ( !hasCurrent || currentUs != lastCurrentUs ) {
+			float dt = hasCurrent ? ( currentUs - lastCurrentUs ) / 1000000.0f : 0.0f;
+			if ( dt > CONST_CONTROL_MAX_SAMPLE_DT_S ) dt = CONST_CONTROL_MAX_SAMPLE_DT_S;
+			bool isWindingUp = ( isSaturatedHigh && error > 0.0f ) || ( isSaturatedLow && error < 0.0f );
+			if ( !isWindingUp ) {
+				integralAmps += Gains.currentKi * error * dt;
+				if ( integralAmps > Gains.trimLimitAmps ) integralAmps = Gains.trimLimitAmps;
+				if ( integralAmps < -Gains.trimLimitAmps ) integralAmps = -Gains.trimLimitAmps;
+			}
+			lastCurrentUs = currentUs;
+			hasCurrent	  = true;
+		}
+
+		return outputAmps;
+	}
+};
+
+
+/**
+ * @brief Motor driving a cable, for checking the controller without hardware
+ *
+ * The drive delivers gain * command + offset through a first-order lag. The
+ * cable behaves as a spring-damper about zero that can only be pulled, plus
+ * an external disturbance. Positions are in encoder counts.
+ */
+struct MotorPlantModelStruct {
+
+	float driveGain		   = 0.8f;		  // Delivered current per commanded amp
+	float driveOffsetAmps  = -0.05f;	  // Delivered current at zero command
+	float currentTauS	   = 0.002f;	  // Drive current response time constant
+	float accelPerAmp	   = 40000.0f;	  // Acceleration per amp (counts/s^2)
+	float cableStiffness   = 400.0f;	  // Cable restoring acceleration per count (1/s^2)
+	float damping		   = 15.0f;		  // Velocity damping (1/s)
+	float currentAmps	   = 0.0f;		  // Delivered current
+	float positionCounts   = 0.0f;		  // Motor position
+	float velocityCps	   = 0.0f;		  // Motor velocity
+
+	void Step( float commandAmps, float disturbanceAccel, float dt ) {
+		float delivered = driveGain * commandAmps + driveOffsetAmps;
+		if ( delivered < 0.0f ) delivered = 0.0f;
+		currentAmps += ( delivered - currentAmps ) * dt / ( currentTauS + dt );
+		float spring = positionCounts > 0.0f ? cableStiffness * positionCounts : 0.0f;
+		float accel	 = accelPerAmp * currentAmps - spring - damping * velocityCps + disturbanceAccel;
+		velocityCps += accel * dt;
+		positionCounts += velocityCps * dt;
+	}
+};
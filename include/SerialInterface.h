@@ -5,6 +5,10 @@
 #include <Arduino.h>	// For arduino functions
 
 
+// Status line writer
+const uint16_t CONST_STATUS_LINE_SIZE = 512;	// Longest status line, including the line ending
+
+
 // Forward declarations
 class FlagsClass;
 class OutputClass;
@@ -30,8 +34,23 @@ class OutputClass {
 
 	public:
 	void Begin();
+	void Loop();				  // Render a requested status line and drain it without blocking
+	void RequestStatusLine();	  // Ask loop() for a status line (tick job)
 
-	void PrintStatusLine();	   // Prints the system status in a single line
+	// Writer stats
+	public:
+	volatile uint32_t linesRequested = 0;	 // Status lines asked for
+	uint32_t		  linesWritten	 = 0;	 // Status lines fully sent
+	uint32_t		  linesDropped	 = 0;	 // Requests skipped while the previous line was still draining
+	uint32_t		  partialWrites	 = 0;	 // Writes cut short by a full USB buffer
+
+	private:
+	char		  statusLine[CONST_STATUS_LINE_SIZE];	 // Rendered status line
+	uint16_t	  statusLength			= 0;			 // Bytes in statusLine
+	uint16_t	  statusSent			= 0;			 // Bytes already handed to Serial
+	volatile bool isStatusLineRequested = false;		 // Set by the tick job, cleared by loop()
+	void		  RenderStatusLine();					 // Prints the system status in a single line (into statusLine)
+	void		  AppendStatus( const char* format, ... );	  // printf into statusLine
 };
 
 class InputClass {
@@ -55,6 +74,22 @@ class InputClass {
 	private:
 	void SetScrollingOutputEnabled();
 	void SetAmplifierOutputEnabled();
+	void SetAmplifierLinkStatsPrint();
+	void SetTickSchedulerStatsPrint();
+	void SetLoopProfilePrint();
+	void SetLoopProfileLogEnabled();
+	void SetTraceCaptureEnabled();
+	void SetForceAllocationEnabled();
+	void SetClosedLoopEnabled();
+	void SetPositionHoldEnabled();
+	void SetControlGain();
+	void SetSetpointStream();
+	void PrintSetpointStream();
+	void SetCueProfile();
+	void SetSlewLimit();
+	void SetEncoderLimitsEnabled();
+	void SetRomMap();
+	uint8_t ParseValues( const String& text, float* values, uint8_t maxValues );
 	void SetPlatformEncodersZero();
 	void SetMotorEncodersZero();
 	void SetMotorTension();
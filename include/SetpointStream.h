@@ -0,0 +1,322 @@
+/**
+ * @file SetpointStream.h
+ * @author Tomasz Trzpit
+ * @brief Buffer of timestamped setpoints, filled from loop() and played back by the output ISR
+ * @version 0.1
+ * @date 2025-10-06
+ *
+ * Nothing here touches hardware, so the stream builds unchanged on the host.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+
+// Stream sizing
+const uint16_t CONST_STREAM_SIZE		  = 256;		// Setpoints held at once (power of two)
+const uint16_t CONST_STREAM_MASK		  = CONST_STREAM_SIZE - 1;
+const float	   CONST_STREAM_MAX_PERCENT	  = 100.0f;		// Largest magnitude / cable percentage played back
+const uint32_t CONST_STREAM_GENERATOR_US  = 5000;		// Spacing of generated setpoints
+
+static_assert( ( CONST_STREAM_SIZE & CONST_STREAM_MASK ) == 0, "Stream size must be a power of two" );
+
+
+// Stream options
+enum class SetpointFormatEnum : uint8_t { POLAR, ABC };								   // (heading deg, magnitude %) or (A %, B %, C %)
+enum class SetpointInterpolationEnum : uint8_t { LINEAR, CUBIC };					   // Between neighbouring setpoints
+enum class SetpointPlaybackEnum : uint8_t { IDLE, PLAYING, UNDERRUN, FINISHED };	   // Result of one output tick
+
+
+/**
+ * @brief One setpoint, timed from the start of playback
+ */
+struct SetpointStruct {
+
+	uint32_t timeUs	  = 0;						// Time after playback start
+	float	 value[3] = { 0.0f, 0.0f, 0.0f };	// Heading/magnitude (POLAR) or A/B/C (ABC)
+};
+
+
+/**
+ * @brief Sine on one heading, generated on the device instead of streamed over serial
+ */
+struct SetpointGeneratorStruct {
+
+	bool	 isRunning		  = false;	  // Topping up the stream from loop()
+	float	 headingDeg		  = 0.0f;	  // Heading of the cue
+	float	 offsetPercent	  = 0.0f;	  // Mean magnitude
+	float	 amplitudePercent = 0.0f;	  // Peak deviation from the mean
+	float	 frequencyHz	  = 0.0f;	  // Sine frequency
+	uint32_t durationUs		  = 0;		  // Length of the waveform
+	uint32_t nextUs			  = 0;		  // Timestamp of the next setpoint to generate
+};
+
+
+/**
+ * @brief Single-producer, single-consumer setpoint stream
+ *
+ * loop() owns head and pushes setpoints (from serial or the generator);
+ * the output ISR owns tail and consumes them. Neither side writes the
+ * other's index, so no locking is needed. Control requests from loop()
+ * (start, stop) are flags the ISR acts on at its next tick.
+ *
+ * During playback tail is the segment start p0, the next setpoint is p1
+ * and the one after is p2; the setpoint before p0 is kept as a copy once
+ * its slot is released. When only p0 remains and p0's time has passed,
+ * the stream has either ended (end marker pushed) or underrun, in which
+ * case p0 is held until more setpoints arrive.
+ */
+struct SetpointStreamStruct {
+
+	// Buffer
+	SetpointStruct			  point[CONST_STREAM_SIZE];								  // Ring of setpoints
+	volatile uint16_t		  head			= 0;									  // Next slot to write (loop)
+	volatile uint16_t		  tail			= 0;									  // Oldest slot in use (ISR)
+	SetpointFormatEnum		  format		= SetpointFormatEnum::POLAR;			  // Format of the queued setpoints
+	SetpointInterpolationEnum interpolation = SetpointInterpolationEnum::LINEAR;	  // Interpolation between setpoints
+
+	// Producer state (loop)
+	uint32_t				lastPushedUs   = 0;			 // Timestamp of the newest setpoint
+	bool					hasPushed	   = false;		 // A setpoint has been pushed since the last clear
+	uint32_t				rejected	   = 0;			 // Setpoints refused (full, out of order, wrong format, stopping)
+	bool					isClearPending = false;		 // Stop requested, producer state is reset once the ISR acknowledges
+	SetpointGeneratorStruct Generator;				   // On-device waveform source
+
+	// Requests (loop -> ISR)
+	volatile bool isEndOfStream		 = false;	 // No setpoints will follow the last one pushed
+	volatile bool isStartRequested	 = false;	 // Begin playback at the next tick
+	volatile bool isStopRequested	 = false;	 // Stop playback and discard the buffer
+
+	// Playback state (ISR)
+	volatile bool	  isPlaying		 = false;	 // Output ISR is playing the stream
+	uint32_t		  startUs		 = 0;		 // micros() at playback start
+	SetpointStruct	  previous;					 // Setpoint before p0 (cubic tangent)
+	bool			  hasPrevious	 = false;	 // previous is valid
+	bool			  isUnderrun	 = false;	 // Holding p0 while waiting for setpoints
+	volatile uint32_t pointsPlayed	 = 0;		 // Segments completed
+	volatile uint32_t underrunTicks	 = 0;		 // Output ticks spent holding
+	volatile uint32_t underrunEvents = 0;		 // Separate underruns
+	volatile uint32_t latestUs		 = 0;		 // Playback time of the last tick
+
+
+	// === PRODUCER (loop) ===
+
+	uint16_t Count() const {
+		return uint16_t( head - tail ) & CONST_STREAM_MASK;
+	}
+
+	uint16_t Free() const {
+		return CONST_STREAM_MASK - Count();	   // One slot kept empty to tell full from empty
+	}
+
+	/**
+	 * @brief Queue one setpoint
+	 * @return false if full, out of order, of the other format, after the end marker or while a stop is pending
+	 */
+	bool Push( SetpointFormatEnum pointFormat, const SetpointStruct& newPoint ) {
+
+		// The previous stream has finished playing or was stopped, start a new one
+		ServiceStop();
+		if ( isEndOfStream && !isPlaying && Count() == 0 ) Clear();
+
+		bool isOrdered	= !hasPushed || newPoint.timeUs > lastPushedUs;
+		bool isSameKind = !hasPushed || pointFormat == format;
+		if ( !isOrdered || !isSameKind || isEndOfStream || isClearPending || Free() == 0 ) {
+			rejected++;
+			return false;
+		}
+
+		format		= pointFormat;
+		point[head] = newPoint;
+		std::atomic_signal_fence( std::memory_order_seq_cst );
+		head		 = ( head + 1 ) & CONST_STREAM_MASK;
+		lastPushedUs = newPoint.timeUs;
+		hasPushed	 = true;
+		return true;
+	}
+
+	/**
+	 * @brief Forget everything pushed (only while not playing)
+	 */
+	void Clear() {
+		tail				= head;
+		hasPushed			= false;
+		isEndOfStream		= false;
+		Generator.isRunning = false;
+	}
+
+	/**
+	 * @brief Ask the ISR to stop playback and discard the buffer, without waiting for it
+	 *
+	 * The output ISR acts on the request at its next tick, then ServiceStop()
+	 * resets the producer side.
+	 */
+	void RequestStop() {
+		Generator.isRunning = false;
+		isClearPending		= true;
+		isStopRequested		= true;
+	}
+
+	/**
+	 * @brief Finish a stop once the ISR has acknowledged it
+	 */
+	void ServiceStop() {
+		if ( isClearPending && !isStopRequested ) {
+			Clear();
+			isClearPending = false;
+		}
+	}
+
+	/**
+	 * @brief Top up the stream from the generator, marking the end once the waveform is queued
+	 */
+	void ServiceGenerator() {
+
+		ServiceStop();
+
+		while ( Generator.isRunning && Free() > 0 ) {
+
+			SetpointStruct newPoint;
+			float		   seconds = Generator.nextUs / 1000000.0f;
+			newPoint.timeUs		   = Generator.nextUs;
+			newPoint.value[0]	   = Generator.headingDeg;
+			newPoint.value[1]	   = Generator.offsetPercent + Generator.amplitudePercent * sinf( 2.0f * float( M_PI ) * Generator.frequencyHz * seconds );
+			newPoint.value[2]	   = 0.0f;
+			Push( SetpointFormatEnum::POLAR, newPoint );
+
+			if ( Generator.nextUs >= Generator.durationUs ) {
+				Generator.isRunning = false;
+				isEndOfStream		= true;
+			}
+			Generator.nextUs += CONST_STREAM_GENERATOR_US;
+		}
+	}
+
+
+	// === CONSUMER (output ISR) ===
+
+	/**
+	 * @brief Setpoint for this output tick
+	 *
+	 * @param nowUs micros() at this tick
+	 * @param output Interpolated setpoint values
+	 * @return PLAYING or UNDERRUN with output valid, FINISHED on the tick playback ends, IDLE otherwise
+	 */
+	SetpointPlaybackEnum Sample( uint32_t nowUs, float* output ) {
+
+		// Stop and discard
+		if ( isStopRequested ) {
+			tail			 = head;
+			isPlaying		 = false;
+			isStartRequested = false;
+			isStopRequested	 = false;
+			return SetpointPlaybackEnum::FINISHED;
+		}
+
+		// Start once something is queued
+		if ( !isPlaying ) {
+			if ( !isStartRequested || Count() == 0 ) return SetpointPlaybackEnum::IDLE;
+			isStartRequested = false;
+			isPlaying		 = true;
+			hasPrevious		 = false;
+			isUnderrun		 = false;
+			startUs			 = nowUs;
+		}
+
+		uint32_t t = nowUs - startUs;
+		latestUs   = t;
+
+		// Move p0 up to the segment containing t
+		while ( Count() >= 2 && point[( tail + 1 ) & CONST_STREAM_MASK].timeUs <= t ) {
+			previous	= point[tail];
+			hasPrevious = true;
+			std::atomic_signal_fence( std::memory_order_seq_cst );
+			tail = ( tail + 1 ) & CONST_STREAM_MASK;
+			pointsPlayed++;
+		}
+
+		const SetpointStruct& p0 = point[tail];
+
+		// Before the first setpoint, hold it
+		if ( t < p0.timeUs ) {
+			CopyValues( p0, output );
+			isUnderrun = false;
+			return SetpointPlaybackEnum::PLAYING;
+		}
+
+		// Past the last queued setpoint
+		if ( Count() < 2 ) {
+
+			// Finished
+			if ( isEndOfStream ) {
+				tail	  = head;
+				isPlaying = false;
+				return SetpointPlaybackEnum::FINISHED;
+			}
+
+			// Underrun: hold p0 until more arrive
+			if ( !isUnderrun ) underrunEvents++;
+			isUnderrun = true;
+			underrunTicks++;
+			CopyValues( p0, output );
+			return SetpointPlaybackEnum::UNDERRUN;
+		}
+		isUnderrun = false;
+
+		// Interpolate between p0 and p1
+		const SetpointStruct& p1	  = point[( tail + 1 ) & CONST_STREAM_MASK];
+		bool				  hasNext = Count() >= 3;
+		const SetpointStruct& p2	  = point[( tail + 2 ) & CONST_STREAM_MASK];
+		float				  h		  = float( p1.timeUs - p0.timeUs );
+		float				  s		  = float( t - p0.timeUs ) / h;
+
+		for ( uint8_t i = 0; i < 3; i++ ) {
+
+			// Headings take the short way round
+			bool  isHeading = ( format == SetpointFormatEnum::POLAR && i == 0 );
+			float v0		= p0.value[i];
+			float v1		= Unwrap( isHeading, v0, p1.value[i] );
+
+			if ( interpolation == SetpointInterpolationEnum::LINEAR ) {
+				output[i] = v0 + ( v1 - v0 ) * s;
+			} else {
+
+				// Cubic Hermite, tangents from the neighbouring setpoints (one-sided at the ends)
+				float slope = ( v1 - v0 ) / h;
+				float m0	= slope;
+				float m1	= slope;
+				if ( hasPrevious ) {
+					float vPrev = Unwrap( isHeading, v0, previous.value[i] );
+					m0			= ( v1 - vPrev ) / float( p1.timeUs - previous.timeUs );
+				}
+				if ( hasNext ) {
+					float v2 = Unwrap( isHeading, v1, p2.value[i] );
+					m1		 = ( v2 - v0 ) / float( p2.timeUs - p0.timeUs );
+				}
+				float s2  = s * s;
+				float s3  = s2 * s;
+				output[i] = ( 2.0f * s3 - 3.0f * s2 + 1.0f ) * v0 + ( s3 - 2.0f * s2 + s ) * h * m0 + ( -2.0f * s3 + 3.0f * s2 ) * v1 + ( s3 - s2 ) * h * m1;
+			}
+		}
+
+		return SetpointPlaybackEnum::PLAYING;
+	}
+
+	private:
+	// Bring a heading to within 180 deg of the reference so interpolation takes the short arc
+	static float Unwrap( bool isHeading, float reference, float value ) {
+		if ( !isHeading ) return value;
+		while ( value - reference > 180.0f ) value -= 360.0f;
+		while ( value - reference < -180.0f ) value += 360.0f;
+		return value;
+	}
+
+	static void CopyValues( const SetpointStruct& source, float* output ) {
+		output[0] = source.value[0];
+		output[1] = source.value[1];
+		output[2] = source.value[2];
+	}
+};
@@ -4,6 +4,11 @@
 #include <memory>
 #include <unordered_map>
 
+#include "EventQueue.h"
+#include "HapticCue.h"
+#include "SetpointStream.h"
+#include "Snapshot.h"
+
 
 
 #pragma once
@@ -93,12 +98,26 @@ class PWMClass {
 	int16_t totalOutgoingPrevA = CONST_PWM_ZERO;	// Total previous PWM
 	int16_t totalOutgoingPrevB = CONST_PWM_ZERO;	// Total previous PWM
 	int16_t totalOutgoingPrevC = CONST_PWM_ZERO;	// Total previous PWM
+
+	// Slew / jerk limiter (runs in the output ISR)
+	public:
+	bool  isSlewLimitEnabled = false;			  // Limit the change in PWM per tick
+	bool  isSCurveEnabled	 = false;			  // Also limit the change in that rate (S-curve ramps)
+	float slewMaxDelta		 = 20.0f;			  // Largest PWM change per tick
+	float slewMaxAccel		 = 1.0f;			  // Largest change of the PWM rate per tick (S-curve)
+	float slewOutgoingA		 = CONST_PWM_ZERO;	  // Limiter output
+	float slewOutgoingB		 = CONST_PWM_ZERO;	  // Limiter output
+	float slewOutgoingC		 = CONST_PWM_ZERO;	  // Limiter output
+	float slewRateA			 = 0.0f;			  // Limiter PWM change on the last tick
+	float slewRateB			 = 0.0f;			  // Limiter PWM change on the last tick
+	float slewRateC			 = 0.0f;			  // Limiter PWM change on the last tick
 };
 
 class DriveMappingClass {
 
 	public:
-	float		targetRadius   = 0.0f;				   // Radius for polar conversion
+	bool		isForceAllocationEnabled = false;	 // Allocate the target force over all three cables each output tick
+	float		targetRadius   = 0.0f;				   // Radius for polar conversion (force magnitude in percent when allocating)
 	float		targetAngleDeg = 0.0f;				   // Angle of actuation
 	float		contributionA  = 0.0f;				   // Contribution for motor A
 	float		contributionB  = 0.0f;				   // Contribution for motor B
@@ -112,9 +131,39 @@ class DriveMappingClass {
 };
 
 
+class DriveControlClass {
+
+	public:
+	bool  isClosedLoopEnabled	= false;	  // Run the current trim (and position hold) from the output ISR
+	bool  isPositionHoldEnabled = false;	  // Hold the encoder counts captured when enabled
+	float currentKp				= 0.5f;		  // Current trim per amp of current error
+	float currentKi				= 40.0f;	  // Current trim integral gain (1/s)
+	float positionKp			= 0.05f;	  // Hold current per count of position error (A/count)
+	float positionKd			= 0.001f;	  // Hold current per count/s of velocity (A s/count)
+	float trimLimitAmps			= 0.4f;		  // Largest correction the current loop may add or remove
+};
+
+
+/**
+ * @brief Drive output of one output tick, published whole after the PWM write
+ */
+struct DriveFrameStruct {
+	int16_t	 rawPwm[3]			  = { 2047, 2047, 2047 };	 // Raw PWM without tension (A, B, C)
+	int16_t	 totalPwm[3]		  = { 2047, 2047, 2047 };	 // PWM written (A, B, C)
+	float	 targetRadius		  = 0.0f;					 // Polar command radius
+	float	 targetAngleDeg		  = 0.0f;					 // Polar command angle
+	bool	 isMotorOutputEnabled = false;					 // Output enabled on this tick
+	uint32_t timeUs				  = 0;						 // Time of the tick
+};
+
+
 class DriveClass {
 	public:
+	SnapshotStruct<DriveFrameStruct> Snapshot;	  // Coherent copy for other contexts
 	DriveMappingClass MappingClass;
+	DriveControlClass Control;
+	SetpointStreamStruct Stream;	// Timestamped setpoints played back by the output ISR
+	HapticCueStruct		 Cue;		// Discrimination-task cue played back by the output ISR
 	DriveFlagsClass	  Flags;
 	DriveTensionClass Tension;
 	PWMClass		  Pwm;
@@ -143,6 +192,13 @@ class EnumsClass {
 	enum class SystemStateEnum : int8_t { IDLE, DISABLED, IDLING, RUNNING_TASK };
 	enum class TaskSelectionEnum : int8_t { NONE, MEASURING_RANGE_OF_MOTION, TESTING_CARDINAL_DIRECTIONS, TESTING_OCTANT_DIRECTIONS, TESTING_TARGET_ANGLE };
 	enum class DiscriminationTaskStateEnum : uint8_t { IDLE, STARTING, WAITING_FOR_DELAY, RENDERING_PROMPT, WAITING_FOR_RESPONSE, FINISHING };
+	enum class AmplifierQueryEnum : uint8_t { IDLE, RESET, GET_REGISTER, GET_BAUD, GET_NAME, SET_BAUD, SET_CURRENT_MODE, RESYNC, COUNT };
+	enum class AmplifierResponseEnum : uint8_t { NONE, VALUE, OK, ERROR, MALFORMED };
+	enum class AmplifierProtocolEnum : uint8_t { ASCII, BINARY };
+	enum class AmplifierInitStepEnum : uint8_t { RESETTING, OPENING_PORT, GET_NAME, GET_BAUD, SET_CURRENT_MODE, SET_BAUD, CONFIRM_BAUD, READY, FAILED, COUNT };
+	enum class TraceCaptureStateEnum : uint8_t { IDLE, CONFIGURING, ARMED, STARTING, RECORDING, STOPPING, FETCHING, COMPLETE, FAILED };
+	enum class RomSweepStateEnum : uint8_t { IDLE, RAMPING, RELEASING, SETTLING, COMPLETE };
+	enum class AmplifierEventEnum : uint8_t { LOG_TRACE_CAPTURE, STOP_ROM_SWEEP, FINISH_ROM_SWEEP, CURRENT_MODE_REJECTED_A, CURRENT_MODE_REJECTED_B, CURRENT_MODE_REJECTED_C };
 
 	public:
 	String MapSystemStateEnumToString( int8_t state );
@@ -183,6 +239,12 @@ class EnumsClass {
  *  ============================================================================================*/
 
 
+struct GamepadEventStruct {
+	int8_t	 button = -1;	 // Debounced button index
+	uint32_t timeMs = 0;	 // Time the press became stable
+};
+
+
 class GamepadInputClass {
 
 	private:
@@ -191,21 +253,18 @@ class GamepadInputClass {
 
 
 	public:
-	bool   isButtonPressed = false;
-	bool   isInputWaiting  = false;	   // Flag that indicates an input needing a response
-	int8_t buttonPressed   = -1;
-	String buttonName	   = "None";
+	bool										isButtonPressed = false;
+	EventQueueStruct<GamepadEventStruct, 8>		Events;					 // Presses waiting for a response
+	int8_t										buttonPressed	= -1;	 // Last press (display)
+	String										buttonName		= "None";
 };
 
 
 class PacketClass {
 	public:
-	String outgoingQueryA	= "";	 // ASCII Query being sent out
-	String outgoingQueryB	= "";	 // ASCII Query being sent out
-	String outgoingQueryC	= "";	 // ASCII Query being sent out
-	String respondingQueryA = "";	 // ASCII Query being received
-	String respondingQueryB = "";	 // ASCII Query being received
-	String respondingQueryC = "";	 // ASCII Query being received
+	EnumsClass::AmplifierQueryEnum outgoingQueryA = EnumsClass::AmplifierQueryEnum::IDLE;	 // Query awaiting a response
+	EnumsClass::AmplifierQueryEnum outgoingQueryB = EnumsClass::AmplifierQueryEnum::IDLE;	 // Query awaiting a response
+	EnumsClass::AmplifierQueryEnum outgoingQueryC = EnumsClass::AmplifierQueryEnum::IDLE;	 // Query awaiting a response
 };
 
 
@@ -214,6 +273,9 @@ class ConnectionClass {
 	uint32_t baudRateA = 0;		// Amp A baud rate
 	uint32_t baudRateB = 0;		// Amp B baud rate
 	uint32_t baudRateC = 0;		// Amp C baud rate
+	uint8_t	 baudFallbacksA = 0;	// Amp A rates rejected during negotiation
+	uint8_t	 baudFallbacksB = 0;	// Amp B rates rejected during negotiation
+	uint8_t	 baudFallbacksC = 0;	// Amp C rates rejected during negotiation
 	String	 ampNameA  = "";	// Amplifier name
 	String	 ampNameB  = "";	// Amplifier name
 	String	 ampNameC  = "";	// Amplifier name
@@ -224,8 +286,10 @@ class HardwareSerialClass {
 	ConnectionClass Connection;
 	PacketClass		Packets;
 
-	bool	 isConnected = false;
-	uint16_t baudRate	 = 0;
+	bool							  isConnected = false;
+	uint16_t						  baudRate	  = 0;
+	EnumsClass::AmplifierProtocolEnum protocol	  = EnumsClass::AmplifierProtocolEnum::ASCII;	 // Protocol used for sensor queries
+	bool							  isTraceCaptureEnabled = false;								 // Capture drive trace around each discrimination prompt
 };
 
 
@@ -257,6 +321,7 @@ class SoftwareSerialClass {
 	public:
 	bool isConnected			= false;
 	bool isScrollingLineEnabled = false;
+	bool isProfileLogEnabled	= false;	// Write the loop profile to the log periodically
 };
 
 
@@ -298,16 +363,19 @@ class PlatformEncodersClass {
 
 class EncoderLimitsClass {
 	public:
-	bool	isBeingMeasured = false;	// Is the limit being measured
-	bool	isSet			= false;	// Is the limit set
-	bool	isEnabled		= false;	// Is the limit enabled
-	bool	isBeingTested	= false;	// Is the limit being tested
-	int32_t limitCountA		= 0;		// Max value (count)
-	int32_t limitCountB		= 0;		// Max value (count)
-	int32_t limitCountC		= 0;		// Max value (count)
-	float	limitPhiDegA	= 0.0f;		// Max value (float)
-	float	limitPhiDegB	= 0.0f;		// Max value (float)
-	float	limitPhiDegC	= 0.0f;		// Max value (float)
+	bool	isBeingMeasured	   = false;	   // Is the limit being measured
+	bool	isSet			   = false;	   // Is the limit set
+	bool	isEnabled		   = false;	   // Is the limit enabled
+	bool	isBeingTested	   = false;	   // Is the limit being tested
+	bool	isMapBeingRecorded = false;	   // Is the heading map being recorded
+	bool	isMapSet		   = false;	   // Has the heading map been recorded or loaded
+	bool	isMapEnabled	   = false;	   // Is the heading map clamping commands
+	int32_t limitCountA		   = 0;		   // Max value (count)
+	int32_t limitCountB		   = 0;		   // Max value (count)
+	int32_t limitCountC		   = 0;		   // Max value (count)
+	float	limitPhiDegA	   = 0.0f;	   // Max value (float)
+	float	limitPhiDegB	   = 0.0f;	   // Max value (float)
+	float	limitPhiDegC	   = 0.0f;	   // Max value (float)
 };
 
 
@@ -356,11 +424,49 @@ class MotorCurrentsClass {
 };
 
 
+class AmplifierTelemetryClass {
+
+	// Low-rate amplifier registers
+	public:
+	float	busVoltageA	   = 0.0f;	  // Bus voltage in volts
+	float	busVoltageB	   = 0.0f;	  // Bus voltage in volts
+	float	busVoltageC	   = 0.0f;	  // Bus voltage in volts
+	float	driveTempDegCA = 0.0f;	  // Drive temperature in degrees C
+	float	driveTempDegCB = 0.0f;	  // Drive temperature in degrees C
+	float	driveTempDegCC = 0.0f;	  // Drive temperature in degrees C
+	int32_t statusA		   = 0;		  // Event status register
+	int32_t statusB		   = 0;		  // Event status register
+	int32_t statusC		   = 0;		  // Event status register
+	int32_t faultLatchA	   = 0;		  // Latched fault register
+	int32_t faultLatchB	   = 0;		  // Latched fault register
+	int32_t faultLatchC	   = 0;		  // Latched fault register
+};
+
+
+/**
+ * @brief Sensor readings one output tick works from, published whole
+ */
+struct SensorFrameStruct {
+	int32_t	 encoderCount[3]		  = { 0, 0, 0 };			// Compensated encoder counts (A, B, C)
+	uint32_t positionUs[3]			  = { 0, 0, 0 };			// Send time of the query behind each count
+	float	 currentAmps[3]			  = { 0.0f, 0.0f, 0.0f };	// Measured currents (A, B, C)
+	float	 platformHorizontalDeg	  = 0.0f;					// Platform arm, horizontal
+	float	 platformVerticalDeg	  = 0.0f;					// Platform arm, vertical
+	uint32_t timeUs					  = 0;						// Time of the tick
+
+	float MotorAngleDeg( uint8_t amp ) const {
+		return degrees( encoderCount[amp] * 2.0f * M_PI / 4096.0f );
+	}
+};
+
+
 class SensorsClass {
 	public:
-	PlatformEncodersClass PlatformEncoders;
-	MotorEncodersClass	  MotorEncoders;
-	MotorCurrentsClass	  MotorCurrents;
+	SnapshotStruct<SensorFrameStruct> Snapshot;	   // Coherent copy for other contexts
+	PlatformEncodersClass	PlatformEncoders;
+	MotorEncodersClass		MotorEncoders;
+	MotorCurrentsClass		MotorCurrents;
+	AmplifierTelemetryClass AmplifierTelemetry;
 };
 
 
@@ -429,6 +535,7 @@ class DiscriminationTaskClass {
 	public:
 	CardinalDirectionsClass CardinalDirections;
 	OctantDirectionsClass	OctantDirections;
+	HapticCueProfileStruct	CueProfile;	   // Shape of the prompt cue
 };
 
 class TasksClass {
@@ -462,6 +569,23 @@ class ActionsQueueClass {
 	bool zeroMotorEncoders		= false;
 	bool setMotorTension		= false;
 	bool setMotorTensionEnabled = false;
+	bool printAmplifierLinkStats = false;
+	bool armTraceCapture		 = false;
+	bool triggerTraceCapture	 = false;
+	bool printEncoderLimitSession = false;
+	bool startMeasuringLimits	  = false;
+	bool stopMeasuringLimits	  = false;
+	bool startRomMap			  = false;
+	bool finishRomMap			  = false;
+	bool printRomMap			  = false;
+	bool startRomSweep			  = false;
+	bool stopRomSweep			  = false;
+	bool printTickSchedulerStats  = false;
+	bool printLoopProfile		  = false;
+
+	// Raised outside loop() (one ring per producing context)
+	EventQueueStruct<EnumsClass::AmplifierEventEnum, 8> TickEvents;		   // Output ISR
+	EventQueueStruct<EnumsClass::AmplifierEventEnum, 8> ReceiveEvents;	   // Amplifier receive path (ISR or serialEvent)
 };
 
 
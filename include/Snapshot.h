@@ -0,0 +1,92 @@
+/**
+ * @file Snapshot.h
+ * @author Tomasz Trzpit
+ * @brief Versioned single-writer snapshot (seqlock) with copy statistics
+ * @version 0.1
+ * @date 2025-10-06
+ *
+ * One context publishes whole frames, any context reads a copy. The
+ * version is odd while a write is in progress, so a reader that gets
+ * preempted mid-copy sees the version change and copies again instead of
+ * returning a torn frame. Nobody disables interrupts. On this single-core
+ * target only the compiler has to be kept from reordering, hence signal
+ * fences.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "LoopProfiler.h"	 // For ProfilerCycles
+
+
+const uint8_t CONST_SNAPSHOT_READ_ATTEMPTS = 4;	   // Copies tried before a read gives up
+
+
+template <typename T>
+struct SnapshotStruct {
+
+	volatile uint32_t version = 0;	  // Even when stable
+	T				  frame;		  // Published frame (the writer may use it directly between Begin and EndPublish)
+
+	// Writer stats
+	uint32_t publishes		  = 0;	  // Frames published
+	uint32_t publishCyclesMax = 0;	  // Longest Publish() copy
+
+	// Reader stats (approximate when more than one context reads)
+	mutable uint32_t reads			 = 0;	 // Read() calls
+	mutable uint32_t retries		 = 0;	 // Copies repeated because a write overlapped
+	mutable uint32_t failures		 = 0;	 // Reads that gave up
+	mutable uint32_t copyCyclesMax	 = 0;	 // Longest Read(), retries included
+	mutable uint64_t copyCyclesTotal = 0;	 // Sum of Read() lengths
+
+	void BeginPublish() {
+		version++;
+		std::atomic_signal_fence( std::memory_order_seq_cst );
+	}
+
+	void EndPublish() {
+		std::atomic_signal_fence( std::memory_order_seq_cst );
+		version++;
+		publishes++;
+	}
+
+	void Publish( const T& source ) {
+		uint32_t start = ProfilerCycles();
+		BeginPublish();
+		frame = source;
+		EndPublish();
+		uint32_t cycles = ProfilerCycles() - start;
+		if ( cycles > publishCyclesMax ) publishCyclesMax = cycles;
+	}
+
+	bool Read( T& destination ) const {
+
+		uint32_t start	= ProfilerCycles();
+		bool	 isRead = false;
+
+		for ( uint8_t attempt = 0; attempt < CONST_SNAPSHOT_READ_ATTEMPTS && !isRead; attempt++ ) {
+			if ( attempt > 0 ) retries++;
+			uint32_t before = version;
+			if ( before & 1 ) continue;
+			std::atomic_signal_fence( std::memory_order_seq_cst );
+			destination = frame;
+			std::atomic_signal_fence( std::memory_order_seq_cst );
+			isRead = ( version == before );
+		}
+
+		uint32_t cycles = ProfilerCycles() - start;
+		reads++;
+		copyCyclesTotal += cycles;
+		if ( cycles > copyCyclesMax ) copyCyclesMax = cycles;
+		if ( !isRead ) failures++;
+		return isRead;
+	}
+
+	void ClearStats() {
+		publishes = publishCyclesMax = 0;
+		reads = retries = failures = copyCyclesMax = 0;
+		copyCyclesTotal							   = 0;
+	}
+};
@@ -16,8 +16,19 @@ struct DiscriminationTaskResultRuntimeStruct {
 	String	 responseString	   = "";	   // String of participant response to prompt
 	uint32_t responseTimeMs	   = 0.0f;	   // Participant task completion time [ms]
 	bool	 isResponseCorrect = false;	   // Flag if response correct
+	uint32_t cueOnsetUs		   = 0;		   // Tick the prompt cue began on [us]
 };
 
+
+/**
+ * @brief Heading (deg, 90 = up) of a discrimination direction (0 = up, clockwise in 45 deg steps)
+ */
+inline float MapDirectionToHeadingDeg( int8_t direction ) {
+
+	float heading = 90.0f - 45.0f * direction;
+	return ( heading < 0.0f ) ? heading + 360.0f : heading;
+}
+
 class CardinalDirectionsRuntimeClass {
 
 	// Functions
@@ -39,6 +50,9 @@ class CardinalDirectionsRuntimeClass {
 	private:
 	uint32_t			  timeTrialStartMs	 = 0;																																								// Time that the trial started (in Teensy milliseconds)
 	uint32_t			  timeDelayStartMs	 = 0;																																								// Time that the delay started (in Teensy milliseconds)
+	uint32_t			  timeDelayStartUs	 = 0;																																								// Time that the delay started (in Teensy microseconds)
+	bool				  isCueArmed		 = false;																																							// Cue synthesized for this trial
+	bool				  isCueReady		 = false;																																							// Cue synthesized and armed with the onset time
 	uint32_t			  timePromptStartMs	 = 0;																																								// Time that the prompt was presented (in Teensy milliseconds)
 	uint32_t			  timeTotalTask		 = 0;																																								// Total time for the task
 	const uint32_t		  MINIMUM_TIME_DELAY = 3000;																																							// Ms to wait between trials
@@ -67,6 +81,9 @@ class OctantDirectionsRuntimeClass {
 	private:
 	uint32_t			  timeTrialStartMs	 = 0;																																								// Time that the trial started (in Teensy milliseconds)
 	uint32_t			  timeDelayStartMs	 = 0;																																								// Time that the delay started (in Teensy milliseconds)
+	uint32_t			  timeDelayStartUs	 = 0;																																								// Time that the delay started (in Teensy microseconds)
+	bool				  isCueArmed		 = false;																																							// Cue synthesized for this trial
+	bool				  isCueReady		 = false;																																							// Cue synthesized and armed with the onset time
 	uint32_t			  timePromptStartMs	 = 0;																																								// Time that the prompt was presented (in Teensy milliseconds)
 	uint32_t			  timeTotalTask		 = 0;																																								// Total time for the task
 	const uint32_t		  MINIMUM_TIME_DELAY = 3000;																																							// Ms to wait between trials
@@ -0,0 +1,160 @@
+/**
+ * @file TickScheduler.h
+ * @author Tomasz Trzpit
+ * @brief One master timer tick running the periodic jobs in a fixed phase order
+ * @version 0.1
+ * @date 2025-10-06
+ *
+ * Jobs are declared once in setup() with a decimation of the master tick.
+ * On every tick the due jobs run in phase order (read, compute, actuate,
+ * report), then in the order they were added, so the time from a sensor
+ * query to the PWM write is the same on every tick instead of drifting with
+ * the phase of independent timers.
+ */
+
+#pragma once
+
+#include <Arduino.h>	// For ARM_DWT_CYCCNT
+
+
+// Scheduler sizing
+const uint32_t CONST_TICK_HZ	   = 1000;	  // Master tick rate
+const uint8_t  CONST_TICK_MAX_JOBS = 8;		  // Jobs that can be declared
+
+
+// Phases, run in this order within a tick
+enum class TickPhaseEnum : uint8_t { READ, COMPUTE, ACTUATE, REPORT };
+
+
+/**
+ * @brief One periodic job and its timing
+ *
+ * The deadline is measured from the start of the tick, so it bounds when
+ * the job finishes, including the jobs ahead of it.
+ */
+struct TickJobStruct {
+
+	// Declaration
+	const char*	  name			 = "";						  // Label for the stats
+	void		  ( *run )()	 = nullptr;					  // Job body
+	TickPhaseEnum phase			 = TickPhaseEnum::REPORT;	  // Phase within the tick
+	uint16_t	  divider		 = 1;						  // Runs every divider ticks
+	uint16_t	  offset		 = 0;						  // Tick within the divider it runs on
+	uint32_t	  deadlineCycles = 0;						  // Latest finish after the tick start
+
+	// Stats (cleared when printed)
+	volatile uint32_t runs		  = 0;	  // Times run
+	volatile uint32_t overruns	  = 0;	  // Runs that finished past the deadline
+	volatile uint32_t cyclesLast  = 0;	  // Length of the last run
+	volatile uint32_t cyclesMax	  = 0;	  // Longest run
+	volatile uint64_t cyclesTotal = 0;	  // Sum of run lengths
+	volatile uint32_t finishMax	  = 0;	  // Latest finish after the tick start
+};
+
+
+/**
+ * @brief Master tick and its declared jobs
+ */
+struct TickSchedulerStruct {
+
+	TickJobStruct	  job[CONST_TICK_MAX_JOBS];	   // Jobs, kept in run order
+	uint8_t			  jobCount		 = 0;		   // Jobs declared
+	volatile uint32_t tick			 = 0;		   // Ticks since start
+	uint32_t		  periodCycles	 = 0;		   // Cycles in one tick
+	volatile uint32_t tickCyclesMax	 = 0;		   // Longest tick
+	volatile uint32_t tickOverruns	 = 0;		   // Ticks longer than the period
+	volatile uint32_t statsStartTick = 0;		   // Tick the stats were last cleared on
+
+	// Start latency (how long another ISR or a critical section held the tick off)
+	uint32_t		  lastStartCycles	 = 0;		// Start of the previous tick
+	volatile uint32_t startLateCyclesMax = 0;		// Largest start delay
+
+
+	void Begin( uint32_t tickHz ) {
+		periodCycles = F_CPU_ACTUAL / tickHz;
+	}
+
+	/**
+	 * @brief Declare a job (before the tick timer starts)
+	 *
+	 * @param deadlineUs Latest finish after the tick start
+	 * @return false if the table is full or the divider is zero
+	 */
+	bool Add( const char* name, void ( *run )(), TickPhaseEnum phase, uint16_t divider, uint16_t offset, uint32_t deadlineUs ) {
+
+		if ( jobCount >= CONST_TICK_MAX_JOBS || divider == 0 ) return false;
+
+		// Insert after every job of the same or an earlier phase
+		uint8_t slot = jobCount;
+		while ( slot > 0 && job[slot - 1].phase > phase ) {
+			job[slot] = job[slot - 1];
+			slot--;
+		}
+
+		job[slot]				 = TickJobStruct();
+		job[slot].name			 = name;
+		job[slot].run			 = run;
+		job[slot].phase			 = phase;
+		job[slot].divider		 = divider;
+		job[slot].offset		 = offset % divider;
+		job[slot].deadlineCycles = deadlineUs * ( F_CPU_ACTUAL / 1000000 );
+		jobCount++;
+		return true;
+	}
+
+	/**
+	 * @brief Run the jobs due on this tick (tick timer ISR)
+	 */
+	void Run() {
+
+		uint32_t startCycles = ARM_DWT_CYCCNT;
+
+		// Start latency
+		if ( tick != 0 ) {
+			uint32_t gap = startCycles - lastStartCycles;
+			if ( gap > periodCycles && gap - periodCycles > startLateCyclesMax ) startLateCyclesMax = gap - periodCycles;
+		}
+		lastStartCycles = startCycles;
+
+		for ( uint8_t i = 0; i < jobCount; i++ ) {
+
+			TickJobStruct& Job = job[i];
+			if ( tick % Job.divider != Job.offset ) continue;
+
+			uint32_t jobStart = ARM_DWT_CYCCNT;
+			Job.run();
+			uint32_t jobEnd = ARM_DWT_CYCCNT;
+
+			uint32_t length = jobEnd - jobStart;
+			uint32_t finish = jobEnd - startCycles;
+			Job.runs++;
+			Job.cyclesLast = length;
+			Job.cyclesTotal += length;
+			if ( length > Job.cyclesMax ) Job.cyclesMax = length;
+			if ( finish > Job.finishMax ) Job.finishMax = finish;
+			if ( finish > Job.deadlineCycles ) Job.overruns++;
+		}
+
+		uint32_t tickCycles = ARM_DWT_CYCCNT - startCycles;
+		if ( tickCycles > tickCyclesMax ) tickCyclesMax = tickCycles;
+		if ( tickCycles > periodCycles ) tickOverruns++;
+		tick++;
+	}
+
+	/**
+	 * @brief Clear the stats (loop(), with the tick timer running)
+	 */
+	void ClearStats() {
+		for ( uint8_t i = 0; i < jobCount; i++ ) {
+			job[i].runs		   = 0;
+			job[i].overruns	   = 0;
+			job[i].cyclesMax   = 0;
+			job[i].cyclesTotal = 0;
+			job[i].finishMax   = 0;
+		}
+		tickCyclesMax	   = 0;
+		tickOverruns	   = 0;
+		startLateCyclesMax = 0;
+		statsStartTick	   = tick;
+	}
+};
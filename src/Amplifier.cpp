@@ -1,5 +1,6 @@
 #include "Amplifier.h"
 #include "SharedMemory.h"	 // Shared memory manager
+#include <EEPROM.h>			 // Stored range-of-motion map
 
 // Global hook initialization
 AmplifierClass* AmplifierClass::instance = nullptr;
@@ -39,6 +40,23 @@ void AmplifierClass::Loop() {
 
 	// Read safety switch
 	ReadSafetySwitchState();
+
+	// Verbose dump of responses parsed in the receive ISR
+	PrintPacketLog();
+
+	// Bring up amplifiers
+	if ( !isInitializationComplete ) {
+		ServiceInitialization();
+		return;
+	}
+
+	// Drive trace captures
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		ServiceTraceCapture( amp );
+	}
+
+	// Top up the setpoint stream from the on-device generator
+	SYSTEM_GLOBAL.GetData()->Drive.Stream.ServiceGenerator();
 }
 
 
@@ -59,25 +77,43 @@ void AmplifierClass::Loop() {
 
 /**
  * @brief Initialize amplifiers and their elements
+ * 
+ * Returns immediately. The amplifiers are brought up in parallel by
+ * ServiceInitialization() from Loop(), and sensor polling starts when done.
+ * 
+ * @param protocol Protocol used for sensor queries after initialization
  */
-void AmplifierClass::Begin() {
+void AmplifierClass::Begin( EnumsClass::AmplifierProtocolEnum protocol ) {
 
+	// Build binary register reads
+	BINARY.AddGet( EnumsClass::AmplifierQueryEnum::GET_BAUD, CONST_COPLEY_REG_BAUD );
+	BINARY.AddGet( EnumsClass::AmplifierQueryEnum::RESYNC, CONST_COPLEY_REG_BAUD );
+
+	// Registers polled once running
+	BuildPollTable();
 
 	// Configure pins
 	ConfigurePins();
 
-	// Reset amplifier to clear settings
-	Reset();
+	// Room for a full burst of replies between receive timer ticks
+	HWSerialA.addMemoryForRead( rxExtraBufferA, sizeof( rxExtraBufferA ) );
+	HWSerialB.addMemoryForRead( rxExtraBufferB, sizeof( rxExtraBufferB ) );
+	HWSerialC.addMemoryForRead( rxExtraBufferC, sizeof( rxExtraBufferC ) );
 
-	// Initialize hardware serial interfaces
-	InitializeAmplifierA();
-	InitializeAmplifierB();
-	InitializeAmplifierC();
+	// Protocol for sensor queries once initialized (initialization itself is ASCII)
+	requestedProtocol = protocol;
 
-	// Send initial zero command to enable output
+	// Send initial zero command
 	CommandZero();
 
-	Serial.println( F( "AMPLIFIER:     All amplifiers...                       Ready." ) );
+	// Range-of-motion map from the last recording
+	LoadRomMap();
+
+	// Reset amplifiers to clear settings, the rest of the sequence runs from Loop()
+	initStartUs = micros();
+	Reset();
+
+	Serial.println( F( "AMPLIFIER:     Amplifier initialization...             Started." ) );
 }
 
 
@@ -116,628 +152,1772 @@ void AmplifierClass::ConfigurePins() {
 
 
 // ================================================================================================
-// === INITIALZIE AMPLIFIERS ======================================================================
+// === INITIALIZE AMPLIFIERS ======================================================================
 // ================================================================================================
 
-/**
- * @brief Initialize amplifier B
- */
-void AmplifierClass::InitializeAmplifierA() {
-
-	// Initialize
-	HWSerialA.begin( 9600 );
-	delay( 250 );
+// Query sent when entering each step (IDLE = no query)
+static const EnumsClass::AmplifierQueryEnum INIT_STEP_QUERY[uint8_t( EnumsClass::AmplifierInitStepEnum::COUNT )] = {
+	EnumsClass::AmplifierQueryEnum::IDLE,				 // RESETTING
+	EnumsClass::AmplifierQueryEnum::IDLE,				 // OPENING_PORT
+	EnumsClass::AmplifierQueryEnum::GET_NAME,			 // GET_NAME
+	EnumsClass::AmplifierQueryEnum::GET_BAUD,			 // GET_BAUD
+	EnumsClass::AmplifierQueryEnum::SET_CURRENT_MODE,	 // SET_CURRENT_MODE
+	EnumsClass::AmplifierQueryEnum::SET_BAUD,			 // SET_BAUD
+	EnumsClass::AmplifierQueryEnum::GET_BAUD,			 // CONFIRM_BAUD
+	EnumsClass::AmplifierQueryEnum::IDLE,				 // READY
+	EnumsClass::AmplifierQueryEnum::IDLE,				 // FAILED
+};
 
-	// Clear connection
-	HWSerialA.clear();
+// Step names for the boot report
+static const char* INIT_STEP_NAME[uint8_t( EnumsClass::AmplifierInitStepEnum::COUNT )] = { "reset", "port", "name", "baud", "mode", "set baud", "confirm", "ready", "failed" };
 
-	// Read amplifier name
-	SendQueryA( ASCII.getName );
-	delay( 100 );
 
-	// Read to confirm connection update
-	SendQueryA( ASCII.getBaud );
-	delay( 100 );
 
-	// Set amplifier into PWM current-control mode
-	SendQueryA( ASCII.setCurrentMode );
-	delay( 250 );
+/**
+ * @brief Advance the initialization sequence of every amplifier
+ */
+void AmplifierClass::ServiceInitialization() {
 
-	// Set amplifier into higher baud rate
-	SendQueryA( ASCII.setBaud115237 );
-	delay( 100 );
+	// Advance each amplifier independently
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		ServiceInitializationStep( amp );
+	}
 
-	// Restart HWSerialA connection
-	HWSerialA.end();
-	HWSerialA.begin( 115237 );
+	// Check if every amplifier is done
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		EnumsClass::AmplifierInitStepEnum step = GetInit( amp ).step;
+		if ( step != EnumsClass::AmplifierInitStepEnum::READY && step != EnumsClass::AmplifierInitStepEnum::FAILED ) {
+			return;
+		}
+	}
 
-	// Read to confirm connection update
-	SendQueryA( ASCII.getBaud );
-	delay( 100 );
+	FinishInitialization();
+}
 
-	// Send initial zero command to enable output
-	CommandZero();
 
-	Serial.println( F( "AMPLIFIER:     Amplifier A starting up...              Ready." ) );
-	// XXX          F(  X              X                                      X
-}
 
 /**
- * @brief Initialize amplifier B
+ * @brief Advance one amplifier's initialization sequence
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
  */
-void AmplifierClass::InitializeAmplifierB() {
+void AmplifierClass::ServiceInitializationStep( uint8_t amp ) {
 
-	// Initialize
-	HWSerialB.begin( 9600 );
-	delay( 250 );
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-	// Clear connection
-	HWSerialB.clear();
+	AmpInitStruct& Init	   = GetInit( amp );
+	uint32_t	   elapsed = micros() - Init.stepStartUs;
 
-	// Read amplifier name
-	SendQueryB( ASCII.getName );
-	delay( 100 );
+	switch ( Init.step ) {
 
-	// Read to confirm connection update
-	SendQueryB( ASCII.getBaud );
-	delay( 100 );
+		// Release reset after the hold time and open the port at the reset baud rate
+		case EnumsClass::AmplifierInitStepEnum::RESETTING: {
+			if ( elapsed >= CONST_AMP_RESET_HOLD_US ) {
+				digitalWriteFast( GetEnablePin( amp ), HIGH );
+				GetPort( amp ).begin( CONST_AMP_INITIAL_BAUD );
+				AdvanceInitialization( amp, EnumsClass::AmplifierInitStepEnum::OPENING_PORT );
+			}
+			break;
+		}
 
-	// Set amplifier into PWM current-control mode
-	SendQueryB( ASCII.setCurrentMode );
-	delay( 250 );
+		// Discard anything received while the port settled, then start querying
+		case EnumsClass::AmplifierInitStepEnum::OPENING_PORT: {
+			if ( elapsed >= CONST_AMP_PORT_SETTLE_US ) {
+				GetPort( amp ).clear();
+				GetRx( amp ).Clear();
+				AdvanceInitialization( amp, EnumsClass::AmplifierInitStepEnum::GET_NAME );
+			}
+			break;
+		}
 
-	// Set amplifier into higher baud rate
-	SendQueryB( ASCII.setBaud115237 );
-	delay( 100 );
+		// Nothing left to do
+		case EnumsClass::AmplifierInitStepEnum::READY:
+		case EnumsClass::AmplifierInitStepEnum::FAILED: {
+			break;
+		}
 
-	// Restart HWSerialA connection
-	HWSerialB.end();
-	HWSerialB.begin( 115237 );
+		// Query steps advance on their response
+		default: {
+
+			if ( Init.isResponseReceived ) {
+
+				// Response was written before the flag
+				std::atomic_signal_fence( std::memory_order_seq_cst );
+
+				// Name was copied in the receive ISR, the String is filled here where allocating is safe
+				if ( Init.step == EnumsClass::AmplifierInitStepEnum::GET_NAME ) {
+					String& ampName = ( amp == 0 ) ? Shared->Interface.HWSerial.Connection.ampNameA : ( amp == 1 ) ? Shared->Interface.HWSerial.Connection.ampNameB : Shared->Interface.HWSerial.Connection.ampNameC;
+					ampName			= Init.name;
+				}
+
+				// Amplifier answers at the old rate before switching
+				if ( Init.step == EnumsClass::AmplifierInitStepEnum::SET_BAUD ) {
+
+					// Rate rejected, amplifier is still at the reset rate so offer the next one
+					if ( Init.response.type != EnumsClass::AmplifierResponseEnum::OK ) {
+						if ( ++Init.baudIndex >= CONST_AMP_BAUD_CANDIDATE_COUNT ) {
+							AdvanceInitialization( amp, EnumsClass::AmplifierInitStepEnum::FAILED );
+						} else {
+							Init.isResponseReceived = false;
+							Init.stepStartUs		= micros();
+							SendQuery( amp, EnumsClass::AmplifierQueryEnum::SET_BAUD );
+						}
+						break;
+					}
+
+					// Follow the amplifier to the new rate
+					GetPort( amp ).end();
+					GetPort( amp ).begin( CONST_AMP_BAUD_CANDIDATES[Init.baudIndex] );
+					GetRx( amp ).Clear();
+				}
+
+				// Link confirmed if the amplifier reports the probed rate back intact
+				if ( Init.step == EnumsClass::AmplifierInitStepEnum::CONFIRM_BAUD ) {
+					if ( Init.response.type == EnumsClass::AmplifierResponseEnum::VALUE && uint32_t( Init.response.value ) == CONST_AMP_BAUD_CANDIDATES[Init.baudIndex] ) {
+						AdvanceInitialization( amp, EnumsClass::AmplifierInitStepEnum::READY );
+					} else {
+						FallBackBaud( amp );
+					}
+					break;
+				}
+
+				AdvanceInitialization( amp, EnumsClass::AmplifierInitStepEnum( uint8_t( Init.step ) + 1 ) );
+
+			} else if ( elapsed >= CONST_AMP_STEP_TIMEOUT_US ) {
+
+				// Give up on this rate (garbled link) or on this amplifier
+				if ( Init.retries >= CONST_AMP_STEP_RETRIES ) {
+					if ( Init.step == EnumsClass::AmplifierInitStepEnum::CONFIRM_BAUD ) {
+						FallBackBaud( amp );
+					} else {
+						AdvanceInitialization( amp, EnumsClass::AmplifierInitStepEnum::FAILED );
+					}
+					break;
+				}
+
+				// Resend the step's query
+				GetLink( amp ).timeouts++;
+				Init.retries++;
+				Init.stepStartUs = micros();
+				GetRx( amp ).Clear();
+				SendQuery( amp, INIT_STEP_QUERY[uint8_t( Init.step )] );
+			}
+			break;
+		}
+	}
+}
 
-	// Read to confirm connection update
-	SendQueryB( ASCII.getBaud );
-	delay( 100 );
 
-	Serial.println( F( "AMPLIFIER:     Amplifier B starting up...              Ready." ) );
-	// XXX          F(  X              X                                      X
-}
 
 /**
- * @brief Initialize amplifier C
+ * @brief Move an amplifier to its next initialization step
+ * 
+ * Records how long the current step took and sends the next step's query.
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
+ * @param nextStep Step to move to
  */
-void AmplifierClass::InitializeAmplifierC() {
-
-	// Initialize
-	HWSerialC.begin( 9600 );
-	delay( 250 );
-
-	// Clear connection
-	HWSerialC.clear();
+void AmplifierClass::AdvanceInitialization( uint8_t amp, EnumsClass::AmplifierInitStepEnum nextStep ) {
 
-	// Read amplifier name
-	SendQueryC( ASCII.getName );
-	delay( 100 );
+	AmpInitStruct& Init = GetInit( amp );
+	uint32_t	   now	= micros();
 
-	// Read to confirm connection update
-	SendQueryC( ASCII.getBaud );
-	delay( 100 );
+	// Record time spent in the finished step (accumulates across baud fallbacks)
+	Init.stepDurationUs[uint8_t( Init.step )] += now - Init.stepStartUs;
 
-	// Set amplifier into PWM current-control mode
-	SendQueryC( ASCII.setCurrentMode );
-	delay( 250 );
+	// Start the next step
+	Init.step				= nextStep;
+	Init.stepStartUs		= now;
+	Init.retries			= 0;
+	Init.isResponseReceived = false;
 
-	// Set amplifier into higher baud rate
-	SendQueryC( ASCII.setBaud115237 );
-	delay( 100 );
-
-	// Restart HWSerialA connection
-	HWSerialC.end();
-	HWSerialC.begin( 115237 );
-
-	// Read to confirm connection update
-	SendQueryC( ASCII.getBaud );
-	delay( 100 );
-
-	Serial.println( F( "AMPLIFIER:     Amplifier C starting up...              Ready." ) );
-	// XXX          F(  X              X                                      X
+	// Send the step's query
+	if ( INIT_STEP_QUERY[uint8_t( nextStep )] != EnumsClass::AmplifierQueryEnum::IDLE ) {
+		SendQuery( amp, INIT_STEP_QUERY[uint8_t( nextStep )] );
+	}
 }
 
 
 
-// /**
-//  * =============================================================================================
-//  * =============================================================================================
-//  *
-//  * H   H  W     W     SSSS   EEEEEE  RRRRR    IIIIII   AAAAA   LL
-//  * H   H  W     W    SS      EE      RR  RR     II    AA   AA  LL
-//  * H   H  W     W    SS      EE      RR  RR     II    AA   AA  LL
-//  * HHHHH  W  W  W     SSSS   EEEE    RRRRR      II    AAAAAAA  LL
-//  * H   H  W W W W        SS  EE      RR  RR     II    AA   AA  LL
-//  * H   H  WW WW W        SS  EE      RR  RR     II    AA   AA  LL
-//  * H   H   W   W      SSSS   EEEEEE  RR   RR  IIIIII  AA   AA  LLLLL
-//  *
-//  * =============================================================================================
-//  * =============================================================================================
-//  *
-//  * The Teensy communicates with the amplifiers using hardware serial ports,
-//  * with HWSerialA = Serial5, HWSerialB = Serial5, and HWSerialC = Serial3.
-//  * To properly do these communications, we use a queue of queries,
-//  * where each query is a pre-defined String variable. The process is as follows:
-//  *
-//  * 1: Use HWSerial_EnqueueQuery to add the query to the queryQueue
-//  * 2: In our Update loop, make sure we're not awaiting a response and that
-//  *    the queue is empty, then process the next item in the queue using
-//  *    HWSerial_ProcessQuery
-//  * 3: If bytes are availalbe on the HWSerial port, read the response using
-//  *    HWSerial_ReadResponse
-//  * 4: Parse the response using HWSerial_ParseResponse
-//  */
-
-
-
-// ================================================================================================
-// === SERIAL EVENT HANDLER =======================================================================
-// ================================================================================================
-
 /**
- * @brief Serial event handler for HWSerial5 (ampA)
+ * @brief Reset an amplifier and probe the next slower baud rate
+ * 
+ * The amplifier has already switched to the failed rate, so the only way back
+ * to a known rate is a reset. The sequence then reruns with the next candidate.
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
  */
-void serialEvent5() {
+void AmplifierClass::FallBackBaud( uint8_t amp ) {
 
-	// Connect hook to class function
-	if ( AmplifierClass::instance ) {
-		AmplifierClass::instance->OnHWSerialAEvent();
-	}
-}
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-/**
- * @brief Serial event handler for HWSerial4 (ampB)
- */
-void serialEvent4() {
+	AmpInitStruct& Init = GetInit( amp );
 
-	// Connect hook to class function
-	if ( AmplifierClass::instance ) {
-		AmplifierClass::instance->OnHWSerialBEvent();
+	// Count rejected rate
+	if ( amp == 0 ) {
+		Shared->Interface.HWSerial.Connection.baudFallbacksA++;
+	} else if ( amp == 1 ) {
+		Shared->Interface.HWSerial.Connection.baudFallbacksB++;
+	} else {
+		Shared->Interface.HWSerial.Connection.baudFallbacksC++;
 	}
-}
-
-/**
- * @brief Serial event handler for HWSerial3 (ampC)
- */
-void serialEvent3() {
 
-	// Connect hook to class function
-	if ( AmplifierClass::instance ) {
-		AmplifierClass::instance->OnHWSerialCEvent();
+	// No slower rate left
+	if ( ++Init.baudIndex >= CONST_AMP_BAUD_CANDIDATE_COUNT ) {
+		AdvanceInitialization( amp, EnumsClass::AmplifierInitStepEnum::FAILED );
+		return;
 	}
-}
 
+	// Reset this amplifier only and start over
+	GetPort( amp ).end();
+	digitalWriteFast( GetEnablePin( amp ), LOW );
+	AdvanceInitialization( amp, EnumsClass::AmplifierInitStepEnum::RESETTING );
+}
 
 
-// ================================================================================================
-// === SERIAL EVENT CALLBACK ======================================================================
-// ================================================================================================
 
 /**
- * @brief Callback for HWSerialA (port 5)
+ * @brief Switch to the sensor protocol and start polling once every amplifier is done
  */
-void AmplifierClass::OnHWSerialAEvent() {
+void AmplifierClass::FinishInitialization() {
 
 	// Shared Memory Alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-	// Read data while buffer is populated
-	while ( HWSerialA.available() > 0 ) {
-
-		// Read each byte
-		char incomingChar = ( char )HWSerialA.read();
-
-		// Look for terminating character
-		if ( incomingChar == '\r' || incomingChar == '\n' ) {
+	// Send initial zero command to enable output
+	CommandZero();
 
-			// Make sure packet isn't empty
-			if ( Shared->Interface.HWSerial.Packets.respondingQueryA != "" ) {
+	// Record negotiated rates
+	Shared->Interface.HWSerial.Connection.baudRateA = ( InitA.step == EnumsClass::AmplifierInitStepEnum::READY ) ? CONST_AMP_BAUD_CANDIDATES[InitA.baudIndex] : 0;
+	Shared->Interface.HWSerial.Connection.baudRateB = ( InitB.step == EnumsClass::AmplifierInitStepEnum::READY ) ? CONST_AMP_BAUD_CANDIDATES[InitB.baudIndex] : 0;
+	Shared->Interface.HWSerial.Connection.baudRateC = ( InitC.step == EnumsClass::AmplifierInitStepEnum::READY ) ? CONST_AMP_BAUD_CANDIDATES[InitC.baudIndex] : 0;
+	Shared->Interface.HWSerial.isConnected			= Shared->Interface.HWSerial.Connection.baudRateA || Shared->Interface.HWSerial.Connection.baudRateB || Shared->Interface.HWSerial.Connection.baudRateC;
 
-				// Parse packet
-				ParseQueryA();
-			}
-		} else {
-			Shared->Interface.HWSerial.Packets.respondingQueryA += incomingChar;
+	// Query deadlines at the negotiated rates (10 bits per byte on the wire)
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		if ( GetInit( amp ).step == EnumsClass::AmplifierInitStepEnum::READY ) {
+			GetPoll( amp ).deadlineWindowUs = SENSOR_RESPONSE_LATENCY_US + ( SENSOR_ROUND_TRIP_BYTES * 10 * 1000000UL ) / CONST_AMP_BAUD_CANDIDATES[GetInit( amp ).baudIndex];
 		}
 	}
-}
-
-/**
- * @brief Callback for HWSerialB (port 4)
- */
-void AmplifierClass::OnHWSerialBEvent() {
 
-	// Shared Memory Alias
-	static auto Shared = SYSTEM_GLOBAL.GetData();
+	// Initialization always runs in ASCII, switch to the requested protocol for sensor queries
+	RxA.Clear();
+	RxB.Clear();
+	RxC.Clear();
+	activeProtocol						= requestedProtocol;
+	Shared->Interface.HWSerial.protocol = requestedProtocol;
 
-	// Read data while buffer is populated
-	while ( HWSerialB.available() > 0 ) {
+	if ( requestedProtocol == EnumsClass::AmplifierProtocolEnum::BINARY ) {
+		Serial.println( F( "AMPLIFIER:     Sensor protocol...                      Binary." ) );
+	} else {
+		Serial.println( F( "AMPLIFIER:     Sensor protocol...                      ASCII." ) );
+	}
 
-		// Read each byte
-		char incomingChar = ( char )HWSerialB.read();
+	// Start sensor query pipeline
+	isInitializationComplete = true;
+	isSensorPollingEnabled	 = true;
 
-		// Look for terminating character
-		if ( incomingChar == '\r' || incomingChar == '\n' ) {
+	// Report
+	PrintBootReport();
+	PrintPollBudget();
+	Serial.println( F( "AMPLIFIER:     All amplifiers...                       Ready." ) );
+}
 
-			// Make sure packet isn't empty
-			if ( Shared->Interface.HWSerial.Packets.respondingQueryB != "" ) {
 
-				// Parse packet
-				ParseQueryB();
-			}
-		} else {
-			Shared->Interface.HWSerial.Packets.respondingQueryB += incomingChar;
-		}
-	}
-}
 
 /**
- * @brief Callback for HWSerialC (port 3)
+ * @brief Print how long each amplifier spent in each initialization step
  */
-void AmplifierClass::OnHWSerialCEvent() {
-
-	// Shared Memory Alias
-	static auto Shared = SYSTEM_GLOBAL.GetData();
+void AmplifierClass::PrintBootReport() {
 
-	// Read data while buffer is populated
-	while ( HWSerialC.available() > 0 ) {
+	const char ampNames[CONST_AMP_COUNT] = { 'A', 'B', 'C' };
 
-		// Read each byte
-		char incomingChar = ( char )HWSerialC.read();
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
 
-		// Look for terminating character
-		if ( incomingChar == '\r' || incomingChar == '\n' ) {
+		AmpInitStruct& Init = GetInit( amp );
 
-			// Make sure packet isn't empty
-			if ( Shared->Interface.HWSerial.Packets.respondingQueryC != "" ) {
+		Serial.print( F( "AMPLIFIER:     Amplifier " ) );
+		Serial.print( ampNames[amp] );
+		Serial.print( Init.step == EnumsClass::AmplifierInitStepEnum::READY ? F( " ready in " ) : F( " FAILED after " ) );
+		Serial.print( ( Init.stepStartUs - initStartUs ) / 1000.0f, 1 );
+		Serial.print( F( " ms at " ) );
+		Serial.print( Init.baudIndex < CONST_AMP_BAUD_CANDIDATE_COUNT ? CONST_AMP_BAUD_CANDIDATES[Init.baudIndex] : 0 );
+		Serial.print( F( " baud (" ) );
 
-				// Parse packet
-				ParseQueryC();
-			}
-		} else {
-			Shared->Interface.HWSerial.Packets.respondingQueryC += incomingChar;
+		// Time spent in each step
+		for ( uint8_t step = 0; step < uint8_t( EnumsClass::AmplifierInitStepEnum::READY ); step++ ) {
+			Serial.print( INIT_STEP_NAME[step] );
+			Serial.print( F( " " ) );
+			Serial.print( Init.stepDurationUs[step] / 1000.0f, 1 );
+			Serial.print( step + 1 < uint8_t( EnumsClass::AmplifierInitStepEnum::READY ) ? F( ", " ) : F( ")" ) );
 		}
+		Serial.println();
 	}
+
+	Serial.print( F( "AMPLIFIER:     Time since power-on...                  " ) );
+	Serial.print( millis() );
+	Serial.println( F( " ms" ) );
 }
 
 
 
 // ================================================================================================
-// === SEND QUERY =================================================================================
+// === TRACE CAPTURE ==============================================================================
 // ================================================================================================
 
 /**
- * @brief Sends a query string to amp A
+ * @brief Configure the drive trace on every ready amplifier
+ * 
+ * Selects current and position at ~1 kHz. Done ahead of the event so the
+ * trigger itself is a single packet.
  */
-void AmplifierClass::SendQueryA( String newQuery ) {
+void AmplifierClass::ArmTraceCapture() {
 
 	// Shared Memory Alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-	// Update outgoing query
-	Shared->Interface.HWSerial.Packets.outgoingQueryA = newQuery;
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.armTraceCapture );
 
-	// Send packet
-	HWSerialA.print( newQuery );
-}
+	if ( !Shared->Interface.HWSerial.isTraceCaptureEnabled || !isInitializationComplete ) {
+		return;
+	}
 
-/**
- * @brief Sends a query string to amp B
- */
-void AmplifierClass::SendQueryB( String newQuery ) {
+	// Trace upload is binary only
+	if ( activeProtocol != EnumsClass::AmplifierProtocolEnum::BINARY ) {
+		Serial.println( F( "AMPLIFIER:     Trace capture needs the binary protocol." ) );
+		return;
+	}
 
-	// Shared Memory Alias
-	static auto Shared = SYSTEM_GLOBAL.GetData();
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
 
-	// Update outgoing query
-	Shared->Interface.HWSerial.Packets.outgoingQueryB = newQuery;
+		TraceCaptureStruct& Trace = GetTrace( amp );
+
+		// Skip amplifiers that are down or already armed / busy
+		if ( GetInit( amp ).step != EnumsClass::AmplifierInitStepEnum::READY ) continue;
+		if ( Trace.state != EnumsClass::TraceCaptureStateEnum::IDLE && Trace.state != EnumsClass::TraceCaptureStateEnum::COMPLETE && Trace.state != EnumsClass::TraceCaptureStateEnum::FAILED ) continue;
 
-	// Send packet
-	HWSerialB.print( newQuery );
+		Trace.state			= EnumsClass::TraceCaptureStateEnum::CONFIGURING;
+		Trace.configureStep = 0;
+		Trace.sampleCount	= 0;
+		Trace.isAwaiting	= false;
+		GetPollingPaused( amp ) = true;
+	}
 }
 
+
+
 /**
- * @brief Sends a query string to amp C
+ * @brief Start recording on every armed amplifier
  */
-void AmplifierClass::SendQueryC( String newQuery ) {
+void AmplifierClass::TriggerTraceCapture() {
 
 	// Shared Memory Alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-	// Update outgoing query
-	Shared->Interface.HWSerial.Packets.outgoingQueryC = newQuery;
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.triggerTraceCapture );
 
-	// Send packet
-	HWSerialC.print( newQuery );
-}
+	traceTriggerUs = micros();
 
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		if ( GetTrace( amp ).state == EnumsClass::TraceCaptureStateEnum::ARMED ) {
+			GetTrace( amp ).state	= EnumsClass::TraceCaptureStateEnum::STARTING;
+			GetPollingPaused( amp ) = true;
+		}
+	}
+}
 
 
-// ================================================================================================
-// === PARSE QUERY ================================================================================
-// ================================================================================================
 
 /**
- * @brief Parse packet from amp A
+ * @brief Advance one amplifier's trace capture
+ * 
+ * Runs from Loop(). Trace packets go out only once the port's sensor query has
+ * completed. While a packet is awaiting its reply the capture belongs to the
+ * receive timer ISR (ServiceReceive), which handles the reply through
+ * HandleTraceResponse() or the missed deadline and clears isAwaiting last,
+ * so every transition out of a step happens in one context.
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
  */
-void AmplifierClass::ParseQueryA() {
-
-	// Shared Memory Alias
-	static auto Shared = SYSTEM_GLOBAL.GetData();
+void AmplifierClass::ServiceTraceCapture( uint8_t amp ) {
 
-	// Extract response
-	String responseA = Shared->Interface.HWSerial.Packets.respondingQueryA;
+	TraceCaptureStruct& Trace = GetTrace( amp );
 
-	if ( isVerboseOutputEnabled ) {
-		Serial.print( "  PacketA: " );
-		Serial.print( Shared->Interface.HWSerial.Packets.outgoingQueryA );
-		Serial.print( " --> " );
-		Serial.print( responseA );
+	// Transaction belongs to the receive path until it clears the flag
+	if ( !CONST_AMP_RX_IN_ISR ) {
+		ServiceTraceDeadline( amp );
 	}
-
-	// Get baud
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryA == ASCII.getBaud ) {
-		Shared->Interface.HWSerial.Connection.baudRateA = responseA.substring( 2, responseA.length() ).toInt();
+	if ( Trace.isAwaiting ) {
+		return;
 	}
 
-	// Get current reading
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryA == ASCII.getCurrentReading ) {
-		int32_t count									   = responseA.substring( 2, responseA.length() ).toInt();
-		Shared->Sensors.MotorCurrents.measuredCurrentAmpsA = float( count / 100.0f );
+	// State was written before the flag was cleared
+	std::atomic_signal_fence( std::memory_order_seq_cst );
 
-		// Update current if being measured
-		if ( Shared->Sensors.MotorCurrents.Limits.isBeingMeasured ) {
+	switch ( Trace.state ) {
 
-			// Record limit A if larger than previous
-			if ( Shared->Sensors.MotorCurrents.measuredCurrentAmpsA > Shared->Sensors.MotorCurrents.Limits.limitA ) {
-				Shared->Sensors.MotorCurrents.Limits.limitA = Shared->Sensors.MotorCurrents.measuredCurrentAmpsA;
+		// Drive is recording, port stays with polling until the buffer is full
+		case EnumsClass::TraceCaptureStateEnum::RECORDING: {
+			if ( micros() - Trace.startUs >= uint32_t( uint64_t( CONST_TRACE_MAX_SAMPLES ) * Trace.samplePeriodNs / 1000 ) ) {
+				Trace.state				= EnumsClass::TraceCaptureStateEnum::STOPPING;
+				GetPollingPaused( amp ) = true;
 			}
+			return;
+		}
+
+		// Steps that exchange packets
+		case EnumsClass::TraceCaptureStateEnum::CONFIGURING:
+		case EnumsClass::TraceCaptureStateEnum::STARTING:
+		case EnumsClass::TraceCaptureStateEnum::STOPPING:
+		case EnumsClass::TraceCaptureStateEnum::FETCHING: {
+			break;
 		}
+
+		default: {
+			return;
+		}
+	}
+
+	// Wait for the sensor query in flight to finish
+	if ( GetPoll( amp ).isQueryInFlight ) {
+		return;
 	}
 
-	// Get encoder reading
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryA == ASCII.getEncoderCount ) {
-		int32_t count									= responseA.substring( 2, responseA.length() ).toInt();
-		Shared->Sensors.MotorEncoders.rawCountA			= count;
-		Shared->Sensors.MotorEncoders.compensatedCountA = Shared->Sensors.MotorEncoders.rawCountA - Shared->Sensors.MotorEncoders.offsetToZeroA;
-		Shared->Sensors.MotorEncoders.measuredAngleDegA = degrees( Shared->Sensors.MotorEncoders.compensatedCountA * 2.0f * M_PI / 4096.0f );
+	SendTraceCommand( amp );
+}
 
-		// Update limit if being measured
-		if ( Shared->Sensors.MotorEncoders.Limits.isBeingMeasured ) {
 
-			// Record limit A if larger than previous
-			if ( Shared->Sensors.MotorEncoders.compensatedCountA > Shared->Sensors.MotorEncoders.Limits.limitCountA ) {
 
-				// Save limit
-				Shared->Sensors.MotorEncoders.Limits.limitCountA  = Shared->Sensors.MotorEncoders.compensatedCountA;
-				Shared->Sensors.MotorEncoders.Limits.limitPhiDegA = degrees( Shared->Sensors.MotorEncoders.compensatedCountA * 2.0f * M_PI / 4096.0f );
+/**
+ * @brief Send the trace packet for the current step
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
+ */
+void AmplifierClass::SendTraceCommand( uint8_t amp ) {
+
+	TraceCaptureStruct& Trace = GetTrace( amp );
+	uint16_t			words[3];
+	uint8_t				wordCount = 1;
+
+	switch ( Trace.state ) {
+
+		case EnumsClass::TraceCaptureStateEnum::CONFIGURING: {
+			if ( Trace.configureStep == 0 ) {
+				words[0] = CONST_COPLEY_TRACE_GET_REF_PERIOD;
+			} else if ( Trace.configureStep == 1 ) {
+				words[0]  = CONST_COPLEY_TRACE_SET_CHANNELS;
+				words[1]  = CONST_COPLEY_TRACE_VAR_CURRENT;
+				words[2]  = CONST_COPLEY_TRACE_VAR_POSITION;
+				wordCount = 3;
+			} else {
+				words[0]  = CONST_COPLEY_TRACE_SET_PERIOD;
+				words[1]  = Trace.periodDivisor;
+				wordCount = 2;
 			}
+			break;
 		}
-	}
-
-	// Get name
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryA == ASCII.getName ) {
-		Shared->Interface.HWSerial.Connection.ampNameA = responseA.substring( 2, responseA.length() );
-	}
 
-	// Set 115237 baud rate
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryA == ASCII.setBaud115237 ) {
-		// Nothing to do
-		Shared->Interface.HWSerial.isConnected = true;
-		Shared->Interface.HWSerial.Connection.baudRateA = 115237;
-	}
+		case EnumsClass::TraceCaptureStateEnum::STARTING: {
+			words[0] = CONST_COPLEY_TRACE_START;
+			break;
+		}
 
-	// Set current-control mode
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryA == ASCII.setCurrentMode ) {
+		case EnumsClass::TraceCaptureStateEnum::STOPPING: {
+			words[0] = CONST_COPLEY_TRACE_STOP;
+			break;
+		}
 
-		// Make sure amplifier acknowledged mode change
-		if ( responseA == "ok" ) {
-			Shared->Drive.Flags.isCurrentControlled = true;
-		} else {
-			Shared->Drive.Flags.isCurrentControlled = false;
-			Serial.println( F( "Amplifier A current command change failed!" ) );
+		default: {
+			words[0] = CONST_COPLEY_TRACE_GET_DATA;
+			break;
 		}
 	}
 
-	// Set amp initial state (reset)
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryA == ASCII.setReset ) {
-		Serial.println( "Resetting" );
+	uint8_t	 packet[CONST_COPLEY_BINARY_HEADER_SIZE + 2 * 3];
+	uint16_t length = BuildCopleyBinaryPacket( packet, CONST_COPLEY_BINARY_OP_TRACE, words, wordCount );
+
+	// First sample is taken as the drive acts on the start packet
+	if ( Trace.state == EnumsClass::TraceCaptureStateEnum::STARTING ) {
+		Trace.startUs = micros();
 	}
 
-	// Clear packet info
-	Shared->Interface.HWSerial.Packets.outgoingQueryA	= ASCII.setIdle;
-	Shared->Interface.HWSerial.Packets.respondingQueryA = "";
+	// Route the reply to the trace frame, handing the capture to the receive path
+	GetRx( amp ).Clear();
+	Trace.frameCount = 0;
+	Trace.deadlineUs = micros() + CONST_TRACE_STEP_TIMEOUT_US;
+	std::atomic_signal_fence( std::memory_order_seq_cst );
+	Trace.isAwaiting = true;
+	GetPort( amp ).write( packet, length );
 }
 
 
 
 /**
- * @brief Parse packet from amp B
+ * @brief Fail the trace step whose reply is overdue
+ * 
+ * Runs in the context that drains the port (the receive ISR, or loop() when
+ * responses are parsed in serialEvent), the same one that handles replies.
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
  */
-void AmplifierClass::ParseQueryB() {
-
-	// Shared Memory Alias
-	static auto Shared = SYSTEM_GLOBAL.GetData();
+void AmplifierClass::ServiceTraceDeadline( uint8_t amp ) {
 
-	// Extract response
-	String responseB = Shared->Interface.HWSerial.Packets.respondingQueryB;
+	TraceCaptureStruct& Trace = GetTrace( amp );
 
-	if ( isVerboseOutputEnabled ) {
-		Serial.print( "  PacketB: " );
-		Serial.print( Shared->Interface.HWSerial.Packets.outgoingQueryB );
-		Serial.print( " --> " );
-		Serial.print( responseB );
+	if ( !Trace.isAwaiting || int32_t( micros() - Trace.deadlineUs ) < 0 ) {
+		return;
 	}
 
-	// Get baud
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryB == ASCII.getBaud ) {
-		Shared->Interface.HWSerial.Connection.baudRateB = responseB.substring( 2, responseB.length() ).toInt();
-	}
+	EndTraceTransaction( amp, EnumsClass::TraceCaptureStateEnum::FAILED );
 
-	// Get current reading
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryB == ASCII.getCurrentReading ) {
-		int32_t count									   = responseB.substring( 2, responseB.length() ).toInt();
-		Shared->Sensors.MotorCurrents.measuredCurrentAmpsB = float( count / 100.0f );
+	// Hand the capture back to loop() once its state is final
+	std::atomic_signal_fence( std::memory_order_seq_cst );
+	Trace.isAwaiting = false;
+}
 
-		// Update current if being measured
-		if ( Shared->Sensors.MotorCurrents.Limits.isBeingMeasured ) {
 
-			// Record limit A if larger than previous
-			if ( Shared->Sensors.MotorCurrents.measuredCurrentAmpsB > Shared->Sensors.MotorCurrents.Limits.limitB ) {
-				Shared->Sensors.MotorCurrents.Limits.limitB = Shared->Sensors.MotorCurrents.measuredCurrentAmpsB;
-			}
-		}
+
+/**
+ * @brief Act on a complete trace reply
+ * 
+ * Runs in the receive path. The caller clears isAwaiting afterwards, which
+ * hands the capture back to loop().
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
+ */
+void AmplifierClass::HandleTraceResponse( uint8_t amp ) {
+
+	TraceCaptureStruct& Trace = GetTrace( amp );
+	uint8_t				words = Trace.frame[2];
+
+	// Drive rejected the command
+	if ( Trace.frame[3] != 0 ) {
+		EndTraceTransaction( amp, EnumsClass::TraceCaptureStateEnum::FAILED );
+		return;
 	}
 
-	// Get encoder reading
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryB == ASCII.getEncoderCount ) {
-		int32_t count									= responseB.substring( 2, responseB.length() ).toInt();
-		Shared->Sensors.MotorEncoders.rawCountB			= count;
-		Shared->Sensors.MotorEncoders.compensatedCountB = Shared->Sensors.MotorEncoders.rawCountB - Shared->Sensors.MotorEncoders.offsetToZeroB;
-		Shared->Sensors.MotorEncoders.measuredAngleDegB = degrees( Shared->Sensors.MotorEncoders.compensatedCountB * 2.0f * M_PI / 4096.0f );
+	switch ( Trace.state ) {
+
+		case EnumsClass::TraceCaptureStateEnum::CONFIGURING: {
+
+			// Pick the divisor closest to the requested sample period
+			if ( Trace.configureStep == 0 ) {
 
-		// Update limit if being measured
-		if ( Shared->Sensors.MotorEncoders.Limits.isBeingMeasured ) {
+				// No period in the reply, the frame still holds an earlier packet's words
+				if ( words == 0 ) {
+					EndTraceTransaction( amp, EnumsClass::TraceCaptureStateEnum::FAILED );
+					return;
+				}
 
-			// Record limit A if larger than previous
-			if ( Shared->Sensors.MotorEncoders.compensatedCountB > Shared->Sensors.MotorEncoders.Limits.limitCountB ) {
+				uint32_t refPeriodNs = ( words >= 2 ) ? ( uint32_t( Trace.Word( 0 ) ) << 16 ) | Trace.Word( 1 ) : Trace.Word( 0 );
+				uint32_t divisor	 = ( CONST_TRACE_SAMPLE_PERIOD_US * 1000 + refPeriodNs / 2 ) / ( refPeriodNs ? refPeriodNs : 1 );
+				Trace.refPeriodNs	 = refPeriodNs;
+				Trace.periodDivisor	 = divisor ? divisor : 1;
+				Trace.samplePeriodNs = refPeriodNs * Trace.periodDivisor;
+			}
 
-				// Save limit
-				Shared->Sensors.MotorEncoders.Limits.limitCountB  = Shared->Sensors.MotorEncoders.compensatedCountB;
-				Shared->Sensors.MotorEncoders.Limits.limitPhiDegB = degrees( Shared->Sensors.MotorEncoders.compensatedCountB * 2.0f * M_PI / 4096.0f );
+			if ( ++Trace.configureStep >= CONST_TRACE_CONFIGURE_STEPS ) {
+				EndTraceTransaction( amp, EnumsClass::TraceCaptureStateEnum::ARMED );
 			}
+			break;
 		}
-	}
 
-	// Get name
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryB == ASCII.getName ) {
-		Shared->Interface.HWSerial.Connection.ampNameB = responseB.substring( 2, responseB.length() );
-	}
+		case EnumsClass::TraceCaptureStateEnum::STARTING: {
+			EndTraceTransaction( amp, EnumsClass::TraceCaptureStateEnum::RECORDING );
+			break;
+		}
 
-	// Set 115237 baud rate
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryB == ASCII.setBaud115237 ) {
-		Shared->Interface.HWSerial.isConnected = true;
-		Shared->Interface.HWSerial.Connection.baudRateB = 115237;
-	}
+		case EnumsClass::TraceCaptureStateEnum::STOPPING: {
+			Trace.state = EnumsClass::TraceCaptureStateEnum::FETCHING;
+			break;
+		}
 
-	// Set current-control mode
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryB == ASCII.setCurrentMode ) {
+		case EnumsClass::TraceCaptureStateEnum::FETCHING: {
 
-		// Make sure amplifier acknowledged mode change
-		if ( responseB == "ok" ) {
-			Shared->Drive.Flags.isCurrentControlled = true;
-		} else {
-			Shared->Drive.Flags.isCurrentControlled = false;
-			Serial.println( F( "Amplifier B current command change failed!" ) );
+			// Each sample is two 32-bit channels (four words)
+			for ( uint8_t i = 0; i + 3 < words && Trace.sampleCount < CONST_TRACE_MAX_SAMPLES; i += 4 ) {
+				Trace.current[Trace.sampleCount]  = int32_t( ( uint32_t( Trace.Word( i ) ) << 16 ) | Trace.Word( i + 1 ) );
+				Trace.position[Trace.sampleCount] = int32_t( ( uint32_t( Trace.Word( i + 2 ) ) << 16 ) | Trace.Word( i + 3 ) );
+				Trace.sampleCount++;
+			}
+
+			// Empty reply means the drive buffer is drained
+			if ( words == 0 || Trace.sampleCount >= CONST_TRACE_MAX_SAMPLES ) {
+				EndTraceTransaction( amp, EnumsClass::TraceCaptureStateEnum::COMPLETE );
+			}
+			break;
 		}
-	}
 
-	// Set amp initial state (reset)
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryB == ASCII.setReset ) {
-		Serial.println( "Resetting" );
+		default: {
+			break;
+		}
 	}
-
-	// Clear packet info
-	Shared->Interface.HWSerial.Packets.outgoingQueryB	= ASCII.setIdle;
-	Shared->Interface.HWSerial.Packets.respondingQueryB = "";
 }
 
 
 
 /**
- * @brief Parse packet from amp C
+ * @brief Hand the port back to sensor polling and queue the log once every capture is done
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
+ * @param nextState State to leave the capture in
  */
-void AmplifierClass::ParseQueryC() {
+void AmplifierClass::EndTraceTransaction( uint8_t amp, EnumsClass::TraceCaptureStateEnum nextState ) {
 
 	// Shared Memory Alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-	// Extract response
-	String responseC = Shared->Interface.HWSerial.Packets.respondingQueryC;
+	GetTrace( amp ).state	= nextState;
+	GetPollingPaused( amp ) = false;
 
-	if ( isVerboseOutputEnabled ) {
-		Serial.print( "  PacketC: " );
-		Serial.print( Shared->Interface.HWSerial.Packets.outgoingQueryC );
-		Serial.print( " --> " );
-		Serial.print( responseC );
+	if ( nextState != EnumsClass::TraceCaptureStateEnum::COMPLETE && nextState != EnumsClass::TraceCaptureStateEnum::FAILED ) {
+		return;
 	}
 
-	// Get baud
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryC == ASCII.getBaud ) {
-		Shared->Interface.HWSerial.Connection.baudRateC = responseC.substring( 2, responseC.length() ).toInt();
+	// Wait for the other amplifiers
+	bool isAnyComplete = false;
+	for ( uint8_t other = 0; other < CONST_AMP_COUNT; other++ ) {
+		EnumsClass::TraceCaptureStateEnum state = GetTrace( other ).state;
+		if ( state == EnumsClass::TraceCaptureStateEnum::CONFIGURING || state == EnumsClass::TraceCaptureStateEnum::ARMED || state == EnumsClass::TraceCaptureStateEnum::STARTING || state == EnumsClass::TraceCaptureStateEnum::RECORDING || state == EnumsClass::TraceCaptureStateEnum::STOPPING || state == EnumsClass::TraceCaptureStateEnum::FETCHING ) {
+			return;
+		}
+		isAnyComplete |= ( state == EnumsClass::TraceCaptureStateEnum::COMPLETE );
+	}
+
+	if ( isAnyComplete ) {
+		Shared->ActionQueue.ReceiveEvents.Push( EnumsClass::AmplifierEventEnum::LOG_TRACE_CAPTURE );
+	}
+}
+
+
+
+/**
+ * @brief Write uploaded trace samples to the session log
+ * 
+ * One row per sample with its host time and the time since the trigger, so the
+ * rows line up with the task timestamps printed around them.
+ */
+void AmplifierClass::LogTraceCapture() {
+
+	const char ampNames[CONST_AMP_COUNT] = { 'A', 'B', 'C' };
+
+	Serial.println( F( "TRACE,Amp,Time[us],SincePrompt[ms],Current[A],Position[counts]" ) );
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+
+		TraceCaptureStruct& Trace = GetTrace( amp );
+
+		if ( Trace.state == EnumsClass::TraceCaptureStateEnum::FAILED ) {
+			Serial.print( F( "AMPLIFIER:     Trace capture " ) );
+			Serial.print( ampNames[amp] );
+			Serial.println( F( " failed." ) );
+		}
+
+		if ( Trace.state != EnumsClass::TraceCaptureStateEnum::COMPLETE ) {
+			continue;
+		}
+
+		for ( uint16_t k = 0; k < Trace.sampleCount; k++ ) {
+			uint32_t sampleUs = Trace.startUs + uint32_t( uint64_t( k ) * Trace.samplePeriodNs / 1000 );
+
+			Serial.print( F( "TRACE," ) );
+			Serial.print( ampNames[amp] );
+			Serial.print( F( "," ) );
+			Serial.print( sampleUs );
+			Serial.print( F( "," ) );
+			Serial.print( int32_t( sampleUs - traceTriggerUs ) / 1000.0f, 3 );
+			Serial.print( F( "," ) );
+			Serial.print( Trace.current[k] / 100.0f, 2 );
+			Serial.print( F( "," ) );
+			Serial.println( Trace.position[k] );
+		}
+
+		Trace.state = EnumsClass::TraceCaptureStateEnum::IDLE;
+	}
+}
+
+
+
+// ================================================================================================
+// === AMPLIFIER INDEX ACCESSORS ==================================================================
+// ================================================================================================
+
+/**
+ * @brief Initialization state by amplifier index
+ */
+AmpInitStruct& AmplifierClass::GetInit( uint8_t amp ) {
+	return ( amp == 0 ) ? InitA : ( amp == 1 ) ? InitB : InitC;
+}
+
+/**
+ * @brief Pipeline state by amplifier index
+ */
+SensorPollStruct& AmplifierClass::GetPoll( uint8_t amp ) {
+	return ( amp == 0 ) ? PollA : ( amp == 1 ) ? PollB : PollC;
+}
+
+/**
+ * @brief Receive ring by amplifier index
+ */
+AmpRxRingStruct& AmplifierClass::GetRx( uint8_t amp ) {
+	return ( amp == 0 ) ? RxA : ( amp == 1 ) ? RxB : RxC;
+}
+
+/**
+ * @brief HWSerial port by amplifier index
+ */
+HardwareSerial& AmplifierClass::GetPort( uint8_t amp ) {
+	return ( amp == 0 ) ? HWSerialA : ( amp == 1 ) ? HWSerialB : HWSerialC;
+}
+
+/**
+ * @brief Enable pin by amplifier index
+ */
+uint8_t AmplifierClass::GetEnablePin( uint8_t amp ) {
+	return ( amp == 0 ) ? PIN_AMPLIFIER_ENABLE_A : ( amp == 1 ) ? PIN_AMPLIFIER_ENABLE_B : PIN_AMPLIFIER_ENABLE_C;
+}
+
+/**
+ * @brief Link statistics by amplifier index
+ */
+AmpLinkStatsStruct& AmplifierClass::GetLink( uint8_t amp ) {
+	return ( amp == 0 ) ? LinkA : ( amp == 1 ) ? LinkB : LinkC;
+}
+
+/**
+ * @brief Trace capture by amplifier index
+ */
+TraceCaptureStruct& AmplifierClass::GetTrace( uint8_t amp ) {
+	return ( amp == 0 ) ? TraceA : ( amp == 1 ) ? TraceB : TraceC;
+}
+
+/**
+ * @brief Closed-loop controller by amplifier index
+ */
+MotorControllerStruct& AmplifierClass::GetControl( uint8_t amp ) {
+	return ( amp == 0 ) ? ControlA : ( amp == 1 ) ? ControlB : ControlC;
+}
+
+/**
+ * @brief Encoder limit guard by amplifier index
+ */
+EncoderLimitGuardStruct& AmplifierClass::GetGuard( uint8_t amp ) {
+	return ( amp == 0 ) ? GuardA : ( amp == 1 ) ? GuardB : GuardC;
+}
+
+/**
+ * @brief Slew limiter transition stats by amplifier index
+ */
+SlewTransitionStruct& AmplifierClass::GetTransition( uint8_t amp ) {
+	return ( amp == 0 ) ? TransitionA : ( amp == 1 ) ? TransitionB : TransitionC;
+}
+
+/**
+ * @brief Trace ownership flag by amplifier index
+ */
+volatile bool& AmplifierClass::GetPollingPaused( uint8_t amp ) {
+	return ( amp == 0 ) ? isPollingPausedA : ( amp == 1 ) ? isPollingPausedB : isPollingPausedC;
+}
+
+/**
+ * @brief Send a query by amplifier index
+ */
+void AmplifierClass::SendQuery( uint8_t amp, EnumsClass::AmplifierQueryEnum newQuery ) {
+
+	if ( amp == 0 ) {
+		SendQueryA( newQuery );
+	} else if ( amp == 1 ) {
+		SendQueryB( newQuery );
+	} else {
+		SendQueryC( newQuery );
+	}
+}
+
+
+
+// /**
+//  * =============================================================================================
+//  * =============================================================================================
+//  *
+//  * H   H  W     W     SSSS   EEEEEE  RRRRR    IIIIII   AAAAA   LL
+//  * H   H  W     W    SS      EE      RR  RR     II    AA   AA  LL
+//  * H   H  W     W    SS      EE      RR  RR     II    AA   AA  LL
+//  * HHHHH  W  W  W     SSSS   EEEE    RRRRR      II    AAAAAAA  LL
+//  * H   H  W W W W        SS  EE      RR  RR     II    AA   AA  LL
+//  * H   H  WW WW W        SS  EE      RR  RR     II    AA   AA  LL
+//  * H   H   W   W      SSSS   EEEEEE  RR   RR  IIIIII  AA   AA  LLLLL
+//  *
+//  * =============================================================================================
+//  * =============================================================================================
+//  *
+//  * The Teensy communicates with the amplifiers using hardware serial ports,
+//  * with HWSerialA = Serial5, HWSerialB = Serial5, and HWSerialC = Serial3.
+//  * To properly do these communications, we use a queue of queries,
+//  * where each query is a pre-defined String variable. The process is as follows:
+//  *
+//  * 1: Use HWSerial_EnqueueQuery to add the query to the queryQueue
+//  * 2: In our Update loop, make sure we're not awaiting a response and that
+//  *    the queue is empty, then process the next item in the queue using
+//  *    HWSerial_ProcessQuery
+//  * 3: If bytes are availalbe on the HWSerial port, read the response using
+//  *    HWSerial_ReadResponse
+//  * 4: Parse the response using HWSerial_ParseResponse
+//  */
+
+
+
+// ================================================================================================
+// === SERIAL EVENT HANDLER =======================================================================
+// ================================================================================================
+
+/**
+ * @brief Serial event handler for HWSerial5 (ampA)
+ */
+void serialEvent5() {
+
+	// Connect hook to class function (the receive timer drains the port instead when CONST_AMP_RX_IN_ISR)
+	if ( !CONST_AMP_RX_IN_ISR && AmplifierClass::instance ) {
+		AmplifierClass::instance->OnHWSerialAEvent();
+	}
+}
+
+/**
+ * @brief Serial event handler for HWSerial4 (ampB)
+ */
+void serialEvent4() {
+
+	// Connect hook to class function (the receive timer drains the port instead when CONST_AMP_RX_IN_ISR)
+	if ( !CONST_AMP_RX_IN_ISR && AmplifierClass::instance ) {
+		AmplifierClass::instance->OnHWSerialBEvent();
+	}
+}
+
+/**
+ * @brief Serial event handler for HWSerial3 (ampC)
+ */
+void serialEvent3() {
+
+	// Connect hook to class function (the receive timer drains the port instead when CONST_AMP_RX_IN_ISR)
+	if ( !CONST_AMP_RX_IN_ISR && AmplifierClass::instance ) {
+		AmplifierClass::instance->OnHWSerialCEvent();
+	}
+}
+
+
+
+// ================================================================================================
+// === SERIAL EVENT CALLBACK ======================================================================
+// ================================================================================================
+
+/**
+ * @brief Drain and parse all three UARTs
+ * 
+ * Called from the receive IntervalTimer so responses are parsed within one
+ * timer period of arriving, however long loop() takes. The timer shares the
+ * default priority with the master tick, so neither preempts the other while
+ * touching the pipeline.
+ */
+void AmplifierClass::ServiceReceive() {
+
+	if ( !CONST_AMP_RX_IN_ISR ) {
+		return;
+	}
+
+	OnHWSerialAEvent();
+	OnHWSerialBEvent();
+	OnHWSerialCEvent();
+
+	// Trace steps end here, never in loop()
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		ServiceTraceDeadline( amp );
+	}
+}
+
+/**
+ * @brief Callback for HWSerialA (port 5)
+ */
+void AmplifierClass::OnHWSerialAEvent() {
+
+	// Read data while buffer is populated
+	while ( HWSerialA.available() > 0 ) {
+
+		// Read each byte
+		char incomingChar = ( char )HWSerialA.read();
+		LinkA.bytesReceived++;
+
+		// Trace replies bypass the response ring
+		if ( TraceA.isAwaiting ) {
+			if ( TraceA.ReceiveByte( uint8_t( incomingChar ) ) ) {
+				HandleTraceResponse( 0 );
+				std::atomic_signal_fence( std::memory_order_seq_cst );
+				TraceA.isAwaiting = false;
+			}
+			continue;
+		}
+
+		// Parse once the response is complete
+		if ( ReceiveByte( RxA, incomingChar ) ) {
+			LinkA.RecordResponse( micros() );
+			ParseQueryA();
+		}
+	}
+}
+
+/**
+ * @brief Callback for HWSerialB (port 4)
+ */
+void AmplifierClass::OnHWSerialBEvent() {
+
+	// Read data while buffer is populated
+	while ( HWSerialB.available() > 0 ) {
+
+		// Read each byte
+		char incomingChar = ( char )HWSerialB.read();
+		LinkB.bytesReceived++;
+
+		// Trace replies bypass the response ring
+		if ( TraceB.isAwaiting ) {
+			if ( TraceB.ReceiveByte( uint8_t( incomingChar ) ) ) {
+				HandleTraceResponse( 1 );
+				std::atomic_signal_fence( std::memory_order_seq_cst );
+				TraceB.isAwaiting = false;
+			}
+			continue;
+		}
+
+		// Parse once the response is complete
+		if ( ReceiveByte( RxB, incomingChar ) ) {
+			LinkB.RecordResponse( micros() );
+			ParseQueryB();
+		}
+	}
+}
+
+/**
+ * @brief Callback for HWSerialC (port 3)
+ */
+void AmplifierClass::OnHWSerialCEvent() {
+
+	// Read data while buffer is populated
+	while ( HWSerialC.available() > 0 ) {
+
+		// Read each byte
+		char incomingChar = ( char )HWSerialC.read();
+		LinkC.bytesReceived++;
+
+		// Trace replies bypass the response ring
+		if ( TraceC.isAwaiting ) {
+			if ( TraceC.ReceiveByte( uint8_t( incomingChar ) ) ) {
+				HandleTraceResponse( 2 );
+				std::atomic_signal_fence( std::memory_order_seq_cst );
+				TraceC.isAwaiting = false;
+			}
+			continue;
+		}
+
+		// Parse once the response is complete
+		if ( ReceiveByte( RxC, incomingChar ) ) {
+			LinkC.RecordResponse( micros() );
+			ParseQueryC();
+		}
+	}
+}
+
+
+
+// ================================================================================================
+// === SEND QUERY =================================================================================
+// ================================================================================================
+
+/**
+ * @brief Sends a query to amp A
+ */
+void AmplifierClass::SendQueryA( EnumsClass::AmplifierQueryEnum newQuery ) {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update outgoing query
+	Shared->Interface.HWSerial.Packets.outgoingQueryA = newQuery;
+	LinkA.RecordSend( micros() );
+
+	// Send packet (binary when available, otherwise ASCII)
+	if ( newQuery == EnumsClass::AmplifierQueryEnum::GET_REGISTER ) {
+		const PollEntryStruct& entry = PollTable.entry[PollA.entryInFlight];
+		if ( activeProtocol == EnumsClass::AmplifierProtocolEnum::BINARY ) {
+			HWSerialA.write( entry.binary, CONST_COPLEY_BINARY_GET_SIZE );
+		} else {
+			HWSerialA.print( entry.ascii );
+		}
+	} else if ( activeProtocol == EnumsClass::AmplifierProtocolEnum::BINARY && BINARY.length[uint8_t( newQuery )] > 0 ) {
+		HWSerialA.write( BINARY.command[uint8_t( newQuery )], BINARY.length[uint8_t( newQuery )] );
+	} else if ( newQuery == EnumsClass::AmplifierQueryEnum::SET_BAUD ) {
+		HWSerialA.print( ASCII.command[uint8_t( newQuery )] );
+		HWSerialA.print( CONST_AMP_BAUD_CANDIDATES[InitA.baudIndex] );
+		HWSerialA.print( '\r' );
+	} else {
+		HWSerialA.print( ASCII.command[uint8_t( newQuery )] );
+	}
+}
+
+/**
+ * @brief Sends a query to amp B
+ */
+void AmplifierClass::SendQueryB( EnumsClass::AmplifierQueryEnum newQuery ) {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update outgoing query
+	Shared->Interface.HWSerial.Packets.outgoingQueryB = newQuery;
+	LinkB.RecordSend( micros() );
+
+	// Send packet (binary when available, otherwise ASCII)
+	if ( newQuery == EnumsClass::AmplifierQueryEnum::GET_REGISTER ) {
+		const PollEntryStruct& entry = PollTable.entry[PollB.entryInFlight];
+		if ( activeProtocol == EnumsClass::AmplifierProtocolEnum::BINARY ) {
+			HWSerialB.write( entry.binary, CONST_COPLEY_BINARY_GET_SIZE );
+		} else {
+			HWSerialB.print( entry.ascii );
+		}
+	} else if ( activeProtocol == EnumsClass::AmplifierProtocolEnum::BINARY && BINARY.length[uint8_t( newQuery )] > 0 ) {
+		HWSerialB.write( BINARY.command[uint8_t( newQuery )], BINARY.length[uint8_t( newQuery )] );
+	} else if ( newQuery == EnumsClass::AmplifierQueryEnum::SET_BAUD ) {
+		HWSerialB.print( ASCII.command[uint8_t( newQuery )] );
+		HWSerialB.print( CONST_AMP_BAUD_CANDIDATES[InitB.baudIndex] );
+		HWSerialB.print( '\r' );
+	} else {
+		HWSerialB.print( ASCII.command[uint8_t( newQuery )] );
+	}
+}
+
+/**
+ * @brief Sends a query to amp C
+ */
+void AmplifierClass::SendQueryC( EnumsClass::AmplifierQueryEnum newQuery ) {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update outgoing query
+	Shared->Interface.HWSerial.Packets.outgoingQueryC = newQuery;
+	LinkC.RecordSend( micros() );
+
+	// Send packet (binary when available, otherwise ASCII)
+	if ( newQuery == EnumsClass::AmplifierQueryEnum::GET_REGISTER ) {
+		const PollEntryStruct& entry = PollTable.entry[PollC.entryInFlight];
+		if ( activeProtocol == EnumsClass::AmplifierProtocolEnum::BINARY ) {
+			HWSerialC.write( entry.binary, CONST_COPLEY_BINARY_GET_SIZE );
+		} else {
+			HWSerialC.print( entry.ascii );
+		}
+	} else if ( activeProtocol == EnumsClass::AmplifierProtocolEnum::BINARY && BINARY.length[uint8_t( newQuery )] > 0 ) {
+		HWSerialC.write( BINARY.command[uint8_t( newQuery )], BINARY.length[uint8_t( newQuery )] );
+	} else if ( newQuery == EnumsClass::AmplifierQueryEnum::SET_BAUD ) {
+		HWSerialC.print( ASCII.command[uint8_t( newQuery )] );
+		HWSerialC.print( CONST_AMP_BAUD_CANDIDATES[InitC.baudIndex] );
+		HWSerialC.print( '\r' );
+	} else {
+		HWSerialC.print( ASCII.command[uint8_t( newQuery )] );
+	}
+}
+
+
+
+// ================================================================================================
+// === PARSE QUERY ================================================================================
+// ================================================================================================
+
+/**
+ * @brief Parse packet from amp A
+ */
+void AmplifierClass::ParseQueryA() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Start parse timer
+	uint32_t parseStartCycles = ARM_DWT_CYCCNT;
+
+	// Query this response belongs to
+	EnumsClass::AmplifierQueryEnum query = Shared->Interface.HWSerial.Packets.outgoingQueryA;
+
+	// Amplifier name is text rather than an integer (only read during initialization)
+	if ( query == EnumsClass::AmplifierQueryEnum::GET_NAME ) {
+		CopyAsciiResponseText( RxA, InitA.name );
+	}
+
+	// Extract response
+	AmpResponseStruct responseA = ParseResponse( RxA );
+	bool			  isValueA  = ( responseA.type == EnumsClass::AmplifierResponseEnum::VALUE );
+	if ( responseA.type == EnumsClass::AmplifierResponseEnum::MALFORMED ) LinkA.malformed++;
+
+	// Queue for the verbose dump (printed from Loop())
+	if ( isVerboseOutputEnabled ) {
+		PacketLog.Push( AmpPacketLogStruct{ 0, query, responseA } );
+	}
+
+	switch ( query ) {
+
+		// Get baud
+		case EnumsClass::AmplifierQueryEnum::GET_BAUD: {
+			if ( isValueA ) {
+				Shared->Interface.HWSerial.Connection.baudRateA = responseA.value;
+			}
+			break;
+		}
+
+		// Poll table register
+		case EnumsClass::AmplifierQueryEnum::GET_REGISTER: {
+			if ( isValueA ) {
+				const PollEntryStruct& entry = PollTable.entry[PollA.entryInFlight];
+
+				// Store through the table
+				if ( entry.raw ) *entry.raw = responseA.value;
+				if ( entry.scaled ) *entry.scaled = responseA.value * entry.scale;
+
+				// Update current if being measured
+				if ( entry.parameter == CONST_COPLEY_REG_CURRENT && Shared->Sensors.MotorCurrents.Limits.isBeingMeasured ) {
+
+					// Record limit A if larger than previous
+					if ( Shared->Sensors.MotorCurrents.measuredCurrentAmpsA > Shared->Sensors.MotorCurrents.Limits.limitA ) {
+						Shared->Sensors.MotorCurrents.Limits.limitA = Shared->Sensors.MotorCurrents.measuredCurrentAmpsA;
+					}
+				}
+
+				// Apply encoder zero offset
+				if ( entry.parameter == CONST_COPLEY_REG_POSITION ) {
+					Shared->Sensors.MotorEncoders.compensatedCountA = Shared->Sensors.MotorEncoders.rawCountA - Shared->Sensors.MotorEncoders.offsetToZeroA;
+					Shared->Sensors.MotorEncoders.measuredAngleDegA = degrees( Shared->Sensors.MotorEncoders.compensatedCountA * 2.0f * M_PI / 4096.0f );
+
+					// Update limit if being measured
+					if ( Shared->Sensors.MotorEncoders.Limits.isBeingMeasured ) {
+
+						// Record limit A if larger than previous
+						if ( Shared->Sensors.MotorEncoders.compensatedCountA > Shared->Sensors.MotorEncoders.Limits.limitCountA ) {
+
+							// Save limit
+							Shared->Sensors.MotorEncoders.Limits.limitCountA  = Shared->Sensors.MotorEncoders.compensatedCountA;
+							Shared->Sensors.MotorEncoders.Limits.limitPhiDegA = degrees( Shared->Sensors.MotorEncoders.compensatedCountA * 2.0f * M_PI / 4096.0f );
+						}
+					}
+				}
+
+				// Publish current / position to the lock-free handoff
+				if ( entry.parameter == CONST_COPLEY_REG_CURRENT || entry.parameter == CONST_COPLEY_REG_POSITION ) {
+					SampleA.BeginPublish();
+					if ( entry.parameter == CONST_COPLEY_REG_CURRENT ) {
+						SampleA.frame.currentAmps = Shared->Sensors.MotorCurrents.measuredCurrentAmpsA;
+						SampleA.frame.currentUs	 = LinkA.sendUs;
+					} else {
+						SampleA.frame.encoderCount = Shared->Sensors.MotorEncoders.compensatedCountA;
+						SampleA.frame.positionUs	  = LinkA.sendUs;
+					}
+					SampleA.frame.requestUs = LinkA.sendUs;
+					SampleA.frame.sequence++;
+					SampleA.EndPublish();
+				}
+			}
+			break;
+		}
+
+		// Set current-control mode
+		case EnumsClass::AmplifierQueryEnum::SET_CURRENT_MODE: {
+
+			// Make sure amplifier acknowledged mode change
+			if ( responseA.type == EnumsClass::AmplifierResponseEnum::OK ) {
+				Shared->Drive.Flags.isCurrentControlled = true;
+			} else {
+				Shared->Drive.Flags.isCurrentControlled = false;
+				Shared->ActionQueue.ReceiveEvents.Push( EnumsClass::AmplifierEventEnum::CURRENT_MODE_REJECTED_A );
+			}
+			break;
+		}
+
+		default: {
+			break;
+		}
+	}
+
+	// Check if this response completes a sensor query
+	bool isSensorResponse = ( query == EnumsClass::AmplifierQueryEnum::GET_REGISTER );
+
+	// Clear packet info
+	Shared->Interface.HWSerial.Packets.outgoingQueryA = EnumsClass::AmplifierQueryEnum::IDLE;
+
+	// Record parse cost
+	PollA.parseCyclesLast = ARM_DWT_CYCCNT - parseStartCycles;
+	PollA.parseCyclesTotal += PollA.parseCyclesLast;
+	if ( PollA.parseCyclesLast > PollA.parseCyclesMax ) {
+		PollA.parseCyclesMax = PollA.parseCyclesLast;
+	}
+
+	// Known-answer query after a fault decides whether polling resumes
+	if ( query == EnumsClass::AmplifierQueryEnum::RESYNC ) {
+		CompleteResync( 0, responseA );
+		return;
+	}
+
+	// Garbled sensor response means framing was lost, realign before trusting the next one
+	if ( isSensorResponse && responseA.type == EnumsClass::AmplifierResponseEnum::MALFORMED && isSensorPollingEnabled ) {
+		Resynchronize( 0 );
+		return;
+	}
+
+	// Hand initialization responses to the sequencer
+	if ( !isSensorResponse ) {
+		InitA.response = responseA;
+		std::atomic_signal_fence( std::memory_order_seq_cst );
+		InitA.isResponseReceived = true;
+	}
+
+	// Keep the pipeline full (port stays marked busy so ReadSensors does not also send)
+	if ( isSensorResponse && isSensorPollingEnabled ) {
+		PollA.samplesReceived++;
+		SendNextSensorQueryA();
+	} else {
+		PollA.isQueryInFlight = false;
+	}
+}
+
+
+
+/**
+ * @brief Parse packet from amp B
+ */
+void AmplifierClass::ParseQueryB() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Start parse timer
+	uint32_t parseStartCycles = ARM_DWT_CYCCNT;
+
+	// Query this response belongs to
+	EnumsClass::AmplifierQueryEnum query = Shared->Interface.HWSerial.Packets.outgoingQueryB;
+
+	// Amplifier name is text rather than an integer (only read during initialization)
+	if ( query == EnumsClass::AmplifierQueryEnum::GET_NAME ) {
+		CopyAsciiResponseText( RxB, InitB.name );
+	}
+
+	// Extract response
+	AmpResponseStruct responseB = ParseResponse( RxB );
+	bool			  isValueB  = ( responseB.type == EnumsClass::AmplifierResponseEnum::VALUE );
+	if ( responseB.type == EnumsClass::AmplifierResponseEnum::MALFORMED ) LinkB.malformed++;
+
+	// Queue for the verbose dump (printed from Loop())
+	if ( isVerboseOutputEnabled ) {
+		PacketLog.Push( AmpPacketLogStruct{ 1, query, responseB } );
 	}
 
-	// Get current reading
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryC == ASCII.getCurrentReading ) {
-		int32_t count									   = responseC.substring( 2, responseC.length() ).toInt();
-		Shared->Sensors.MotorCurrents.measuredCurrentAmpsC = float( count / 100.0f );
+	switch ( query ) {
+
+		// Get baud
+		case EnumsClass::AmplifierQueryEnum::GET_BAUD: {
+			if ( isValueB ) {
+				Shared->Interface.HWSerial.Connection.baudRateB = responseB.value;
+			}
+			break;
+		}
+
+		// Poll table register
+		case EnumsClass::AmplifierQueryEnum::GET_REGISTER: {
+			if ( isValueB ) {
+				const PollEntryStruct& entry = PollTable.entry[PollB.entryInFlight];
+
+				// Store through the table
+				if ( entry.raw ) *entry.raw = responseB.value;
+				if ( entry.scaled ) *entry.scaled = responseB.value * entry.scale;
+
+				// Update current if being measured
+				if ( entry.parameter == CONST_COPLEY_REG_CURRENT && Shared->Sensors.MotorCurrents.Limits.isBeingMeasured ) {
+
+					// Record limit B if larger than previous
+					if ( Shared->Sensors.MotorCurrents.measuredCurrentAmpsB > Shared->Sensors.MotorCurrents.Limits.limitB ) {
+						Shared->Sensors.MotorCurrents.Limits.limitB = Shared->Sensors.MotorCurrents.measuredCurrentAmpsB;
+					}
+				}
+
+				// Apply encoder zero offset
+				if ( entry.parameter == CONST_COPLEY_REG_POSITION ) {
+					Shared->Sensors.MotorEncoders.compensatedCountB = Shared->Sensors.MotorEncoders.rawCountB - Shared->Sensors.MotorEncoders.offsetToZeroB;
+					Shared->Sensors.MotorEncoders.measuredAngleDegB = degrees( Shared->Sensors.MotorEncoders.compensatedCountB * 2.0f * M_PI / 4096.0f );
+
+					// Update limit if being measured
+					if ( Shared->Sensors.MotorEncoders.Limits.isBeingMeasured ) {
+
+						// Record limit B if larger than previous
+						if ( Shared->Sensors.MotorEncoders.compensatedCountB > Shared->Sensors.MotorEncoders.Limits.limitCountB ) {
+
+							// Save limit
+							Shared->Sensors.MotorEncoders.Limits.limitCountB  = Shared->Sensors.MotorEncoders.compensatedCountB;
+							Shared->Sensors.MotorEncoders.Limits.limitPhiDegB = degrees( Shared->Sensors.MotorEncoders.compensatedCountB * 2.0f * M_PI / 4096.0f );
+						}
+					}
+				}
+
+				// Publish current / position to the lock-free handoff
+				if ( entry.parameter == CONST_COPLEY_REG_CURRENT || entry.parameter == CONST_COPLEY_REG_POSITION ) {
+					SampleB.BeginPublish();
+					if ( entry.parameter == CONST_COPLEY_REG_CURRENT ) {
+						SampleB.frame.currentAmps = Shared->Sensors.MotorCurrents.measuredCurrentAmpsB;
+						SampleB.frame.currentUs	 = LinkB.sendUs;
+					} else {
+						SampleB.frame.encoderCount = Shared->Sensors.MotorEncoders.compensatedCountB;
+						SampleB.frame.positionUs	  = LinkB.sendUs;
+					}
+					SampleB.frame.requestUs = LinkB.sendUs;
+					SampleB.frame.sequence++;
+					SampleB.EndPublish();
+				}
+			}
+			break;
+		}
 
-		// Update current if being measured
-		if ( Shared->Sensors.MotorCurrents.Limits.isBeingMeasured ) {
+		// Set current-control mode
+		case EnumsClass::AmplifierQueryEnum::SET_CURRENT_MODE: {
 
-			// Record limit A if larger than previous
-			if ( Shared->Sensors.MotorCurrents.measuredCurrentAmpsC > Shared->Sensors.MotorCurrents.Limits.limitC ) {
-				Shared->Sensors.MotorCurrents.Limits.limitC = Shared->Sensors.MotorCurrents.measuredCurrentAmpsC;
+			// Make sure amplifier acknowledged mode change
+			if ( responseB.type == EnumsClass::AmplifierResponseEnum::OK ) {
+				Shared->Drive.Flags.isCurrentControlled = true;
+			} else {
+				Shared->Drive.Flags.isCurrentControlled = false;
+				Shared->ActionQueue.ReceiveEvents.Push( EnumsClass::AmplifierEventEnum::CURRENT_MODE_REJECTED_B );
 			}
+			break;
+		}
+
+		default: {
+			break;
 		}
 	}
 
-	// Get encoder reading
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryC == ASCII.getEncoderCount ) {
-		int32_t count									= responseC.substring( 2, responseC.length() ).toInt();
-		Shared->Sensors.MotorEncoders.rawCountC			= count;
-		Shared->Sensors.MotorEncoders.compensatedCountC = Shared->Sensors.MotorEncoders.rawCountC - Shared->Sensors.MotorEncoders.offsetToZeroC;
-		Shared->Sensors.MotorEncoders.measuredAngleDegC = degrees( Shared->Sensors.MotorEncoders.compensatedCountC * 2.0f * M_PI / 4096.0f );
+	// Check if this response completes a sensor query
+	bool isSensorResponse = ( query == EnumsClass::AmplifierQueryEnum::GET_REGISTER );
+
+	// Clear packet info
+	Shared->Interface.HWSerial.Packets.outgoingQueryB = EnumsClass::AmplifierQueryEnum::IDLE;
+
+	// Record parse cost
+	PollB.parseCyclesLast = ARM_DWT_CYCCNT - parseStartCycles;
+	PollB.parseCyclesTotal += PollB.parseCyclesLast;
+	if ( PollB.parseCyclesLast > PollB.parseCyclesMax ) {
+		PollB.parseCyclesMax = PollB.parseCyclesLast;
+	}
+
+	// Known-answer query after a fault decides whether polling resumes
+	if ( query == EnumsClass::AmplifierQueryEnum::RESYNC ) {
+		CompleteResync( 1, responseB );
+		return;
+	}
+
+	// Garbled sensor response means framing was lost, realign before trusting the next one
+	if ( isSensorResponse && responseB.type == EnumsClass::AmplifierResponseEnum::MALFORMED && isSensorPollingEnabled ) {
+		Resynchronize( 1 );
+		return;
+	}
+
+	// Hand initialization responses to the sequencer
+	if ( !isSensorResponse ) {
+		InitB.response = responseB;
+		std::atomic_signal_fence( std::memory_order_seq_cst );
+		InitB.isResponseReceived = true;
+	}
+
+	// Keep the pipeline full (port stays marked busy so ReadSensors does not also send)
+	if ( isSensorResponse && isSensorPollingEnabled ) {
+		PollB.samplesReceived++;
+		SendNextSensorQueryB();
+	} else {
+		PollB.isQueryInFlight = false;
+	}
+}
+
+
+
+/**
+ * @brief Parse packet from amp C
+ */
+void AmplifierClass::ParseQueryC() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Start parse timer
+	uint32_t parseStartCycles = ARM_DWT_CYCCNT;
+
+	// Query this response belongs to
+	EnumsClass::AmplifierQueryEnum query = Shared->Interface.HWSerial.Packets.outgoingQueryC;
+
+	// Amplifier name is text rather than an integer (only read during initialization)
+	if ( query == EnumsClass::AmplifierQueryEnum::GET_NAME ) {
+		CopyAsciiResponseText( RxC, InitC.name );
+	}
+
+	// Extract response
+	AmpResponseStruct responseC = ParseResponse( RxC );
+	bool			  isValueC  = ( responseC.type == EnumsClass::AmplifierResponseEnum::VALUE );
+	if ( responseC.type == EnumsClass::AmplifierResponseEnum::MALFORMED ) LinkC.malformed++;
+
+	// Queue for the verbose dump (printed from Loop())
+	if ( isVerboseOutputEnabled ) {
+		PacketLog.Push( AmpPacketLogStruct{ 2, query, responseC } );
+	}
+
+	switch ( query ) {
+
+		// Get baud
+		case EnumsClass::AmplifierQueryEnum::GET_BAUD: {
+			if ( isValueC ) {
+				Shared->Interface.HWSerial.Connection.baudRateC = responseC.value;
+			}
+			break;
+		}
 
-		// Update limit if being measured
-		if ( Shared->Sensors.MotorEncoders.Limits.isBeingMeasured ) {
+		// Poll table register
+		case EnumsClass::AmplifierQueryEnum::GET_REGISTER: {
+			if ( isValueC ) {
+				const PollEntryStruct& entry = PollTable.entry[PollC.entryInFlight];
+
+				// Store through the table
+				if ( entry.raw ) *entry.raw = responseC.value;
+				if ( entry.scaled ) *entry.scaled = responseC.value * entry.scale;
+
+				// Update current if being measured
+				if ( entry.parameter == CONST_COPLEY_REG_CURRENT && Shared->Sensors.MotorCurrents.Limits.isBeingMeasured ) {
+
+					// Record limit C if larger than previous
+					if ( Shared->Sensors.MotorCurrents.measuredCurrentAmpsC > Shared->Sensors.MotorCurrents.Limits.limitC ) {
+						Shared->Sensors.MotorCurrents.Limits.limitC = Shared->Sensors.MotorCurrents.measuredCurrentAmpsC;
+					}
+				}
+
+				// Apply encoder zero offset
+				if ( entry.parameter == CONST_COPLEY_REG_POSITION ) {
+					Shared->Sensors.MotorEncoders.compensatedCountC = Shared->Sensors.MotorEncoders.rawCountC - Shared->Sensors.MotorEncoders.offsetToZeroC;
+					Shared->Sensors.MotorEncoders.measuredAngleDegC = degrees( Shared->Sensors.MotorEncoders.compensatedCountC * 2.0f * M_PI / 4096.0f );
+
+					// Update limit if being measured
+					if ( Shared->Sensors.MotorEncoders.Limits.isBeingMeasured ) {
+
+						// Record limit C if larger than previous
+						if ( Shared->Sensors.MotorEncoders.compensatedCountC > Shared->Sensors.MotorEncoders.Limits.limitCountC ) {
+
+							// Save limit
+							Shared->Sensors.MotorEncoders.Limits.limitCountC  = Shared->Sensors.MotorEncoders.compensatedCountC;
+							Shared->Sensors.MotorEncoders.Limits.limitPhiDegC = degrees( Shared->Sensors.MotorEncoders.compensatedCountC * 2.0f * M_PI / 4096.0f );
+						}
+					}
+				}
+
+				// Publish current / position to the lock-free handoff
+				if ( entry.parameter == CONST_COPLEY_REG_CURRENT || entry.parameter == CONST_COPLEY_REG_POSITION ) {
+					SampleC.BeginPublish();
+					if ( entry.parameter == CONST_COPLEY_REG_CURRENT ) {
+						SampleC.frame.currentAmps = Shared->Sensors.MotorCurrents.measuredCurrentAmpsC;
+						SampleC.frame.currentUs	 = LinkC.sendUs;
+					} else {
+						SampleC.frame.encoderCount = Shared->Sensors.MotorEncoders.compensatedCountC;
+						SampleC.frame.positionUs	  = LinkC.sendUs;
+					}
+					SampleC.frame.requestUs = LinkC.sendUs;
+					SampleC.frame.sequence++;
+					SampleC.EndPublish();
+				}
+			}
+			break;
+		}
 
-			// Record limit C if larger than previous
-			if ( Shared->Sensors.MotorEncoders.compensatedCountC > Shared->Sensors.MotorEncoders.Limits.limitCountC ) {
+		// Set current-control mode
+		case EnumsClass::AmplifierQueryEnum::SET_CURRENT_MODE: {
 
-				// Save limit
-				Shared->Sensors.MotorEncoders.Limits.limitCountC  = Shared->Sensors.MotorEncoders.compensatedCountC;
-				Shared->Sensors.MotorEncoders.Limits.limitPhiDegC = degrees( Shared->Sensors.MotorEncoders.compensatedCountC * 2.0f * M_PI / 4096.0f );
+			// Make sure amplifier acknowledged mode change
+			if ( responseC.type == EnumsClass::AmplifierResponseEnum::OK ) {
+				Shared->Drive.Flags.isCurrentControlled = true;
+			} else {
+				Shared->Drive.Flags.isCurrentControlled = false;
+				Shared->ActionQueue.ReceiveEvents.Push( EnumsClass::AmplifierEventEnum::CURRENT_MODE_REJECTED_C );
 			}
+			break;
+		}
+
+		default: {
+			break;
 		}
 	}
 
-	// Get name
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryC == ASCII.getName ) {
-		Shared->Interface.HWSerial.Connection.ampNameC = responseC.substring( 2, responseC.length() );
+	// Check if this response completes a sensor query
+	bool isSensorResponse = ( query == EnumsClass::AmplifierQueryEnum::GET_REGISTER );
+
+	// Clear packet info
+	Shared->Interface.HWSerial.Packets.outgoingQueryC = EnumsClass::AmplifierQueryEnum::IDLE;
+
+	// Record parse cost
+	PollC.parseCyclesLast = ARM_DWT_CYCCNT - parseStartCycles;
+	PollC.parseCyclesTotal += PollC.parseCyclesLast;
+	if ( PollC.parseCyclesLast > PollC.parseCyclesMax ) {
+		PollC.parseCyclesMax = PollC.parseCyclesLast;
 	}
 
-	// Set 115237 baud rate
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryC == ASCII.setBaud115237 ) {
-		Shared->Interface.HWSerial.isConnected = true;
-		Shared->Interface.HWSerial.Connection.baudRateC = 115237;
+	// Known-answer query after a fault decides whether polling resumes
+	if ( query == EnumsClass::AmplifierQueryEnum::RESYNC ) {
+		CompleteResync( 2, responseC );
+		return;
 	}
 
-	// Set current-control mode
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryC == ASCII.setCurrentMode ) {
+	// Garbled sensor response means framing was lost, realign before trusting the next one
+	if ( isSensorResponse && responseC.type == EnumsClass::AmplifierResponseEnum::MALFORMED && isSensorPollingEnabled ) {
+		Resynchronize( 2 );
+		return;
+	}
 
-		// Make sure amplifier acknowledged mode change
-		if ( responseC == "ok" ) {
-			Shared->Drive.Flags.isCurrentControlled = true;
-		} else {
-			Shared->Drive.Flags.isCurrentControlled = false;
-			Serial.println( F( "Amplifier C current command change failed!" ) );
+	// Hand initialization responses to the sequencer
+	if ( !isSensorResponse ) {
+		InitC.response = responseC;
+		std::atomic_signal_fence( std::memory_order_seq_cst );
+		InitC.isResponseReceived = true;
+	}
+
+	// Keep the pipeline full (port stays marked busy so ReadSensors does not also send)
+	if ( isSensorResponse && isSensorPollingEnabled ) {
+		PollC.samplesReceived++;
+		SendNextSensorQueryC();
+	} else {
+		PollC.isQueryInFlight = false;
+	}
+}
+
+
+
+/**
+ * @brief Add a received byte to a ring using the active protocol's framing
+ * 
+ * @param ring Ring for the port the byte arrived on
+ * @param incomingChar Received byte
+ * @return true A complete response is waiting in the ring
+ * @return false Response still incomplete
+ */
+bool AmplifierClass::ReceiveByte( AmpRxRingStruct& ring, char incomingChar ) {
+
+	// Binary packets carry their own length
+	if ( activeProtocol == EnumsClass::AmplifierProtocolEnum::BINARY ) {
+		ring.Push( incomingChar );
+		return IsResponseComplete( ring );
+	}
+
+	// ASCII lines end with a terminating character
+	if ( incomingChar == '\r' || incomingChar == '\n' ) {
+		return !ring.IsEmpty();
+	}
+
+	ring.Push( incomingChar );
+	return false;
+}
+
+
+
+/**
+ * @brief Check if a whole binary response packet is in the ring
+ * 
+ * Packets that cannot be valid (wrong node, longer than the ring) are reported
+ * complete so the parser discards them instead of waiting forever.
+ * 
+ * @param ring Ring for the port
+ * @return true Packet ready to parse
+ */
+bool AmplifierClass::IsResponseComplete( const AmpRxRingStruct& ring ) {
+
+	uint8_t count = ring.Count();
+
+	// Wrong node ID, nothing to wait for
+	if ( count >= 1 && ring.Peek( 0 ) != CONST_COPLEY_BINARY_NODE ) {
+		return true;
+	}
+
+	// Need the header to know the length
+	if ( count < CONST_COPLEY_BINARY_HEADER_SIZE ) {
+		return false;
+	}
+
+	// Header plus data words
+	uint16_t size = CONST_COPLEY_BINARY_HEADER_SIZE + 2 * uint16_t( ring.Peek( 2 ) );
+	return ( count >= size ) || ( size >= CONST_AMP_RX_RING_SIZE );
+}
+
+
+
+/**
+ * @brief Parse a response with the active protocol
+ * 
+ * @param ring Ring holding one complete response
+ * @return AmpResponseStruct Response type and value
+ */
+AmpResponseStruct AmplifierClass::ParseResponse( AmpRxRingStruct& ring ) {
+
+	if ( activeProtocol == EnumsClass::AmplifierProtocolEnum::BINARY ) {
+		return ParseBinaryResponse( ring );
+	}
+
+	return ParseAsciiResponse( ring );
+}
+
+
+
+/**
+ * @brief Parse a Copley binary response packet out of a receive ring
+ * 
+ * A valid packet XORs to 0x5A. A non-zero error byte becomes an error response,
+ * one data word is a signed 16-bit value and two words a signed 32-bit value
+ * (most significant word first). The ring is always left empty.
+ * 
+ * @param ring Ring holding one response packet
+ * @return AmpResponseStruct Response type and value
+ */
+AmpResponseStruct AmplifierClass::ParseBinaryResponse( AmpRxRingStruct& ring ) {
+
+	AmpResponseStruct response;
+	uint8_t			  count = ring.Count();
+
+	// Nothing received
+	if ( count == 0 ) {
+		return response;
+	}
+
+	// Default to malformed until proven otherwise
+	response.type = EnumsClass::AmplifierResponseEnum::MALFORMED;
+
+	// Check framing
+	uint8_t	 words = ( count >= CONST_COPLEY_BINARY_HEADER_SIZE ) ? ring.Peek( 2 ) : 0;
+	uint16_t size  = CONST_COPLEY_BINARY_HEADER_SIZE + 2 * uint16_t( words );
+	if ( ring.Peek( 0 ) != CONST_COPLEY_BINARY_NODE || count < CONST_COPLEY_BINARY_HEADER_SIZE || size > count ) {
+		ring.Clear();
+		return response;
+	}
+
+	// Check checksum
+	uint8_t checksum = 0;
+	for ( uint8_t i = 0; i < size; i++ ) {
+		checksum ^= ring.Peek( i );
+	}
+	if ( checksum != CONST_COPLEY_BINARY_CHECKSUM_KEY ) {
+		ring.Clear();
+		return response;
+	}
+
+	// Decode payload
+	uint8_t errorCode = ring.Peek( 3 );
+	if ( errorCode != 0 ) {
+		response.type  = EnumsClass::AmplifierResponseEnum::ERROR;
+		response.value = errorCode;
+	} else if ( words == 0 ) {
+		response.type = EnumsClass::AmplifierResponseEnum::OK;
+	} else if ( words == 1 ) {
+		response.type  = EnumsClass::AmplifierResponseEnum::VALUE;
+		response.value = int16_t( ( uint16_t( ring.Peek( 4 ) ) << 8 ) | ring.Peek( 5 ) );
+	} else {
+		response.type  = EnumsClass::AmplifierResponseEnum::VALUE;
+		response.value = int32_t( ( uint32_t( ring.Peek( 4 ) ) << 24 ) | ( uint32_t( ring.Peek( 5 ) ) << 16 ) | ( uint32_t( ring.Peek( 6 ) ) << 8 ) | ring.Peek( 7 ) );
+	}
+
+	ring.Clear();
+	return response;
+}
+
+
+
+/**
+ * @brief Parse an ASCII response line out of a receive ring
+ * 
+ * Accepts "v <int>", "ok" and "e <code>" using integer arithmetic only. The
+ * ring is always left empty, and the work is bounded by the ring size.
+ * 
+ * @param ring Ring holding one response line (without terminator)
+ * @return AmpResponseStruct Response type and value
+ */
+AmpResponseStruct AmplifierClass::ParseAsciiResponse( AmpRxRingStruct& ring ) {
+
+	AmpResponseStruct response;
+	char			  c = 0;
+
+	// Nothing received
+	if ( !ring.Pop( c ) ) {
+		return response;
+	}
+
+	// Default to malformed until proven otherwise
+	response.type = EnumsClass::AmplifierResponseEnum::MALFORMED;
+
+	// Acknowledge: "ok"
+	if ( c == 'o' ) {
+		if ( ring.Pop( c ) && c == 'k' && ring.IsEmpty() ) {
+			response.type = EnumsClass::AmplifierResponseEnum::OK;
 		}
+		ring.Clear();
+		return response;
 	}
 
-	// Set amp initial state (reset)
-	if ( Shared->Interface.HWSerial.Packets.outgoingQueryC == ASCII.setReset ) {
-		Serial.println( "Resetting" );
+	// Value "v <int>" or error "e <code>"
+	if ( ( c == 'v' || c == 'e' ) ) {
+
+		bool	 isError	= ( c == 'e' );
+		bool	 isNegative = false;
+		uint32_t magnitude	= 0;
+
+		// Separator
+		if ( !ring.Pop( c ) || c != ' ' ) {
+			ring.Clear();
+			return response;
+		}
+
+		// Optional sign
+		if ( ring.Pop( c ) && c == '-' ) {
+			isNegative = true;
+			ring.Pop( c );
+		}
+
+		// Digits, rejected as soon as the value leaves the int32 range (2147483648 only when negative)
+		uint32_t limit = isNegative ? 2147483648UL : 2147483647UL;
+		do {
+			uint32_t digit = uint32_t( c - '0' );
+			if ( c < '0' || c > '9' || magnitude > ( limit - digit ) / 10 ) {
+				ring.Clear();
+				return response;
+			}
+			magnitude = magnitude * 10 + digit;
+		} while ( ring.Pop( c ) );
+
+		response.type  = isError ? EnumsClass::AmplifierResponseEnum::ERROR : EnumsClass::AmplifierResponseEnum::VALUE;
+		response.value = isNegative ? int32_t( -int64_t( magnitude ) ) : int32_t( magnitude );
+		return response;
 	}
 
-	// Clear packet info
-	Shared->Interface.HWSerial.Packets.outgoingQueryC	= ASCII.setIdle;
-	Shared->Interface.HWSerial.Packets.respondingQueryC = "";
+	// Anything else
+	ring.Clear();
+	return response;
+}
+
+
+
+/**
+ * @brief Copy the text of a "v <text>" response without consuming it
+ * 
+ * @param ring Ring holding one response line (without terminator)
+ * @param destination String to store the text in
+ */
+void AmplifierClass::CopyAsciiResponseText( AmpRxRingStruct& ring, char* destination ) {
+
+	uint8_t length = 0;
+
+	// Skip the "v " prefix
+	for ( uint8_t i = 2; i < ring.Count() && length < CONST_AMP_RX_RING_SIZE - 1; i++ ) {
+		destination[length++] = ring.buffer[( ring.tail + i ) & ( CONST_AMP_RX_RING_SIZE - 1 )];
+	}
+	destination[length] = '\0';
 }
 
 
@@ -758,6 +1938,26 @@ void AmplifierClass::EnableDebugOutput( bool state ) {
 
 
 
+/**
+ * @brief Print the responses queued by the receive ISR while verbose output is on
+ */
+void AmplifierClass::PrintPacketLog() {
+
+	AmpPacketLogStruct entry;
+	while ( PacketLog.Pop( entry ) ) {
+		Serial.print( "  Packet" );
+		Serial.print( char( 'A' + entry.amp ) );
+		Serial.print( ": " );
+		Serial.print( ASCII.command[uint8_t( entry.query )] );
+		Serial.print( " --> " );
+		Serial.print( uint8_t( entry.response.type ) );
+		Serial.print( " " );
+		Serial.println( entry.response.value );
+	}
+}
+
+
+
 // /*  ============================================================================================
 //  *  ============================================================================================
 //  *
@@ -773,61 +1973,312 @@ void AmplifierClass::EnableDebugOutput( bool state ) {
 //  *  ============================================================================================*/
 
 
+/**
+ * @brief Fill the register poll table
+ * 
+ * One row per register per amplifier. A rate divisor of N polls the register
+ * on every Nth pass of that port's rows, so fast registers interleave with
+ * slow ones on the same link. Adding a channel is one row here.
+ */
+void AmplifierClass::BuildPollTable() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	auto& Currents	= Shared->Sensors.MotorCurrents;
+	auto& Encoders	= Shared->Sensors.MotorEncoders;
+	auto& Telemetry = Shared->Sensors.AmplifierTelemetry;
+
+	// Register, amp, rate divisor, raw destination, scaled destination, scale
+	PollTable.Add( CONST_COPLEY_REG_CURRENT, 0, 1, nullptr, &Currents.measuredCurrentAmpsA, 0.01f );
+	PollTable.Add( CONST_COPLEY_REG_CURRENT, 1, 1, nullptr, &Currents.measuredCurrentAmpsB, 0.01f );
+	PollTable.Add( CONST_COPLEY_REG_CURRENT, 2, 1, nullptr, &Currents.measuredCurrentAmpsC, 0.01f );
+	PollTable.Add( CONST_COPLEY_REG_POSITION, 0, 1, &Encoders.rawCountA, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_POSITION, 1, 1, &Encoders.rawCountB, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_POSITION, 2, 1, &Encoders.rawCountC, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_STATUS, 0, 10, &Telemetry.statusA, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_STATUS, 1, 10, &Telemetry.statusB, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_STATUS, 2, 10, &Telemetry.statusC, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_FAULT_LATCH, 0, 10, &Telemetry.faultLatchA, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_FAULT_LATCH, 1, 10, &Telemetry.faultLatchB, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_FAULT_LATCH, 2, 10, &Telemetry.faultLatchC, nullptr, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_BUS_VOLTAGE, 0, 50, nullptr, &Telemetry.busVoltageA, 0.1f );
+	PollTable.Add( CONST_COPLEY_REG_BUS_VOLTAGE, 1, 50, nullptr, &Telemetry.busVoltageB, 0.1f );
+	PollTable.Add( CONST_COPLEY_REG_BUS_VOLTAGE, 2, 50, nullptr, &Telemetry.busVoltageC, 0.1f );
+	PollTable.Add( CONST_COPLEY_REG_DRIVE_TEMP, 0, 100, nullptr, &Telemetry.driveTempDegCA, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_DRIVE_TEMP, 1, 100, nullptr, &Telemetry.driveTempDegCB, 1.0f );
+	PollTable.Add( CONST_COPLEY_REG_DRIVE_TEMP, 2, 100, nullptr, &Telemetry.driveTempDegCC, 1.0f );
+}
+
+
+
+/**
+ * @brief Report the expected sample rate of every polled register and the wire use per port
+ * 
+ * Uses worst-case reply sizes and the full turnaround allowance, so real rates
+ * should come out at or above these figures.
+ */
+void AmplifierClass::PrintPollBudget() {
+
+	const char ampNames[CONST_AMP_COUNT] = { 'A', 'B', 'C' };
+	bool	   isBinary					 = ( requestedProtocol == EnumsClass::AmplifierProtocolEnum::BINARY );
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+
+		if ( GetInit( amp ).step != EnumsClass::AmplifierInitStepEnum::READY ) {
+			continue;
+		}
+
+		uint32_t baud		  = CONST_AMP_BAUD_CANDIDATES[GetInit( amp ).baudIndex];
+		float	 passTimeUs	  = 0.0f;	 // Average link time per pass over this port's rows
+		float	 passWireBytes = 0.0f;	 // Average bytes on the wire per pass
+
+		// Cost of one pass, each row weighted by how often it is due
+		for ( uint8_t index = 0; index < PollTable.count; index++ ) {
+			const PollEntryStruct& entry = PollTable.entry[index];
+			if ( entry.amp != amp ) continue;
+
+			uint16_t bytes = isBinary ? CONST_COPLEY_BINARY_GET_SIZE + CONST_POLL_BINARY_REPLY_BYTES : strlen( entry.ascii ) + CONST_POLL_ASCII_REPLY_BYTES;
+			passTimeUs += ( bytes * 10 * 1000000.0f / baud + SENSOR_RESPONSE_LATENCY_US ) / entry.rateDivisor;
+			passWireBytes += float( bytes ) / entry.rateDivisor;
+		}
+
+		if ( passTimeUs <= 0.0f ) {
+			continue;
+		}
+
+		float passesPerSec = 1000000.0f / passTimeUs;
+
+		Serial.print( F( "AMPLIFIER:     Poll budget " ) );
+		Serial.print( ampNames[amp] );
+		Serial.print( F( " (" ) );
+		Serial.print( baud );
+		Serial.print( F( " baud, " ) );
+		Serial.print( 100.0f * passWireBytes * passesPerSec * 10.0f / baud, 0 );
+		Serial.print( F( "% wire):" ) );
+
+		// Expected rate of each register
+		for ( uint8_t index = 0; index < PollTable.count; index++ ) {
+			const PollEntryStruct& entry = PollTable.entry[index];
+			if ( entry.amp != amp ) continue;
+
+			Serial.print( F( "  0x" ) );
+			Serial.print( entry.parameter, HEX );
+			Serial.print( F( " " ) );
+			Serial.print( passesPerSec / entry.rateDivisor, 0 );
+			Serial.print( F( " Hz" ) );
+		}
+		Serial.println();
+	}
+}
+
+
+
 /**
  * @brief Read on-board sensors
+ * 
+ * Called from the sensor IntervalTimer. Each port runs its own query pipeline
+ * (the response to one sensor query sends the next), so this only has to start
+ * idle ports and resynchronize any port whose response missed its deadline.
  */
 void AmplifierClass::ReadSensors() {
 
-	// Cycle over current and encoder queries
+	// Wait until amplifiers are initialized
+	if ( !isSensorPollingEnabled ) {
+		return;
+	}
+
+	// Each port runs its own transaction
+	ServiceSensorTransaction( 0 );
+	ServiceSensorTransaction( 1 );
+	ServiceSensorTransaction( 2 );
+}
+
 
-	if ( activeQuery == 0 ) {
 
-		// Read amplifierA current
-		SendQueryA( ASCII.getCurrentReading );
-		activeQuery++;
+/**
+ * @brief Start an idle port, or enforce the deadline of the query in flight
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
+ */
+void AmplifierClass::ServiceSensorTransaction( uint8_t amp ) {
 
-	} else if ( activeQuery == 1 ) {
+	SensorPollStruct& Poll = GetPoll( amp );
 
-		// Read amplifierB current
-		SendQueryB( ASCII.getCurrentReading );
-		activeQuery++;
+	// Only poll amplifiers that came up
+	if ( GetInit( amp ).step != EnumsClass::AmplifierInitStepEnum::READY ) {
+		return;
+	}
 
-	} else if ( activeQuery == 2 ) {
+	// Idle port, start the next query
+	if ( !Poll.isQueryInFlight ) {
+		if ( amp == 0 ) {
+			SendNextSensorQueryA();
+		} else if ( amp == 1 ) {
+			SendNextSensorQueryB();
+		} else {
+			SendNextSensorQueryC();
+		}
+		return;
+	}
 
-		// Read amplifierB current
-		SendQueryC( ASCII.getCurrentReading );
-		activeQuery++;
+	// Still within the deadline
+	if ( int32_t( micros() - Poll.deadlineUs ) < 0 ) {
+		return;
+	}
 
-	} else if ( activeQuery == 3 ) {
+	// Response lost, realign the link
+	GetLink( amp ).timeouts++;
+	Resynchronize( amp );
+}
 
-		// Read amplifierB current
-		SendQueryA( ASCII.getEncoderCount );
-		activeQuery++;
 
-	} else if ( activeQuery == 4 ) {
 
-		// Read amplifierB current
-		SendQueryB( ASCII.getEncoderCount );
-		activeQuery++;
+/**
+ * @brief Flush the port and send the known-answer query
+ * 
+ * Anything still on the wire from the failed transaction is dropped, so the
+ * next response parsed is either the known answer or is rejected and flushed
+ * again. After SENSOR_QUERY_RETRIES misses the link is marked lost and the
+ * probe continues at SENSOR_RESYNC_BACKOFF_US.
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
+ */
+void AmplifierClass::Resynchronize( uint8_t amp ) {
 
-	} else if ( activeQuery == 5 ) {
+	SensorPollStruct& Poll = GetPoll( amp );
 
-		// Read amplifierB current
-		SendQueryC( ASCII.getEncoderCount );
-		activeQuery = 0;
+	// Drop the partial response and anything still buffered
+	GetPort( amp ).clear();
+	GetRx( amp ).Clear();
 
+	// Bounded retries, then back off
+	if ( Poll.resyncAttempts < SENSOR_QUERY_RETRIES ) {
+		Poll.resyncAttempts++;
 	} else {
-		activeQuery = 0;
+		Poll.isLinkLost = true;
+	}
+
+	// Send the known-answer query
+	GetLink( amp ).resyncs++;
+	Poll.isResyncing	 = true;
+	Poll.isQueryInFlight = true;
+	Poll.deadlineUs		 = micros() + ( Poll.isLinkLost ? SENSOR_RESYNC_BACKOFF_US : Poll.deadlineWindowUs );
+	SendQuery( amp, EnumsClass::AmplifierQueryEnum::RESYNC );
+}
+
+
+
+/**
+ * @brief Resume polling if the known-answer query came back intact
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
+ * @param response Parsed response to the resync query
+ */
+void AmplifierClass::CompleteResync( uint8_t amp, const AmpResponseStruct& response ) {
+
+	SensorPollStruct& Poll = GetPoll( amp );
+
+	// Stale or garbled answer, flush and try again
+	if ( response.type != EnumsClass::AmplifierResponseEnum::VALUE || uint32_t( response.value ) != CONST_AMP_BAUD_CANDIDATES[GetInit( amp ).baudIndex] ) {
+		Resynchronize( amp );
+		return;
 	}
 
+	// Link realigned
+	Poll.isResyncing	 = false;
+	Poll.resyncAttempts	 = 0;
+	Poll.isLinkLost		 = false;
+	Poll.isQueryInFlight = false;
+
+	// Pick the sensor sequence back up
+	if ( isSensorPollingEnabled ) {
+		ServiceSensorTransaction( amp );
+	}
+}
+
+
+
+/**
+ * @brief Send the next sensor query in the poll sequence to amp A
+ */
+void AmplifierClass::SendNextSensorQueryA() {
+
+	// Port lent to the trace capture
+	if ( isPollingPausedA ) {
+		PollA.isQueryInFlight = false;
+		return;
+	}
+
+	// Next register due on this port
+	int8_t entry = PollTable.Next( 0, PollA.nextQuery, PollA.pass );
+	if ( entry < 0 ) {
+		PollA.isQueryInFlight = false;
+		return;
+	}
+
+	// Mark port busy before the query goes out
+	PollA.entryInFlight	  = uint8_t( entry );
+	PollA.isQueryInFlight = true;
+	PollA.deadlineUs	  = micros() + PollA.deadlineWindowUs;
+
+	SendQueryA( EnumsClass::AmplifierQueryEnum::GET_REGISTER );
+}
+
+/**
+ * @brief Send the next sensor query in the poll sequence to amp B
+ */
+void AmplifierClass::SendNextSensorQueryB() {
+
+	// Port lent to the trace capture
+	if ( isPollingPausedB ) {
+		PollB.isQueryInFlight = false;
+		return;
+	}
+
+	// Next register due on this port
+	int8_t entry = PollTable.Next( 1, PollB.nextQuery, PollB.pass );
+	if ( entry < 0 ) {
+		PollB.isQueryInFlight = false;
+		return;
+	}
+
+	// Mark port busy before the query goes out
+	PollB.entryInFlight	  = uint8_t( entry );
+	PollB.isQueryInFlight = true;
+	PollB.deadlineUs	  = micros() + PollB.deadlineWindowUs;
+
+	SendQueryB( EnumsClass::AmplifierQueryEnum::GET_REGISTER );
+}
+
+/**
+ * @brief Send the next sensor query in the poll sequence to amp C
+ */
+void AmplifierClass::SendNextSensorQueryC() {
+
+	// Port lent to the trace capture
+	if ( isPollingPausedC ) {
+		PollC.isQueryInFlight = false;
+		return;
+	}
+
+	// Next register due on this port
+	int8_t entry = PollTable.Next( 2, PollC.nextQuery, PollC.pass );
+	if ( entry < 0 ) {
+		PollC.isQueryInFlight = false;
+		return;
+	}
 
-	// Read current
-	// ReadCurrents();
+	// Mark port busy before the query goes out
+	PollC.entryInFlight	  = uint8_t( entry );
+	PollC.isQueryInFlight = true;
+	PollC.deadlineUs	  = micros() + PollC.deadlineWindowUs;
 
-	// Read encoders
-	// ReadEncoders();
+	SendQueryC( EnumsClass::AmplifierQueryEnum::GET_REGISTER );
 }
 
+
+
 /**
  * @brief Send zero command to motor encoders
  * 
@@ -855,6 +2306,196 @@ void AmplifierClass::ZeroMotorEncoders() {
 	SYSTEM_GLOBAL.ResetActionFlag( SYSTEM_GLOBAL.GetData()->ActionQueue.zeroMotorEncoders );
 }
 
+/**
+ * @brief Print per-amplifier round-trip statistics and start a new window
+ */
+void AmplifierClass::PrintLinkStats() {
+
+	const char			ampNames[CONST_AMP_COUNT] = { 'A', 'B', 'C' };
+	AmpLinkStatsStruct* links[CONST_AMP_COUNT]	  = { &LinkA, &LinkB, &LinkC };
+	uint32_t			now						  = micros();
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+
+		AmpLinkStatsStruct& Link	  = *links[amp];
+		float				windowSec = ( now - Link.windowStartUs ) / 1000000.0f;
+
+		Serial.print( F( "AMPLIFIER:     Link " ) );
+		Serial.print( ampNames[amp] );
+		Serial.print( F( "  sent: " ) );
+		Serial.print( Link.queriesSent );
+		Serial.print( F( "  recv: " ) );
+		Serial.print( Link.responsesReceived );
+		Serial.print( F( "  timeouts: " ) );
+		Serial.print( Link.timeouts );
+		Serial.print( F( "  malformed: " ) );
+		Serial.print( Link.malformed );
+		Serial.print( F( "  overwritten: " ) );
+		Serial.print( Link.overwritten );
+		Serial.print( F( "  resyncs: " ) );
+		Serial.print( Link.resyncs );
+		if ( GetPoll( amp ).isLinkLost ) {
+			Serial.print( F( " (LOST)" ) );
+		}
+		Serial.print( F( "  rtt min/p50/p99/max: " ) );
+		Serial.print( Link.responsesReceived ? Link.rttMinUs : 0 );
+		Serial.print( F( "/" ) );
+		Serial.print( Link.PercentileUs( 50 ) );
+		Serial.print( F( "/" ) );
+		Serial.print( Link.PercentileUs( 99 ) );
+		Serial.print( F( "/" ) );
+		Serial.print( Link.rttMaxUs );
+		Serial.print( F( " us  parse mean/max: " ) );
+		Serial.print( Link.responsesReceived ? GetPoll( amp ).parseCyclesTotal / Link.responsesReceived : 0 );
+		Serial.print( F( "/" ) );
+		Serial.print( GetPoll( amp ).parseCyclesMax );
+		Serial.print( F( " cyc  rx: " ) );
+		Serial.print( windowSec > 0 ? Link.bytesReceived / windowSec : 0.0f, 0 );
+		Serial.println( F( " B/s" ) );
+
+		// Start a new window
+		Link.Clear( now );
+		GetPoll( amp ).parseCyclesTotal = 0;
+		GetPoll( amp ).parseCyclesMax	= 0;
+	}
+
+	// Loop length against sample age
+	Serial.print( CONST_AMP_RX_IN_ISR ? F( "AMPLIFIER:     RX in ISR" ) : F( "AMPLIFIER:     RX in serialEvent" ) );
+	Serial.print( F( "  loop mean/max: " ) );
+	Serial.print( SampleAge.loopCount ? SampleAge.loopSumUs / SampleAge.loopCount : 0 );
+	Serial.print( F( "/" ) );
+	Serial.print( SampleAge.loopMaxUs );
+	Serial.print( F( " us  sample age mean/max: " ) );
+	Serial.print( SampleAge.ageCount ? SampleAge.ageSumUs / SampleAge.ageCount : 0 );
+	Serial.print( F( "/" ) );
+	Serial.print( SampleAge.ageMaxUs );
+	Serial.print( F( " us  torn reads: " ) );
+	Serial.println( SampleAge.torn );
+	SampleAge.Clear();
+
+	// Force allocation cost
+	Serial.print( F( "AMPLIFIER:     Force allocation cycles last/max: " ) );
+	Serial.print( Allocator.cyclesLast );
+	Serial.print( F( "/" ) );
+	Serial.print( Allocator.cyclesMax );
+	Serial.print( F( "  saturated: " ) );
+	Serial.println( Allocator.saturations );
+	Allocator.cyclesMax	  = 0;
+	Allocator.saturations = 0;
+
+	// Closed-loop controller cost
+	Serial.print( F( "AMPLIFIER:     Closed loop " ) );
+	Serial.print( SYSTEM_GLOBAL.GetData()->Drive.Control.isClosedLoopEnabled ? F( "on " ) : F( "off" ) );
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		MotorControllerStruct& Control = GetControl( amp );
+		Serial.print( F( "  " ) );
+		Serial.print( ampNames[amp] );
+		Serial.print( F( " cycles last/max: " ) );
+		Serial.print( Control.cyclesLast );
+		Serial.print( F( "/" ) );
+		Serial.print( Control.cyclesMax );
+		Serial.print( F( " saturated: " ) );
+		Serial.print( Control.saturations );
+		Control.cyclesMax	= 0;
+		Control.saturations = 0;
+	}
+	Serial.println();
+
+	// Slew limiter cost and the peak current of the last command step on each amp
+	PWMClass& Pwm = SYSTEM_GLOBAL.GetData()->Drive.Pwm;
+	Serial.print( F( "AMPLIFIER:     Slew limit " ) );
+	Serial.print( Pwm.isSlewLimitEnabled ? ( Pwm.isSCurveEnabled ? F( "S-curve" ) : F( "on" ) ) : F( "off" ) );
+	Serial.print( F( " cycles last/max: " ) );
+	Serial.print( slewCyclesLast );
+	Serial.print( F( "/" ) );
+	Serial.println( slewCyclesMax );
+	slewCyclesMax = 0;
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		SlewTransitionStruct& Transition = GetTransition( amp );
+		Serial.print( F( "AMPLIFIER:     " ) );
+		Serial.print( ampNames[amp] );
+		Serial.print( F( " transitions: " ) );
+		Serial.print( Transition.transitions );
+		Serial.print( F( "  last step: " ) );
+		Serial.print( Transition.lastStepCounts );
+		Serial.print( F( " counts over " ) );
+		Serial.print( Transition.lastTicks );
+		Serial.print( F( " ticks  peak/final: " ) );
+		Serial.print( Transition.lastPeakAmps, 2 );
+		Serial.print( F( "/" ) );
+		Serial.print( Transition.lastFinalAmps, 2 );
+		Serial.print( F( " A  worst peak: " ) );
+		Serial.print( Transition.worstPeakAmps, 2 );
+		Serial.println( F( " A" ) );
+		Transition.transitions	 = 0;
+		Transition.worstPeakAmps = 0.0f;
+	}
+
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( SYSTEM_GLOBAL.GetData()->ActionQueue.printAmplifierLinkStats );
+}
+
+
+
+/**
+ * @brief Latest current and position from one amplifier
+ * 
+ * @param amp Amplifier index (0 = A, 1 = B, 2 = C)
+ * @param destination Sample copy
+ * @return false if the sample kept changing underneath the read
+ */
+bool AmplifierClass::ReadLatestSample( uint8_t amp, AmpSampleStruct& destination ) {
+	const AmpSamplePublisherStruct& Publisher = ( amp == 0 ) ? SampleA : ( amp == 1 ) ? SampleB : SampleC;
+	return Publisher.Read( destination );
+}
+
+
+
+/**
+ * @brief Measure loop() length (call at the top of loop())
+ */
+void AmplifierClass::RecordLoopStart() {
+
+	uint32_t now = micros();
+
+	if ( SampleAge.lastLoopStartUs != 0 ) {
+		uint32_t lengthUs = now - SampleAge.lastLoopStartUs;
+		SampleAge.loopCount++;
+		SampleAge.loopSumUs += lengthUs;
+		if ( lengthUs > SampleAge.loopMaxUs ) SampleAge.loopMaxUs = lengthUs;
+	}
+	SampleAge.lastLoopStartUs = now;
+}
+
+
+
+/**
+ * @brief Age of the samples the output ISR is about to use, measured from when each query was sent
+ */
+void AmplifierClass::MeasureSampleAge() {
+
+	uint32_t		now = micros();
+	AmpSampleStruct sample;
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+
+		if ( !ReadLatestSample( amp, sample ) ) {
+			SampleAge.torn++;
+			continue;
+		}
+
+		// Nothing published yet
+		if ( sample.sequence == 0 ) {
+			continue;
+		}
+
+		uint32_t ageUs = now - sample.requestUs;
+		SampleAge.ageCount++;
+		SampleAge.ageSumUs += ageUs;
+		if ( ageUs > SampleAge.ageMaxUs ) SampleAge.ageMaxUs = ageUs;
+	}
+}
+
 // /**
 //  * @brief Read the motor currents via HWSerial
 //  */
@@ -1396,152 +3037,657 @@ float AmplifierClass::GetCurrentFromIntegerPercentage( uint8_t percentValue ) {
 //  *  ===================================================================================*/
 
 /**
- * @brief Public accessor to drive motor outputs
+ * @brief Work out this tick's raw PWM (compute phase of the output tick)
  */
-void AmplifierClass::DriveMotorOutputs() {
+void AmplifierClass::ComputeMotorOutputs() {
 
 	// Shared Memory Alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-	if ( Shared->Sensors.MotorEncoders.Limits.isBeingMeasured ) {
-		TestEncoderLimits();
+	// Staleness of the samples this output is based on
+	MeasureSampleAge();
+
+	// One sensor frame for the whole tick
+	PublishSensorSnapshot();
+
+	// Set again by whichever polar path maps this tick
+	hasPolarCommand = false;
+
+	// Honour a playback stop even while the sweep or a cue owns the output
+	if ( Shared->Drive.Stream.isStopRequested ) {
+		ServiceSetpointPlayback();
+	}
+
+	// The limit sweep takes precedence over task cues, which take precedence over streamed setpoints, then the allocator
+	if ( TestEncoderLimits() ) {
+		isForceAllocationActive = false;
+	} else if ( ServiceHapticCue() ) {
+		isForceAllocationActive = false;
+	} else if ( ServiceSetpointPlayback() ) {
+		isForceAllocationActive = false;
 	}
+	// Render the target force over all three cables
+	else if ( Shared->Drive.MappingClass.isForceAllocationEnabled ) {
+		AllocateCableForces();
+		isForceAllocationActive = true;
+	}
+	// Allocation just switched off, release the cables
+	else if ( isForceAllocationActive ) {
+		MapPercentageToPwmABC( 0.0f, 0.0f, 0.0f );
+		isForceAllocationActive = false;
+	}
+
+	// Credit the heading map with this tick's command
+	if ( Shared->Sensors.MotorEncoders.Limits.isMapBeingRecorded && hasPolarCommand ) {
+		RecordRomMap();
+	}
+}
+
 
-	// Command PWM
+/**
+ * @brief Limit, shape and write this tick's PWM (actuate phase of the output tick)
+ */
+void AmplifierClass::ActuateMotorOutputs() {
 	CommandPWM();
+	PublishDriveSnapshot();
+}
+
+
+/**
+ * @brief Gather this tick's sensor readings into one frame and publish it
+ * 
+ * Each amplifier's count and current come from its own sample handoff, so
+ * they belong together. An amplifier whose sample was being rewritten keeps
+ * its previous values.
+ */
+void AmplifierClass::PublishSensorSnapshot() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	SensorFrameStruct Frame = Shared->Sensors.Snapshot.frame;	 // Only this ISR writes it
+	AmpSampleStruct	  sample;
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		if ( ReadLatestSample( amp, sample ) ) {
+			Frame.encoderCount[amp] = sample.encoderCount;
+			Frame.positionUs[amp]	= sample.positionUs;
+			Frame.currentAmps[amp]	= sample.currentAmps;
+		}
+	}
+	Frame.platformHorizontalDeg = Shared->Sensors.PlatformEncoders.horizontalAngleDegrees;
+	Frame.platformVerticalDeg	= Shared->Sensors.PlatformEncoders.verticalAngleDegrees;
+	Frame.timeUs				= micros();
+
+	Shared->Sensors.Snapshot.Publish( Frame );
+}
+
+
+/**
+ * @brief Publish the PWM written on this tick
+ */
+void AmplifierClass::PublishDriveSnapshot() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	DriveFrameStruct Frame;
+	Frame.rawPwm[0]			   = Shared->Drive.Pwm.rawOutgoingA;
+	Frame.rawPwm[1]			   = Shared->Drive.Pwm.rawOutgoingB;
+	Frame.rawPwm[2]			   = Shared->Drive.Pwm.rawOutgoingC;
+	Frame.totalPwm[0]		   = Shared->Drive.Pwm.totalOutgoingA;
+	Frame.totalPwm[1]		   = Shared->Drive.Pwm.totalOutgoingB;
+	Frame.totalPwm[2]		   = Shared->Drive.Pwm.totalOutgoingC;
+	Frame.targetRadius		   = Shared->Drive.MappingClass.targetRadius;
+	Frame.targetAngleDeg	   = Shared->Drive.MappingClass.targetAngleDeg;
+	Frame.isMotorOutputEnabled = Shared->Drive.Flags.isMotorOutputEnabled;
+	Frame.timeUs			   = micros();
+
+	Shared->Drive.Snapshot.Publish( Frame );
 }
 
 
-void AmplifierClass::TestEncoderLimits() {
+/**
+ * @brief Play back the setpoint stream for this output tick
+ * 
+ * Polar setpoints go through the heading table, ABC setpoints straight to
+ * PWM. Magnitudes are clamped, since cubic interpolation can overshoot.
+ * When playback ends or is stopped the cables are released.
+ * 
+ * @return true while the stream owns the raw PWM
+ */
+bool AmplifierClass::ServiceSetpointPlayback() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
 
+	float				 value[3];
+	SetpointPlaybackEnum state = Shared->Drive.Stream.Sample( micros(), value );
 
-	// // Shared Memory Alias
-	// static auto Shared = SYSTEM_GLOBAL.GetData();
+	// Nothing to play, release the cables if the stream just stopped
+	if ( state == SetpointPlaybackEnum::IDLE || state == SetpointPlaybackEnum::FINISHED ) {
+		if ( isPlaybackActive ) {
+			MapPercentageToPwmABC( 0.0f, 0.0f, 0.0f );
+			isPlaybackActive = false;
+		}
+		return false;
+	}
 
-	// 	// Map terms
-	// 	MapPolarTermsToCommandOutput( Shared->Sensors.MotorEncoders.Limits. Command.Limits.testHeading, Command.Limits.testMagnitude );
+	// Polar setpoint
+	if ( Shared->Drive.Stream.format == SetpointFormatEnum::POLAR ) {
+		float magnitude = std::clamp( value[1], 0.0f, CONST_STREAM_MAX_PERCENT );
+		MapPolarTermsToCommandOutputQ15( int32_t( value[0] * 100.0f ), int32_t( magnitude / 100.0f * CONST_Q15_ONE ) );
+	}
+	// Cable setpoint
+	else {
+		MapPercentageToPwmABC( std::clamp( value[0], 0.0f, CONST_STREAM_MAX_PERCENT ) / 100.0f,
+							   std::clamp( value[1], 0.0f, CONST_STREAM_MAX_PERCENT ) / 100.0f,
+							   std::clamp( value[2], 0.0f, CONST_STREAM_MAX_PERCENT ) / 100.0f );
+	}
 
-	// 	// Increment angle
-	// 	Command.Limits.testHeading = Command.Limits.testHeading + 0.1f;
+	isPlaybackActive = true;
+	return true;
+}
 
-	// 	if ( Command.Limits.testHeading >= 360.0f ) {
-	// 		Command.Limits.testHeading = 0.0f;
-	// 	}
 
-	// Debug display
-	// Serial.print( "ROM Test >> Theta: " );
-	// Serial.print( Command.Limits.testHeading );
-	// Serial.print( "° / " );
-	// Serial.print( Command.Limits.testMagnitude );
-	// Serial.println();
+/**
+ * @brief Play the discrimination-task cue for this output tick
+ * 
+ * The cue starts on the first tick at or after its armed onset time, so
+ * onset does not depend on when loop() gets round to the prompt.
+ * 
+ * @return true while the cue owns the raw PWM
+ */
+bool AmplifierClass::ServiceHapticCue() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	int32_t magnitudeQ15 = 0;
+
+	// Nothing to play, release the cables if the cue just ended
+	if ( !Shared->Drive.Cue.Sample( micros(), magnitudeQ15 ) ) {
+		if ( isCueActive ) {
+			MapPercentageToPwmABC( 0.0f, 0.0f, 0.0f );
+			isCueActive = false;
+		}
+		return false;
+	}
+
+	MapPolarTermsToCommandOutputQ15( Shared->Drive.Cue.headingCdeg, magnitudeQ15 );
+	isCueActive = true;
+	return true;
+}
+
+
+/**
+ * @brief Step the automated encoder limit sweep for this output tick
+ * 
+ * Ramps the magnitude at each heading through MapPolarTermsToCommandOutput,
+ * measuring the encoder and current response at the end of every dwell,
+ * until the ring stalls or the sweep maximum is reached. Releases the
+ * cables if the sweep is stopped. Printing and storing the result is left
+ * to loop() (FINISH_ROM_SWEEP event).
+ * 
+ * @return true while the sweep owns the raw PWM
+ */
+bool AmplifierClass::TestEncoderLimits() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Stopped (or never started), release the cables once
+	if ( !Shared->Sensors.MotorEncoders.Limits.isBeingTested ) {
+		if ( isSweepActive ) {
+			MapPercentageToPwmABC( 0.0f, 0.0f, 0.0f );
+			isSweepActive = false;
+		}
+		return false;
+	}
+
+	// Without output the ring cannot move, so every heading would read as a stall
+	if ( !Shared->Drive.Flags.isMotorOutputEnabled && !Sweep.isStopQueued ) {
+		Sweep.isStopQueued = Shared->ActionQueue.TickEvents.Push( EnumsClass::AmplifierEventEnum::STOP_ROM_SWEEP );
+	}
+
+	uint32_t nowUs	   = micros();
+	uint32_t elapsedMs = ( nowUs - Sweep.stateStartUs ) / 1000;
+
+	switch ( Sweep.state ) {
+
+		case EnumsClass::RomSweepStateEnum::IDLE:
+			Sweep.headingIndex = 0;
+			BeginSweepHeading( nowUs );
+			break;
+
+		case EnumsClass::RomSweepStateEnum::RAMPING: {
+
+			if ( elapsedMs < CONST_SWEEP_DWELL_MS ) break;
+
+			// Response over the dwell
+			int32_t count[3];
+			float	currentAmps[3];
+			ReadSweepResponse( count, currentAmps );
+
+			int32_t fastest = 0;
+			for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+				int32_t moved = count[amp] - Sweep.stepStartCount[amp];
+				if ( moved > fastest ) fastest = moved;
+			}
+			float speedCps = fastest * 1000.0f / elapsedMs;
+
+			if ( Sweep.stepCount < CONST_SWEEP_HEADINGS * CONST_SWEEP_MAX_STEPS ) {
+				RomSweepStepStruct& Step = Sweep.Step[Sweep.stepCount++];
+				Step.headingIndex		 = Sweep.headingIndex;
+				Step.magnitudePercent	 = uint8_t( Sweep.magnitudePercent );
+				Step.speedCps			 = speedCps;
+				for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+					Step.currentCa[amp] = int16_t( currentAmps[amp] * 100.0f );
+					Step.count[amp]		= count[amp];
+				}
+			}
+
+			// Stall detection (slow but not stalled leaves the count alone)
+			if ( speedCps >= CONST_SWEEP_MOVING_CPS ) {
+				Sweep.hasMoved			= true;
+				Sweep.stalledSteps		= 0;
+				Sweep.lastMovingPercent = uint8_t( Sweep.magnitudePercent );
+			} else if ( Sweep.hasMoved && speedCps < CONST_SWEEP_STALL_CPS ) {
+				Sweep.stalledSteps++;
+			}
+
+			bool isStalled = Sweep.stalledSteps >= CONST_SWEEP_STALL_STEPS;
+			if ( isStalled || Sweep.magnitudePercent >= CONST_SWEEP_MAX_PERCENT ) {
+				RomSweepPointStruct& Point = Sweep.Point[Sweep.headingIndex];
+				Point.isStalled			   = isStalled;
+				Point.limitPercent		   = isStalled ? Sweep.lastMovingPercent : uint8_t( Sweep.magnitudePercent );
+				for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+					Point.count[amp]	   = count[amp];
+					Point.currentAmps[amp] = currentAmps[amp];
+				}
+				Sweep.state = EnumsClass::RomSweepStateEnum::RELEASING;
+			} else {
+				IncreaseRangeOfMotionMagnitude();
+				for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) Sweep.stepStartCount[amp] = count[amp];
+			}
+			Sweep.stateStartUs = nowUs;
+			break;
+		}
+
+		case EnumsClass::RomSweepStateEnum::RELEASING:
+			if ( elapsedMs < CONST_SWEEP_RELEASE_STEP_MS ) break;
+			DecreaseRangeOfMotionMagnitude();
+			if ( Sweep.magnitudePercent <= 0.0f ) Sweep.state = EnumsClass::RomSweepStateEnum::SETTLING;
+			Sweep.stateStartUs = nowUs;
+			break;
+
+		case EnumsClass::RomSweepStateEnum::SETTLING:
+			if ( elapsedMs < CONST_SWEEP_SETTLE_MS ) break;
+			if ( ++Sweep.headingIndex < CONST_SWEEP_HEADINGS ) {
+				BeginSweepHeading( nowUs );
+				break;
+			}
+
+			// Every heading done, hand the table to loop()
+			Sweep.state										   = EnumsClass::RomSweepStateEnum::COMPLETE;
+			Sweep.finishUs									   = nowUs;
+			Shared->Sensors.MotorEncoders.Limits.isBeingTested = false;
+			Shared->ActionQueue.TickEvents.Push( EnumsClass::AmplifierEventEnum::FINISH_ROM_SWEEP );
+			MapPercentageToPwmABC( 0.0f, 0.0f, 0.0f );
+			isSweepActive = false;
+			return false;
+
+		case EnumsClass::RomSweepStateEnum::COMPLETE:
+			break;
+	}
+
+	MapPolarTermsToCommandOutput( RomSweepStruct::HeadingDeg( Sweep.headingIndex ), Sweep.magnitudePercent );
+	isSweepActive = true;
+	return true;
+}
+
+
+/**
+ * @brief Start ramping at the current sweep heading
+ */
+void AmplifierClass::BeginSweepHeading( uint32_t nowUs ) {
+
+	float currentAmps[3];
+	ReadSweepResponse( Sweep.stepStartCount, currentAmps );
+
+	Sweep.state				= EnumsClass::RomSweepStateEnum::RAMPING;
+	Sweep.magnitudePercent	= CONST_SWEEP_START_PERCENT;
+	Sweep.hasMoved			= false;
+	Sweep.stalledSteps		= 0;
+	Sweep.lastMovingPercent = 0;
+	Sweep.stateStartUs		= nowUs;
+}
+
+
+/**
+ * @brief Latest encoder counts and currents (previous values kept for an amplifier with no sample)
+ */
+void AmplifierClass::ReadSweepResponse( int32_t* count, float* currentAmps ) {
+
+	AmpSampleStruct sample;
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		count[amp]		 = Sweep.stepStartCount[amp];
+		currentAmps[amp] = 0.0f;
+		if ( ReadLatestSample( amp, sample ) ) {
+			count[amp]		 = sample.encoderCount;
+			currentAmps[amp] = sample.currentAmps;
+		}
+	}
 }
 
+
+/**
+ * @brief Scale each motor's drive down as it approaches its encoder limit
+ * 
+ * Runs inside the output ISR on the raw PWM, before tension. The guard
+ * predicts the count at the next encoder sample from the filtered velocity,
+ * so the drive is already reduced by the time the limit would be crossed
+ * rather than restored after the fact. With force allocation active the raw
+ * PWM includes the tension floor, which is kept.
+ */
 void AmplifierClass::ApplyEncoderLimits() {
 
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	uint32_t nowUs = micros();
+
+	int16_t*	   raws[CONST_AMP_COUNT]   = { &Shared->Drive.Pwm.rawOutgoingA, &Shared->Drive.Pwm.rawOutgoingB, &Shared->Drive.Pwm.rawOutgoingC };
+	int16_t*	   prevs[CONST_AMP_COUNT]  = { &Shared->Drive.Pwm.totalOutgoingPrevA, &Shared->Drive.Pwm.totalOutgoingPrevB, &Shared->Drive.Pwm.totalOutgoingPrevC };
+	const int32_t  limits[CONST_AMP_COUNT] = { Shared->Sensors.MotorEncoders.Limits.limitCountA, Shared->Sensors.MotorEncoders.Limits.limitCountB, Shared->Sensors.MotorEncoders.Limits.limitCountC };
+	float		   floor				   = ( isForceAllocationActive && Shared->Drive.Tension.isEnabled ) ? Shared->Drive.Tension.valueInteger / 100.0f : 0.0f;
+
+	// Same frame for all three motors (published by this ISR at the start of the tick)
+	const SensorFrameStruct& Frame = Shared->Sensors.Snapshot.frame;
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+
+		EncoderLimitGuardStruct& Guard = GetGuard( amp );
+
+		// New limit session
+		if ( !isLimitSessionActive ) Guard.StartSession( nowUs );
+
+		if ( Frame.positionUs[amp] != 0 ) {
+			Guard.OnPosition( Frame.encoderCount[amp], Frame.positionUs[amp], limits[amp] );
+		}
+
+		float scale = Guard.Update( limits[amp], nowUs );
+		if ( scale < 1.0f ) {
+			float fraction = constrain( ( 2048 - *raws[amp] ) / 2047.0f, 0.0f, 1.0f );
+			float scaled   = fmaxf( fraction * scale, fminf( fraction, floor ) );
+			*raws[amp]	   = std::clamp( 2048 - int( scaled * 2047 ), 4, 2044 );
+		}
+
+		// Store last value
+		*prevs[amp] = *raws[amp];
+	}
+
+	isLimitSessionActive = true;
+}
+
+
+/**
+ * @brief Print the overshoot statistics of the current limit session
+ */
+void AmplifierClass::PrintEncoderLimitSession() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.printEncoderLimitSession );
+
+	const char ampNames[CONST_AMP_COUNT] = { 'A', 'B', 'C' };
+
+	Serial.print( F( "AMPLIFIER:     Encoder limit session, " ) );
+	Serial.print( ( micros() - GuardA.sessionStartUs ) / 1000000.0f, 1 );
+	Serial.println( F( " s" ) );
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+
+		EncoderLimitGuardStruct& Guard = GetGuard( amp );
+
+		Serial.print( F( "AMPLIFIER:     " ) );
+		Serial.print( ampNames[amp] );
+		Serial.print( F( " crossings: " ) );
+		Serial.print( Guard.crossings );
+		Serial.print( F( "  overshoot max/mean: " ) );
+		Serial.print( Guard.maxOvershootCounts );
+		Serial.print( F( "/" ) );
+		Serial.print( Guard.crossings ? float( Guard.sumOvershootCounts + ( Guard.isOver ? Guard.crossingPeakCounts : 0 ) ) / Guard.crossings : 0.0f, 1 );
+		Serial.print( F( " counts  samples over: " ) );
+		Serial.print( Guard.samplesOver );
+		Serial.print( F( "  ticks scaled: " ) );
+		Serial.print( Guard.ticksScaled );
+		Serial.print( F( "  min scale: " ) );
+		Serial.print( Guard.minScale, 2 );
+		Serial.print( F( "  velocity: " ) );
+		Serial.print( Guard.velocityCps, 0 );
+		Serial.print( F( " counts/s  sample interval: " ) );
+		Serial.print( Guard.intervalUs / 1000.0f, 1 );
+		Serial.println( F( " ms" ) );
+	}
+}
+
+
+/**
+ * @brief Drive the amplifiers
+ */
+void AmplifierClass::CommandPWM() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Check if encoder limits are being applied
+	if ( Shared->Sensors.MotorEncoders.Limits.isEnabled ) {
+
+		// Apply limits
+		ApplyEncoderLimits();
+	} else {
+
+		// Next enable starts a new session
+		isLimitSessionActive = false;
+	}
+
+
+
+	// The allocator already holds every cable at the tension floor
+	if ( isForceAllocationActive ) {
+
+		Shared->Drive.Pwm.totalOutgoingA = Shared->Drive.Pwm.rawOutgoingA;
+		Shared->Drive.Pwm.totalOutgoingB = Shared->Drive.Pwm.rawOutgoingB;
+		Shared->Drive.Pwm.totalOutgoingC = Shared->Drive.Pwm.rawOutgoingC;
+	}
+	// Add tension value (if enabled)
+	else if ( Shared->Drive.Tension.isEnabled ) {
+
+		// Calculate sums for each amplifier
+		Shared->Drive.Pwm.totalOutgoingA = Shared->Drive.Pwm.rawOutgoingA - Shared->Drive.Tension.valuePwm;
+		Shared->Drive.Pwm.totalOutgoingB = Shared->Drive.Pwm.rawOutgoingB - Shared->Drive.Tension.valuePwm;
+		Shared->Drive.Pwm.totalOutgoingC = Shared->Drive.Pwm.rawOutgoingC - Shared->Drive.Tension.valuePwm;
+	}
+
+
+
+	// Shape steps in the command before the current loop tracks it
+	ApplySlewLimit();
+
+
+
+	// Closed-loop correction from the latest sensor samples
+	if ( Shared->Drive.Control.isClosedLoopEnabled ) {
+		ApplyClosedLoopControl();
+	} else {
+		ResetClosedLoopControl();
+	}
+
+
+
+	/*******************
+	 *  SAFETY CHECK!  *
+	 *******************/
+
+	// Constrain values to 16-bit range
+	Shared->Drive.Pwm.totalOutgoingA = constrain( Shared->Drive.Pwm.totalOutgoingA, CONST_PWM_MAX, CONST_PWM_ZERO );
+	Shared->Drive.Pwm.totalOutgoingB = constrain( Shared->Drive.Pwm.totalOutgoingB, CONST_PWM_MAX, CONST_PWM_ZERO );
+	Shared->Drive.Pwm.totalOutgoingC = constrain( Shared->Drive.Pwm.totalOutgoingC, CONST_PWM_MAX, CONST_PWM_ZERO );
+
+	// Make sure safety switch is engaged and output enabled
+	if ( isInitializationComplete && Shared->Drive.Flags.isMotorOutputEnabled && Shared->Drive.Flags.isSafetySwitchEngaged ) {
+
+		// Write analog values
+		analogWrite( PIN_AMPLIFIER_PWM_A, Shared->Drive.Pwm.totalOutgoingA );
+		analogWrite( PIN_AMPLIFIER_PWM_B, Shared->Drive.Pwm.totalOutgoingB );
+		analogWrite( PIN_AMPLIFIER_PWM_C, Shared->Drive.Pwm.totalOutgoingC );
+
+	} else {
+
+		// Write zeros
+		CommandZero();
+
+		// Nothing to integrate against while the output is off
+		ResetClosedLoopControl();
+
+		// Ramp up from zero when the output comes back
+		ResetSlewLimit();
+	}
+}
+
+
+
+/**
+ * @brief Limit the change in each outgoing PWM per tick
+ * 
+ * Runs inside the output ISR on the totals after tension, before the
+ * current loop. The limiter state sits in Drive.Pwm next to the previous
+ * totals. Transition stats are kept whether or not the limiter is on, so
+ * the peak current of a step can be compared with and without it.
+ */
+void AmplifierClass::ApplySlewLimit() {
 
 	// Shared memory alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-	// Motor A encoder has passed limits
-	if ( Shared->Sensors.MotorEncoders.compensatedCountA > Shared->Sensors.MotorEncoders.Limits.limitCountA ) {
+	uint32_t startCycles = ARM_DWT_CYCCNT;
 
-		Serial.println( F( "Over Limit A!" ) );
-
-		// Apply last current value
-		Shared->Drive.Pwm.rawOutgoingA = Shared->Drive.Pwm.totalOutgoingPrevA;
-	}
-	// Motor encoder has NOT passed limits
-	else {
+	PWMClass& Pwm							= Shared->Drive.Pwm;
+	int16_t*  totals[CONST_AMP_COUNT]		= { &Pwm.totalOutgoingA, &Pwm.totalOutgoingB, &Pwm.totalOutgoingC };
+	float*	  outputs[CONST_AMP_COUNT]		= { &Pwm.slewOutgoingA, &Pwm.slewOutgoingB, &Pwm.slewOutgoingC };
+	float*	  rates[CONST_AMP_COUNT]		= { &Pwm.slewRateA, &Pwm.slewRateB, &Pwm.slewRateC };
+	AmpSampleStruct sample;
 
-		// Store last value
-		Shared->Drive.Pwm.totalOutgoingPrevA = Shared->Drive.Pwm.rawOutgoingA;
-	}
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
 
-	// Motor B encoder has passed limits
-	if ( Shared->Sensors.MotorEncoders.compensatedCountB > Shared->Sensors.MotorEncoders.Limits.limitCountB ) {
+		int16_t target = *totals[amp];
 
-		Serial.println( F( "Over Limit B!" ) );
+		if ( Pwm.isSlewLimitEnabled ) {
+			StepSlewLimiter( target, *outputs[amp], *rates[amp], Pwm.slewMaxDelta, Pwm.slewMaxAccel, Pwm.isSCurveEnabled );
+			*totals[amp] = int16_t( lroundf( *outputs[amp] ) );
+		} else {
+			*outputs[amp] = target;
+			*rates[amp]	  = 0.0f;
+		}
 
-		// Apply last current value
-		Shared->Drive.Pwm.rawOutgoingB = Shared->Drive.Pwm.totalOutgoingPrevB;
+		// Peak current through command steps
+		float amps = ReadLatestSample( amp, sample ) ? sample.currentAmps : GetTransition( amp ).latestAmps;
+		GetTransition( amp ).Update( target, *totals[amp], amps );
 	}
-	// Motor encoder has NOT passed limits
-	else {
 
-		// Store last value
-		Shared->Drive.Pwm.totalOutgoingPrevB = Shared->Drive.Pwm.rawOutgoingB;
-	}
+	slewCyclesLast = ARM_DWT_CYCCNT - startCycles;
+	if ( slewCyclesLast > slewCyclesMax ) slewCyclesMax = slewCyclesLast;
+}
 
-	// Motor C encoder has passed limits
-	if ( Shared->Sensors.MotorEncoders.compensatedCountC > Shared->Sensors.MotorEncoders.Limits.limitCountC ) {
 
-		Serial.println( F( "Over Limit C!" ) );
 
-		// Apply last current value
-		Shared->Drive.Pwm.rawOutgoingC = Shared->Drive.Pwm.totalOutgoingPrevC;
-	}
-	// Motor encoder has NOT passed limits
-	else {
+/**
+ * @brief Put every limiter channel back at zero output
+ */
+void AmplifierClass::ResetSlewLimit() {
 
-		// Store last value
-		Shared->Drive.Pwm.totalOutgoingPrevC = Shared->Drive.Pwm.rawOutgoingC;
-	}
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	Shared->Drive.Pwm.slewOutgoingA = CONST_PWM_ZERO;
+	Shared->Drive.Pwm.slewOutgoingB = CONST_PWM_ZERO;
+	Shared->Drive.Pwm.slewOutgoingC = CONST_PWM_ZERO;
+	Shared->Drive.Pwm.slewRateA		= 0.0f;
+	Shared->Drive.Pwm.slewRateB		= 0.0f;
+	Shared->Drive.Pwm.slewRateC		= 0.0f;
 }
 
 
+
 /**
- * @brief Drive the amplifiers
+ * @brief Correct the outgoing commands with the current trim and position hold
+ * 
+ * Runs inside the output ISR on the totals CommandPWM is about to write. An
+ * amplifier with no current and position sample yet is left open-loop.
  */
-void AmplifierClass::CommandPWM() {
+void AmplifierClass::ApplyClosedLoopControl() {
 
 	// Shared memory alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-	// Check if encoder limits are being applied
-	if ( Shared->Sensors.MotorEncoders.Limits.isEnabled ) {
-
-		// Apply limits
-		ApplyEncoderLimits();
-	}
+	MotorControlGainsStruct Gains;
+	Gains.currentKp		= Shared->Drive.Control.currentKp;
+	Gains.currentKi		= Shared->Drive.Control.currentKi;
+	Gains.positionKp	= Shared->Drive.Control.positionKp;
+	Gains.positionKd	= Shared->Drive.Control.positionKd;
+	Gains.trimLimitAmps = Shared->Drive.Control.trimLimitAmps;
 
+	int16_t* totals[CONST_AMP_COUNT] = { &Shared->Drive.Pwm.totalOutgoingA, &Shared->Drive.Pwm.totalOutgoingB, &Shared->Drive.Pwm.totalOutgoingC };
+	AmpSampleStruct sample;
 
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
 
-	// Add tension value (if enabled)
-	if ( Shared->Drive.Tension.isEnabled ) {
+		uint32_t			   startCycles = ARM_DWT_CYCCNT;
+		MotorControllerStruct& Control	   = GetControl( amp );
 
-		// Calculate sums for each amplifier
-		Shared->Drive.Pwm.totalOutgoingA = Shared->Drive.Pwm.rawOutgoingA - Shared->Drive.Tension.valuePwm;
-		Shared->Drive.Pwm.totalOutgoingB = Shared->Drive.Pwm.rawOutgoingB - Shared->Drive.Tension.valuePwm;
-		Shared->Drive.Pwm.totalOutgoingC = Shared->Drive.Pwm.rawOutgoingC - Shared->Drive.Tension.valuePwm;
-	}
+		if ( !ReadLatestSample( amp, sample ) || sample.currentUs == 0 || sample.positionUs == 0 ) {
+			continue;
+		}
 
+		// Velocity from the newest position sample
+		Control.OnPosition( sample.encoderCount, sample.positionUs );
 
+		// Capture the hold position when hold is switched on
+		if ( Shared->Drive.Control.isPositionHoldEnabled && !Control.isHolding ) {
+			Control.StartHold( sample.encoderCount );
+		} else if ( !Shared->Drive.Control.isPositionHoldEnabled ) {
+			Control.isHolding = false;
+		}
 
-	/*******************
-	 *  SAFETY CHECK!  *
-	 *******************/
+		// PWM to current and back
+		float fraction = ( 2048 - *totals[amp] ) / 2047.0f;
+		fraction	   = constrain( fraction, 0.0f, 1.0f );
+		float output   = Control.Update( Gains, fraction * CONST_CONTROL_FULL_SCALE_AMPS, CONST_CONTROL_CURRENT_SIGN * sample.currentAmps, sample.currentUs, sample.encoderCount );
+		*totals[amp]   = int16_t( 2048 - int( output / CONST_CONTROL_FULL_SCALE_AMPS * 2047 ) );
 
-	// Constrain values to 16-bit range
-	Shared->Drive.Pwm.totalOutgoingA = constrain( Shared->Drive.Pwm.totalOutgoingA, CONST_PWM_MAX, CONST_PWM_ZERO );
-	Shared->Drive.Pwm.totalOutgoingB = constrain( Shared->Drive.Pwm.totalOutgoingB, CONST_PWM_MAX, CONST_PWM_ZERO );
-	Shared->Drive.Pwm.totalOutgoingC = constrain( Shared->Drive.Pwm.totalOutgoingC, CONST_PWM_MAX, CONST_PWM_ZERO );
+		Control.cyclesLast = ARM_DWT_CYCCNT - startCycles;
+		if ( Control.cyclesLast > Control.cyclesMax ) Control.cyclesMax = Control.cyclesLast;
+	}
+}
 
-	// Make sure safety switch is engaged and output enabled
-	if ( Shared->Drive.Flags.isMotorOutputEnabled && Shared->Drive.Flags.isSafetySwitchEngaged ) {
 
-		// Write analog values
-		analogWrite( PIN_AMPLIFIER_PWM_A, Shared->Drive.Pwm.totalOutgoingA );
-		analogWrite( PIN_AMPLIFIER_PWM_B, Shared->Drive.Pwm.totalOutgoingB );
-		analogWrite( PIN_AMPLIFIER_PWM_C, Shared->Drive.Pwm.totalOutgoingC );
 
-	} else {
+/**
+ * @brief Clear every controller's integrator and hold
+ */
+void AmplifierClass::ResetClosedLoopControl() {
 
-		// Write zeros
-		CommandZero();
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		GetControl( amp ).Reset();
 	}
 }
 
 
+
 /**
  * @brief Send zeros to the PWM output
  */
@@ -1571,6 +3717,16 @@ void AmplifierClass::MapPolarTermsToCommandOutput( float theta, float magnitude
 	// Shared memory alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
+	// Wrap angle
+	if ( theta < 0 ) {
+		theta += 360.0f;
+	}
+
+	// Heading map (only replace the magnitude when it clamps, to keep float precision otherwise)
+	int32_t magnitudeQ15 = int32_t( magnitude / 100.0f * CONST_Q15_ONE );
+	int32_t limitedQ15	 = LimitMagnitudeToRomMap( int32_t( lroundf( theta * 100.0f ) ), magnitudeQ15 );
+	if ( limitedQ15 < magnitudeQ15 ) magnitude = limitedQ15 * 100.0f / CONST_Q15_ONE;
+
 	// Local variables
 	float thetaTarget	  = radians( theta );	   // Target angle
 	float targetMagnitude = magnitude / 100.0f;	   // Nomalized target magnitude
@@ -1581,11 +3737,6 @@ void AmplifierClass::MapPolarTermsToCommandOutput( float theta, float magnitude
 	float percentageB	  = 0.0f;				   // Percentage contribution B
 	float percentageC	  = 0.0f;				   // Percentage contribution C
 
-	// Wrap angle
-	if ( theta < 0 ) {
-		theta += 360.0f;
-	}
-
 	/****************************************
 	 *  Determine motor pair contributions  *
 	 ****************************************/
@@ -1598,7 +3749,7 @@ void AmplifierClass::MapPolarTermsToCommandOutput( float theta, float magnitude
 			thetaAT = Mapping.thetaA - thetaTarget;
 			thetaCT = Mapping.angleAC - thetaAT;
 		}
-		if ( thetaTarget > Mapping.thetaC ) {
+		if ( thetaTarget >= Mapping.thetaC ) {
 			thetaCT = thetaTarget - Mapping.thetaC;
 			thetaAT = Mapping.angleAC - thetaCT;
 		}
@@ -1654,6 +3805,67 @@ void AmplifierClass::MapPolarTermsToCommandOutput( float theta, float magnitude
 }
 
 
+/**
+ * @brief Maps heading and magnitude to PWM through the heading table (for use inside the output ISR)
+ * 
+ * @param headingCdeg Heading in centidegrees
+ * @param magnitudeQ15 Magnitude in Q15 (CONST_Q15_ONE = 100 %)
+ */
+void AmplifierClass::MapPolarTermsToCommandOutputQ15( int32_t headingCdeg, int32_t magnitudeQ15 ) {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	magnitudeQ15 = LimitMagnitudeToRomMap( headingCdeg, magnitudeQ15 );
+
+	int16_t pwm[3];
+	MapPolarTermsToPwmLut( headingCdeg, magnitudeQ15, pwm );
+
+	Shared->Drive.Pwm.rawOutgoingA = pwm[0];
+	Shared->Drive.Pwm.rawOutgoingB = pwm[1];
+	Shared->Drive.Pwm.rawOutgoingC = pwm[2];
+}
+
+
+
+/**
+ * @brief Allocate the target force over all three cables
+ * 
+ * Heading and magnitude come from Drive.MappingClass (targetAngleDeg,
+ * targetRadius in percent). The tension setting becomes the minimum-tension
+ * floor instead of a constant subtracted from every channel, so holding the
+ * floor adds no net force.
+ */
+void AmplifierClass::AllocateCableForces() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	uint32_t startCycles = ARM_DWT_CYCCNT;
+
+	float magnitude = Shared->Drive.MappingClass.targetRadius / 100.0f;
+	float heading	= radians( Shared->Drive.MappingClass.targetAngleDeg );
+
+	// Heading map
+	int32_t magnitudeQ15 = int32_t( magnitude * CONST_Q15_ONE );
+	int32_t limitedQ15	 = LimitMagnitudeToRomMap( int32_t( lroundf( Shared->Drive.MappingClass.targetAngleDeg * 100.0f ) ), magnitudeQ15 );
+	if ( limitedQ15 < magnitudeQ15 ) magnitude = float( limitedQ15 ) / CONST_Q15_ONE;
+	float floor		= Shared->Drive.Tension.isEnabled ? Shared->Drive.Tension.valueInteger / 100.0f : 0.0f;
+	float tension[3];
+
+	Allocator.Allocate( magnitude * cosf( heading ), magnitude * sinf( heading ), floor, tension );
+
+	Shared->Drive.MappingClass.contributionA = tension[0];
+	Shared->Drive.MappingClass.contributionB = tension[1];
+	Shared->Drive.MappingClass.contributionC = tension[2];
+	MapPercentageToPwmABC( tension[0], tension[1], tension[2] );
+
+	Allocator.cyclesLast = ARM_DWT_CYCCNT - startCycles;
+	if ( Allocator.cyclesLast > Allocator.cyclesMax ) Allocator.cyclesMax = Allocator.cyclesLast;
+}
+
+
+
 /**
  * @brief Maps an ABC percentage to PWM
  * @param percentA 
@@ -1712,6 +3924,9 @@ void AmplifierClass::StartMeasuringRangeOfMotionLimits() {
 	// Shared memory alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.startMeasuringLimits );
+
 	// Check if limit is being measured for the first time
 	if ( Shared->Sensors.MotorEncoders.Limits.isBeingMeasured == false ) {
 
@@ -1736,6 +3951,9 @@ void AmplifierClass::StopMeasuringRangeOfMotionLimits() {
 	// Shared memory alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.stopMeasuringLimits );
+
 	// Update flag
 	Shared->Sensors.MotorEncoders.Limits.isBeingMeasured = false;
 	Shared->Sensors.MotorEncoders.Limits.isSet			 = true;
@@ -1743,65 +3961,396 @@ void AmplifierClass::StopMeasuringRangeOfMotionLimits() {
 }
 
 
+// === RANGE OF MOTION MAP ========================================================================
+
+/**
+ * @brief Note a polar command for the heading map and clamp its magnitude to the map
+ * 
+ * Called by every heading-based path (table, float and allocator). ABC
+ * setpoints carry no heading and are not clamped.
+ * 
+ * @return Magnitude to render (Q15)
+ */
+int32_t AmplifierClass::LimitMagnitudeToRomMap( int32_t headingCdeg, int32_t magnitudeQ15 ) {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	commandHeadingCdeg	= headingCdeg;
+	commandMagnitudeQ15 = magnitudeQ15;
+	hasPolarCommand		= true;
+
+	// Never clamp against a map that is being rebuilt
+	if ( !Shared->Sensors.MotorEncoders.Limits.isMapEnabled || Shared->Sensors.MotorEncoders.Limits.isMapBeingRecorded || Shared->Sensors.MotorEncoders.Limits.isBeingTested ) return magnitudeQ15;
+
+	return RomMap.ClampQ15( headingCdeg, magnitudeQ15 );
+}
+
+
+/**
+ * @brief Credit the commanded heading's bin with this tick's magnitude
+ * 
+ * A motor inside the guard margin counts as at its limit, since the guard
+ * would already be scaling its drive down.
+ */
+void AmplifierClass::RecordRomMap() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	if ( commandMagnitudeQ15 <= 0 ) return;
+
+	const int32_t	limits[CONST_AMP_COUNT] = { Shared->Sensors.MotorEncoders.Limits.limitCountA, Shared->Sensors.MotorEncoders.Limits.limitCountB, Shared->Sensors.MotorEncoders.Limits.limitCountC };
+	bool			isWithinLimits			= true;
+	AmpSampleStruct sample;
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		if ( ReadLatestSample( amp, sample ) && sample.encoderCount > limits[amp] - int32_t( CONST_LIMIT_MARGIN_COUNTS ) ) {
+			isWithinLimits = false;
+		}
+	}
+
+	RomMap.Record( commandHeadingCdeg, commandMagnitudeQ15, isWithinLimits );
+}
+
+
+/**
+ * @brief Start a guided heading map recording
+ * 
+ * The operator drives every heading outward (gamepad, stream or cues) until
+ * the encoder limits are reached. Requires measured encoder limits.
+ */
+void AmplifierClass::StartRomMap() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.startRomMap );
+
+	if ( !Shared->Sensors.MotorEncoders.Limits.isSet ) {
+		Serial.println( F( "AMPLIFIER:     Measure encoder limits before recording the heading map." ) );
+		return;
+	}
+
+	// Clear before the output ISR starts writing to the bins
+	Shared->Sensors.MotorEncoders.Limits.isMapBeingRecorded = false;
+	std::atomic_signal_fence( std::memory_order_seq_cst );
+	RomMap.StartRecording();
+	std::atomic_signal_fence( std::memory_order_seq_cst );
+	Shared->Sensors.MotorEncoders.Limits.isMapSet			= false;
+	Shared->Sensors.MotorEncoders.Limits.isMapBeingRecorded = true;
+
+	Serial.println( F( "AMPLIFIER:     Heading map recording...                Started." ) );
+}
+
+
+/**
+ * @brief Stop recording, fill the headings the sweep missed and store the map
+ */
+void AmplifierClass::FinishRomMap() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.finishRomMap );
+
+	if ( !Shared->Sensors.MotorEncoders.Limits.isMapBeingRecorded ) return;
+
+	Shared->Sensors.MotorEncoders.Limits.isMapBeingRecorded = false;
+	std::atomic_signal_fence( std::memory_order_seq_cst );
+
+	uint16_t visited = RomMap.FinishRecording();
+	if ( visited == 0 ) {
+		Shared->Sensors.MotorEncoders.Limits.isMapSet	  = false;
+		Shared->Sensors.MotorEncoders.Limits.isMapEnabled = false;
+		Serial.println( F( "AMPLIFIER:     Heading map recording...                No headings reached." ) );
+		return;
+	}
+
+	SaveRomMap();
+	Shared->Sensors.MotorEncoders.Limits.isMapSet	  = true;
+	Shared->Sensors.MotorEncoders.Limits.isMapEnabled = true;
+
+	Serial.print( F( "AMPLIFIER:     Heading map recorded, " ) );
+	Serial.print( visited );
+	Serial.print( F( "/" ) );
+	Serial.print( CONST_ROM_BINS );
+	Serial.print( F( " bins reached, " ) );
+	Serial.print( RomMap.ticksOver );
+	Serial.print( F( "/" ) );
+	Serial.print( RomMap.ticksRecorded );
+	Serial.println( F( " ticks at a limit. Stored and enabled." ) );
+}
+
+
+/**
+ * @brief Print the map, ten bins per line, as percentages
+ */
+void AmplifierClass::PrintRomMap() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.printRomMap );
+
+	if ( !Shared->Sensors.MotorEncoders.Limits.isMapSet ) {
+		Serial.println( F( "AMPLIFIER:     No heading map recorded." ) );
+		return;
+	}
+
+	Serial.print( F( "AMPLIFIER:     Heading map (max magnitude %), clamp " ) );
+	Serial.print( Shared->Sensors.MotorEncoders.Limits.isMapEnabled ? F( "enabled" ) : F( "disabled" ) );
+	Serial.print( F( ", " ) );
+	Serial.print( RomMap.clampedTicks );
+	Serial.println( F( " ticks clamped" ) );
+
+	for ( uint16_t bin = 0; bin < CONST_ROM_BINS; bin += 10 ) {
+		Serial.print( F( "AMPLIFIER:     " ) );
+		Serial.print( bin * CONST_ROM_BIN_CDEG / 100 );
+		Serial.print( F( "\t" ) );
+		for ( uint16_t i = bin; i < bin + 10 && i < CONST_ROM_BINS; i++ ) {
+			Serial.print( RomMap.Image.maxQ15[i] * 100.0f / CONST_Q15_ONE, 1 );
+			Serial.print( F( "\t" ) );
+		}
+		Serial.println();
+	}
+}
+
+
+/**
+ * @brief Read the stored map, enabling it if valid
+ */
+void AmplifierClass::LoadRomMap() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	EEPROM.get( CONST_ROM_EEPROM_ADDRESS, RomMap.Image );
+
+	if ( !RomMap.Image.IsValid() ) {
+		RomMap.Image = RomMapImageStruct();
+		Serial.println( F( "AMPLIFIER:     Heading map...                          None stored." ) );
+		return;
+	}
+
+	for ( uint16_t i = 0; i < CONST_ROM_BINS; i++ ) RomMap.isVisited[i] = true;
+	Shared->Sensors.MotorEncoders.Limits.isMapSet	  = true;
+	Shared->Sensors.MotorEncoders.Limits.isMapEnabled = true;
+	Serial.println( F( "AMPLIFIER:     Heading map...                          Loaded." ) );
+}
+
+
+/**
+ * @brief Store the sealed map
+ */
+void AmplifierClass::SaveRomMap() {
+	EEPROM.put( CONST_ROM_EEPROM_ADDRESS, RomMap.Image );
+}
+
+
 // === RANGE OF MOTION LIMIT TESTING ==============================================================
 
-// /**
-//  * @brief Start the range of motion limit test
-//  */
-// void AmplifierClass::StartTestingRangeOfMotionLimits() {
+/**
+ * @brief Start the automated limit sweep
+ * 
+ * Limit enforcement is suspended for the sweep, since it is measuring the
+ * limits, and restored when it ends.
+ */
+void AmplifierClass::StartTestingRangeOfMotionLimits() {
 
-// 	// // Shared memory alias
-// 	// static auto Shared = SYSTEM_GLOBAL.GetData();
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-// 	// // Check if limits are already being tested
-// 	// if ( Shared->Sensors.MotorEncoders.Limits.isBeingTested == false ) {
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.startRomSweep );
 
-// 	// 	// Update flags
-// 	// 	Shared->Sensors.MotorEncoders.Limits.isBeingTested = true;
+	EncoderLimitsClass& Limits = Shared->Sensors.MotorEncoders.Limits;
 
-// 	// 	// Reset values
-// 	// 	Command.Limits.testHeading	 = 0.0f;
-// 	// 	Command.Limits.testMagnitude = 0.0f;
-// 	// }
-// }
+	if ( Limits.isBeingTested ) return;
 
+	if ( !Shared->Drive.Flags.isMotorOutputEnabled ) {
+		Serial.println( F( "AMPLIFIER:     Enable motor output before the limit sweep." ) );
+		return;
+	}
+	if ( Limits.isBeingMeasured || Limits.isMapBeingRecorded ) {
+		Serial.println( F( "AMPLIFIER:     Finish the limit measurement or map recording before the limit sweep." ) );
+		return;
+	}
+	if ( Shared->State.systemState == EnumsClass::SystemStateEnum::RUNNING_TASK ) {
+		Serial.println( F( "AMPLIFIER:     Finish the running task before the limit sweep." ) );
+		return;
+	}
 
-// void AmplifierClass::StopTestingRangeOfMotionLimits() {
+	// Reset the table before the output ISR starts filling it
+	Sweep.state		   = EnumsClass::RomSweepStateEnum::IDLE;
+	Sweep.stepCount	   = 0;
+	Sweep.isStopQueued = false;
+	for ( uint8_t i = 0; i < CONST_SWEEP_HEADINGS; i++ ) Sweep.Point[i] = RomSweepPointStruct();
+	Sweep.startUs		  = micros();
+	Sweep.wasLimitEnabled = Limits.isEnabled;
+	Limits.isEnabled	  = false;
+	std::atomic_signal_fence( std::memory_order_seq_cst );
+	Limits.isBeingTested = true;
+
+	Serial.print( F( "AMPLIFIER:     Limit sweep over " ) );
+	Serial.print( CONST_SWEEP_HEADINGS );
+	Serial.print( F( " headings started, at most " ) );
+	Serial.print( CONST_SWEEP_MAX_MS / 1000 );
+	Serial.println( F( " s." ) );
+}
 
-// 	// Shared memory alias
-// 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-// 	// Update flags
-// 	Shared->Sensors.MotorEncoders.Limits.isBeingTested = false;
-// }
+/**
+ * @brief Abandon the automated limit sweep (the output ISR releases the cables)
+ */
+void AmplifierClass::StopTestingRangeOfMotionLimits() {
 
-// void AmplifierClass::IncreaseRangeOfMotionMagnitude() {
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
 
-// 		// Shared memory alias
-// 		static auto Shared = SYSTEM_GLOBAL.GetData();
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.stopRomSweep );
 
-// 	// // Increase test magnitude
-// 	// if ( Command.Limits.testMagnitude < 98.0f ) {
-// 	// 	Command.Limits.testMagnitude = Command.Limits.testMagnitude + 2.0f;
-// 	// } else {
-// 	// 	Command.Limits.testMagnitude = 100.0f;
-// 	// }
-// }
+	if ( !Shared->Sensors.MotorEncoders.Limits.isBeingTested ) return;
 
-// void AmplifierClass::DecreaseRangeOfMotionMagnitude() {
+	// Update flags
+	Shared->Sensors.MotorEncoders.Limits.isBeingTested = false;
+	Shared->Sensors.MotorEncoders.Limits.isEnabled	   = Sweep.wasLimitEnabled;
 
-// 	// // Decrease test magnitude
-// 	// if ( Command.Limits.testMagnitude > 2.0f ) {
-// 	// 	Command.Limits.testMagnitude = Command.Limits.testMagnitude - 2.0f;
-// 	// } else {
-// 	// 	Command.Limits.testMagnitude = 0.0f;
-// 	// }
-// }
+	Serial.print( F( "AMPLIFIER:     Limit sweep stopped at heading " ) );
+	Serial.print( RomSweepStruct::HeadingDeg( Sweep.headingIndex ), 0 );
+	Serial.println( F( " deg, limits unchanged." ) );
+}
 
-// float AmplifierClass::GetTestMagnitude() {
 
-// 	return Command.Limits.testMagnitude;
-// }
+/**
+ * @brief Raise the sweep magnitude one step
+ */
+void AmplifierClass::IncreaseRangeOfMotionMagnitude() {
+	Sweep.magnitudePercent = fminf( Sweep.magnitudePercent + CONST_SWEEP_STEP_PERCENT, float( CONST_SWEEP_MAX_PERCENT ) );
+}
+
+
+/**
+ * @brief Lower the sweep magnitude one step
+ */
+void AmplifierClass::DecreaseRangeOfMotionMagnitude() {
+	Sweep.magnitudePercent = fmaxf( Sweep.magnitudePercent - CONST_SWEEP_STEP_PERCENT, 0.0f );
+}
+
+
+/**
+ * @brief Print the sweep table and apply it
+ * 
+ * Each motor's limit becomes the largest count it reached at a stalled
+ * heading. The heading map is filled from the per-heading limits and
+ * stored. Headings that never stalled found no limit and stay uncapped, and
+ * a sweep with no stall at all leaves the limits and the stored map as
+ * they were.
+ */
+void AmplifierClass::FinishRangeOfMotionSweep() {
+
+	// Shared memory alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	EncoderLimitsClass& Limits = Shared->Sensors.MotorEncoders.Limits;
+
+	// Every dwell
+	Serial.println( F( "SWEEP,Heading[deg],Magnitude[%],Speed[counts/s],CurrentA[A],CurrentB[A],CurrentC[A],CountA,CountB,CountC" ) );
+	for ( uint16_t k = 0; k < Sweep.stepCount; k++ ) {
+		const RomSweepStepStruct& Step = Sweep.Step[k];
+		Serial.print( F( "SWEEP," ) );
+		Serial.print( RomSweepStruct::HeadingDeg( Step.headingIndex ), 0 );
+		Serial.print( F( "," ) );
+		Serial.print( Step.magnitudePercent );
+		Serial.print( F( "," ) );
+		Serial.print( Step.speedCps, 0 );
+		for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+			Serial.print( F( "," ) );
+			Serial.print( Step.currentCa[amp] / 100.0f, 2 );
+		}
+		for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+			Serial.print( F( "," ) );
+			Serial.print( Step.count[amp] );
+		}
+		Serial.println();
+	}
+
+	// Calibration table
+	int32_t	 limitCount[3] = { INT32_MIN, INT32_MIN, INT32_MIN };
+	uint16_t limitQ15[CONST_SWEEP_HEADINGS];
+	uint8_t	 stalledHeadings = 0;
+
+	Serial.println( F( "LIMIT,Heading[deg],Limit[%],Stalled,CurrentA[A],CurrentB[A],CurrentC[A],CountA,CountB,CountC" ) );
+	for ( uint8_t i = 0; i < CONST_SWEEP_HEADINGS; i++ ) {
+		const RomSweepPointStruct& Point = Sweep.Point[i];
+
+		Serial.print( F( "LIMIT," ) );
+		Serial.print( RomSweepStruct::HeadingDeg( i ), 0 );
+		Serial.print( F( "," ) );
+		Serial.print( Point.limitPercent );
+		Serial.print( F( "," ) );
+		Serial.print( Point.isStalled ? 1 : 0 );
+		for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+			Serial.print( F( "," ) );
+			Serial.print( Point.currentAmps[amp], 2 );
+		}
+		for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+			Serial.print( F( "," ) );
+			Serial.print( Point.count[amp] );
+		}
+		Serial.println();
+
+		// Reaching the sweep maximum without a stall is not a limit
+		limitQ15[i] = uint16_t( Point.isStalled ? int32_t( Point.limitPercent ) * CONST_Q15_ONE / 100 : CONST_Q15_ONE );
+		if ( !Point.isStalled ) continue;
+		stalledHeadings++;
+		for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+			if ( Point.count[amp] > limitCount[amp] ) limitCount[amp] = Point.count[amp];
+		}
+	}
+
+	Serial.print( F( "AMPLIFIER:     Limit sweep finished in " ) );
+	Serial.print( ( Sweep.finishUs - Sweep.startUs ) / 1000000.0f, 1 );
+	Serial.print( F( " s, " ) );
+	Serial.print( stalledHeadings );
+	Serial.print( F( "/" ) );
+	Serial.print( CONST_SWEEP_HEADINGS );
+	Serial.println( F( " headings stalled." ) );
+
+	// Limits and heading map need at least one stall
+	if ( stalledHeadings == 0 ) {
+		Limits.isEnabled = Sweep.wasLimitEnabled;
+		Serial.println( F( "AMPLIFIER:     No travel limit found, encoder limits and heading map unchanged." ) );
+		return;
+	}
+
+	// Heading map from the per-heading limits
+	RomMap.FillFromHeadings( limitQ15, CONST_SWEEP_HEADINGS );
+	SaveRomMap();
+	Limits.isMapSet		= true;
+	Limits.isMapEnabled = true;
+
+	Limits.limitCountA	= limitCount[0];
+	Limits.limitCountB	= limitCount[1];
+	Limits.limitCountC	= limitCount[2];
+	Limits.limitPhiDegA = degrees( limitCount[0] * 2.0f * M_PI / 4096.0f );
+	Limits.limitPhiDegB = degrees( limitCount[1] * 2.0f * M_PI / 4096.0f );
+	Limits.limitPhiDegC = degrees( limitCount[2] * 2.0f * M_PI / 4096.0f );
+	Limits.isSet		= true;
+	Limits.isEnabled	= true;
+
+	Serial.print( F( "AMPLIFIER:     Encoder limits A/B/C: " ) );
+	Serial.print( limitCount[0] );
+	Serial.print( F( "/" ) );
+	Serial.print( limitCount[1] );
+	Serial.print( F( "/" ) );
+	Serial.print( limitCount[2] );
+	Serial.println( F( " counts, enabled. Heading map stored." ) );
+}
 /***
  * *****
  * 
@@ -1853,30 +4402,26 @@ void AmplifierClass::StopMeasuringRangeOfMotionLimits() {
 
 
 /**
- * @brief Reset amplifier to clear previous configurations
- * (note: reset sequence is ENABLE HIGH to LOW)
+ * @brief Start the reset pulse on all amplifiers
+ * (note: reset sequence is ENABLE HIGH to LOW, released by ServiceInitialization after CONST_AMP_RESET_HOLD_US)
  */
 void AmplifierClass::Reset() {
 
-	// Send reset sequence to amp A
-	digitalWrite( PIN_AMPLIFIER_ENABLE_A, HIGH );
-	digitalWrite( PIN_AMPLIFIER_ENABLE_A, LOW );
-	delay( 500 );
-	digitalWrite( PIN_AMPLIFIER_ENABLE_A, HIGH );
-
-	// Send reset sequence to amp B
-	digitalWrite( PIN_AMPLIFIER_ENABLE_B, HIGH );
-	digitalWrite( PIN_AMPLIFIER_ENABLE_B, LOW );
-	delay( 500 );
-	digitalWrite( PIN_AMPLIFIER_ENABLE_B, HIGH );
-
-	// Send reset sequence to amp C
-	digitalWrite( PIN_AMPLIFIER_ENABLE_C, HIGH );
-	digitalWrite( PIN_AMPLIFIER_ENABLE_C, LOW );
-	delay( 500 );
-	digitalWrite( PIN_AMPLIFIER_ENABLE_C, HIGH );
-
-	Serial.println( F( "AMPLIFIER:     System resetting...                     Ready." ) );
+	// Pull all enables low together
+	digitalWriteFast( PIN_AMPLIFIER_ENABLE_A, HIGH );
+	digitalWriteFast( PIN_AMPLIFIER_ENABLE_B, HIGH );
+	digitalWriteFast( PIN_AMPLIFIER_ENABLE_C, HIGH );
+	digitalWriteFast( PIN_AMPLIFIER_ENABLE_A, LOW );
+	digitalWriteFast( PIN_AMPLIFIER_ENABLE_B, LOW );
+	digitalWriteFast( PIN_AMPLIFIER_ENABLE_C, LOW );
+
+	// Start every sequence at the reset step
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		GetInit( amp ).step		   = EnumsClass::AmplifierInitStepEnum::RESETTING;
+		GetInit( amp ).stepStartUs = initStartUs;
+	}
+
+	Serial.println( F( "AMPLIFIER:     System resetting...                     Started." ) );
 }
 
 
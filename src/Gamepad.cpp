@@ -248,8 +248,13 @@ void GamepadClass::MapButtonValues() {
 					combinedStateValue = lastStableState;
 					isNewStateReady	   = true;
 
+					// Queue the press
+					GamepadEventStruct Event;
+					Event.button = combinedStateValue;
+					Event.timeMs = millis();
+					Shared->Interface.Gamepad.Events.Push( Event );
+
 					// Update shared memory
-					Shared->Interface.Gamepad.isInputWaiting = true;
 					Shared->Interface.Gamepad.buttonPressed	 = combinedStateValue;
 					Shared->Interface.Gamepad.buttonName	 = combinedStateString;
 
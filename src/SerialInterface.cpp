@@ -1,5 +1,6 @@
 #include "SerialInterface.h"
 #include "SharedMemory.h"
+#include <cstdarg>	// Status line formatting
 
 
 
@@ -66,102 +67,139 @@ SerialInterfaceClass* SerialInterfaceClass::instance = nullptr;
 // === PUBLIC ACCESSORS ===========================================================================
 
 /**
- * @brief Print single-line status
+ * @brief Ask for a status line (tick job, interrupt context)
+ * 
+ * Only sets a flag: the line is rendered and written from loop(), so the
+ * tick never waits on USB.
+ */
+void OutputClass::RequestStatusLine() {
+	linesRequested++;
+	isStatusLineRequested = true;
+}
+
+
+/**
+ * @brief Render a requested status line and write as much of it as USB will take
+ * 
+ * Never blocks: each pass writes at most Serial.availableForWrite() bytes.
+ * A request that arrives while the previous line is still draining is
+ * dropped rather than queued, so a stalled host costs lines, not time.
  */
-void OutputClass::PrintStatusLine() {
+void OutputClass::Loop() {
+
+	// New request
+	if ( isStatusLineRequested ) {
+		isStatusLineRequested = false;
+		if ( statusSent < statusLength ) {
+			linesDropped++;
+		} else {
+			RenderStatusLine();
+		}
+	}
+
+	// Drain
+	if ( statusSent >= statusLength ) return;
+
+	int		 space	   = Serial.availableForWrite();
+	uint16_t remaining = statusLength - statusSent;
+	if ( space <= 0 ) return;
+
+	uint16_t count = ( uint16_t( space ) < remaining ) ? uint16_t( space ) : remaining;
+	statusSent += Serial.write( ( const uint8_t* )statusLine + statusSent, count );
+
+	if ( statusSent < statusLength ) {
+		partialWrites++;
+	} else {
+		linesWritten++;
+	}
+}
+
+
+/**
+ * @brief Append formatted text to the status line, truncating at the end of the buffer
+ */
+void OutputClass::AppendStatus( const char* format, ... ) {
+
+	// Keep room for the line ending
+	const uint16_t capacity = CONST_STATUS_LINE_SIZE - 2;
+	if ( statusLength >= capacity ) return;
+
+	va_list args;
+	va_start( args, format );
+	int written = vsnprintf( statusLine + statusLength, capacity - statusLength, format, args );
+	va_end( args );
+
+	if ( written > 0 ) statusLength = ( statusLength + written < capacity ) ? statusLength + written : capacity - 1;
+}
+
+
+/**
+ * @brief Render single-line status into the writer buffer
+ */
+void OutputClass::RenderStatusLine() {
 
 	// Shared Memory Alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
+	// Start a new line
+	statusLength = 0;
+	statusSent	 = 0;
+
 	// Placeholder
-	String tab = "    ";
+	const char* tab = "    ";
+
+	// Coherent copies of the latest tick (a failed read keeps the previous frame)
+	static SensorFrameStruct Sensors;
+	static DriveFrameStruct	 Drive;
+	Shared->Sensors.Snapshot.Read( Sensors );
+	Shared->Drive.Snapshot.Read( Drive );
 
 	// System state
-	Serial.print( F( "State: " ) );
-	Serial.print( Shared->Enumerators.MapSystemStateEnumToString( static_cast<int8_t>( Shared->State.systemState ) ) );
-	Serial.print( tab );
+	AppendStatus( "State: %s%s", Shared->Enumerators.MapSystemStateEnumToString( static_cast<int8_t>( Shared->State.systemState ) ).c_str(), tab );
 
 	// Serial connection
-	Serial.print( F( "Serial: " ) );
-	Serial.print( Shared->Interface.HWSerial.Connection.baudRateA );
-	Serial.print( F( " bps" ) );
-	Serial.print( tab );
+	AppendStatus( "Serial: %lu bps%s", ( unsigned long )Shared->Interface.HWSerial.Connection.baudRateA, tab );
 
 	// Safety switch
-	Serial.print( F( "Safety: " ) );
-	Serial.print( Shared->Drive.Flags.isSafetySwitchEngaged ? "Engaged" : "Off" );
-	Serial.print( tab );
+	AppendStatus( "Safety: %s%s", Shared->Drive.Flags.isSafetySwitchEngaged ? "Engaged" : "Off", tab );
 
 	// Motor output
-	Serial.print( F( "Output: " ) );
-	Serial.print( Shared->Drive.Flags.isMotorOutputEnabled ? "Enabled" : "Off" );
-	Serial.print( tab );
+	AppendStatus( "Output: %s%s", Shared->Drive.Flags.isMotorOutputEnabled ? "Enabled" : "Off", tab );
 
 	// Tension
-	Serial.print( F( "Tension: " ) );
 	if ( Shared->Drive.Tension.isEnabled ) {
-		Serial.print( F( "ON, Pwm = " ) );
-		Serial.print( Shared->Drive.Tension.valueInteger );
-		Serial.print( F( "%" ) );
+		AppendStatus( "Tension: ON, Pwm = %d%%%s", int( Shared->Drive.Tension.valueInteger ), tab );
 	} else {
-		Serial.print( F( "Off" ) );
+		AppendStatus( "Tension: Off%s", tab );
 	}
 
-	Serial.print( tab );
-
 	// Motor PWM
-	Serial.print( F( "PowerABC: " ) );
-	Serial.print( Shared->Drive.Pwm.totalOutgoingA );
-	Serial.print( F( " | " ) );
-	Serial.print( Shared->Drive.Pwm.totalOutgoingB );
-	Serial.print( F( " | " ) );
-	Serial.print( Shared->Drive.Pwm.totalOutgoingC );
-	Serial.print( tab );
+	AppendStatus( "PowerABC: %d | %d | %d%s", int( Drive.totalPwm[0] ), int( Drive.totalPwm[1] ), int( Drive.totalPwm[2] ), tab );
 
 	// Motor current
 	if ( Shared->Interface.SWSerial.Toggle.showMotorCurrents ) {
-
-		Serial.print( F( "Current: " ) );
-		Serial.print( Shared->Sensors.MotorCurrents.measuredCurrentAmpsA );
-		Serial.print( F( "A | " ) );
-		Serial.print( Shared->Sensors.MotorCurrents.measuredCurrentAmpsB );
-		Serial.print( F( "A | " ) );
-		Serial.print( Shared->Sensors.MotorCurrents.measuredCurrentAmpsC );
-		Serial.print( F( "A" ) );
-		Serial.print( tab );
+		AppendStatus( "Current: %.2fA | %.2fA | %.2fA%s", Sensors.currentAmps[0], Sensors.currentAmps[1], Sensors.currentAmps[2], tab );
 	}
 
 	// Motor angles in degrees
 	if ( Shared->Interface.SWSerial.Toggle.showMotorAngles ) {
-
-		Serial.print( F( "Motor Angles: " ) );
-		Serial.print( Shared->Sensors.MotorEncoders.measuredAngleDegA );
-		Serial.print( F( "° | " ) );
-		Serial.print( Shared->Sensors.MotorEncoders.measuredAngleDegB );
-		Serial.print( F( "° | " ) );
-		Serial.print( Shared->Sensors.MotorEncoders.measuredAngleDegC );
-		Serial.print( F( "°" ) );
+		AppendStatus( "Motor Angles: %.2f° | %.2f° | %.2f°", Sensors.MotorAngleDeg( 0 ), Sensors.MotorAngleDeg( 1 ), Sensors.MotorAngleDeg( 2 ) );
 	}
 
 	// Platform arm encoders in degrees
 	if ( Shared->Interface.SWSerial.Toggle.showPlatformEncoders ) {
-
-		Serial.print( F( "    " ) );
-		Serial.print( F( "ThetaXY: " ) );
-		Serial.print( Shared->Sensors.PlatformEncoders.horizontalAngleDegrees );
-		Serial.print( F( "° | " ) );
-		Serial.print( Shared->Sensors.PlatformEncoders.verticalAngleDegrees );
-		Serial.print( F( "°" ) );
-		Serial.print( tab );
+		AppendStatus( "%sThetaXY: %.2f° | %.2f°%s", tab, Sensors.platformHorizontalDeg, Sensors.platformVerticalDeg, tab );
 	}
 
 	// Active task
 	if ( Shared->State.systemState == EnumsClass::SystemStateEnum::RUNNING_TASK ) {
-
-		Serial.print( F( "Task: " ) );
-		Serial.print( Shared->Enumerators.MapTaskSelectionEnumToString( static_cast<int8_t>( Shared->Tasks.activeTask ) ) );
+		AppendStatus( "Task: %s", Shared->Enumerators.MapTaskSelectionEnumToString( static_cast<int8_t>( Shared->Tasks.activeTask ) ).c_str() );
 	}
 
+	// Line ending (room was kept for it)
+	statusLine[statusLength++] = '\r';
+	statusLine[statusLength++] = '\n';
+
 
 
 	// 	if ( SYSTEM_STATE == systemStateEnum::IDLE ) {
@@ -222,8 +260,6 @@ void OutputClass::PrintStatusLine() {
 	// 	Serial.print( F( " (" ) );
 	// 	Serial.print( gamepadString );
 	// 	Serial.print( F( ")" ) );
-
-	Serial.println();
 }
 
 
@@ -369,11 +405,74 @@ void InputClass::RespondToKeyboardInput() {
 			SetAmplifierOutputEnabled();
 		}
 
-		// Toggle amp limits
+		// Toggle encoder limits
 		if ( cmd == 'l' || cmd == 'L' ) {
+			SetEncoderLimitsEnabled();
+		}
+
+		// Print amplifier link statistics
+		if ( cmd == 'a' ) {
+			SetAmplifierLinkStatsPrint();
+		}
+
+		// Print periodic job timing
+		if ( cmd == 'i' ) {
+			SetTickSchedulerStatsPrint();
+		}
+
+		// Print the loop profile
+		if ( cmd == 'o' ) {
+			SetLoopProfilePrint();
+		}
+
+		// Toggle periodic loop profile logging
+		if ( cmd == 'O' ) {
+			SetLoopProfileLogEnabled();
+		}
+
+		// Toggle drive trace capture
+		if ( cmd == 'c' ) {
+			SetTraceCaptureEnabled();
+		}
+
+		// Toggle three-cable force allocation of the target heading and magnitude
+		if ( cmd == 'g' ) {
+			SetForceAllocationEnabled();
+		}
+
+		// Toggle closed-loop current trim
+		if ( cmd == 'K' ) {
+			SetClosedLoopEnabled();
+		}
+
+		// Set or print closed-loop gains
+		if ( cmd == 'k' ) {
+			SetControlGain();
+		}
 
-			// Respond_ToggleCurrentLimits();
-			// }
+		// Toggle position hold at the current encoder counts
+		if ( cmd == 'h' ) {
+			SetPositionHoldEnabled();
+		}
+
+		// Setpoint stream (push, end, start, stop, interpolation, generator)
+		if ( cmd == 'p' ) {
+			SetSetpointStream();
+		}
+
+		// Set or print the prompt cue profile
+		if ( cmd == 'q' ) {
+			SetCueProfile();
+		}
+
+		// Slew / jerk limiter
+		if ( cmd == 'w' ) {
+			SetSlewLimit();
+		}
+
+		// Range-of-motion map (record, limits, clamp, print)
+		if ( cmd == 'r' ) {
+			SetRomMap();
 		}
 
 		// Cancel all tasks and return to idle
@@ -381,6 +480,8 @@ void InputClass::RespondToKeyboardInput() {
 
 			Shared->State.systemState = EnumsClass::SystemStateEnum::IDLE;
 			Shared->Tasks.activeTask  = EnumsClass::TaskSelectionEnum::NONE;
+			Shared->Drive.Cue.isArmed = false;
+			if ( Shared->Sensors.MotorEncoders.Limits.isBeingTested ) Shared->ActionQueue.stopRomSweep = true;
 			Serial.println( F( "   >> Cancelling all tasks and returning to idle." ) );
 		}
 
@@ -449,6 +550,533 @@ void InputClass::SetAmplifierOutputEnabled() {
 	Serial.println( F( "   >> Toggling motor output." ) );
 }
 
+/**
+ * @brief Print amplifier link statistics
+ * 
+ */
+void InputClass::SetAmplifierLinkStatsPrint() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update action queue
+	Shared->ActionQueue.printAmplifierLinkStats = true;
+
+	// Debug text
+	Serial.println( F( "   >> Printing amplifier link statistics." ) );
+}
+
+/**
+ * @brief Print periodic job timing
+ * 
+ */
+void InputClass::SetTickSchedulerStatsPrint() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update action queue
+	Shared->ActionQueue.printTickSchedulerStats = true;
+
+	// Debug text
+	Serial.println( F( "   >> Printing periodic job timing." ) );
+}
+
+/**
+ * @brief Print the loop profile
+ * 
+ */
+void InputClass::SetLoopProfilePrint() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update action queue
+	Shared->ActionQueue.printLoopProfile = true;
+
+	// Debug text
+	Serial.println( F( "   >> Printing loop profile." ) );
+}
+
+/**
+ * @brief Toggle writing the loop profile to the log every CONST_PROFILE_LOG_MS
+ * 
+ */
+void InputClass::SetLoopProfileLogEnabled() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update state
+	bool oldState									= Shared->Interface.SWSerial.isProfileLogEnabled;
+	Shared->Interface.SWSerial.isProfileLogEnabled = !oldState;
+
+	// Debug text
+	Serial.println( F( "   >> Toggling periodic loop profile log." ) );
+}
+
+/**
+ * @brief Toggle drive trace capture around discrimination prompts
+ * 
+ */
+void InputClass::SetTraceCaptureEnabled() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update state
+	bool oldState										 = Shared->Interface.HWSerial.isTraceCaptureEnabled;
+	Shared->Interface.HWSerial.isTraceCaptureEnabled = !oldState;
+
+	// Debug text
+	Serial.println( F( "   >> Toggling drive trace capture." ) );
+}
+
+/**
+ * @brief Toggle three-cable force allocation
+ * 
+ */
+void InputClass::SetForceAllocationEnabled() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update state
+	bool oldState										 = Shared->Drive.MappingClass.isForceAllocationEnabled;
+	Shared->Drive.MappingClass.isForceAllocationEnabled = !oldState;
+
+	// Debug text
+	Serial.println( F( "   >> Toggling three-cable force allocation." ) );
+}
+
+/**
+ * @brief Toggle the closed-loop current trim
+ * 
+ */
+void InputClass::SetClosedLoopEnabled() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update state
+	bool oldState							 = Shared->Drive.Control.isClosedLoopEnabled;
+	Shared->Drive.Control.isClosedLoopEnabled = !oldState;
+
+	// Debug text
+	Serial.println( F( "   >> Toggling closed-loop control." ) );
+}
+
+/**
+ * @brief Toggle position hold (takes effect while closed-loop control is on)
+ * 
+ */
+void InputClass::SetPositionHoldEnabled() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Update state
+	bool oldState							   = Shared->Drive.Control.isPositionHoldEnabled;
+	Shared->Drive.Control.isPositionHoldEnabled = !oldState;
+
+	// Debug text
+	Serial.println( F( "   >> Toggling position hold." ) );
+}
+
+/**
+ * @brief Set one closed-loop gain ("kp0.5", "ki40", "kP0.05", "kD0.001", "kl0.4") or print them all ("k")
+ * 
+ */
+void InputClass::SetControlGain() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	char  gain	= incomingSerialString.charAt( 1 );
+	float value = incomingSerialString.substring( 2 ).toFloat();
+
+	// Gain to change
+	float* target = nullptr;
+	if ( gain == 'p' ) target = &Shared->Drive.Control.currentKp;
+	if ( gain == 'i' ) target = &Shared->Drive.Control.currentKi;
+	if ( gain == 'P' ) target = &Shared->Drive.Control.positionKp;
+	if ( gain == 'D' ) target = &Shared->Drive.Control.positionKd;
+	if ( gain == 'l' ) target = &Shared->Drive.Control.trimLimitAmps;
+
+	if ( target ) {
+		if ( value >= 0.0f ) {
+			*target = value;
+		} else {
+			Serial.println( F( "   >> Gains must not be negative, ignoring command." ) );
+		}
+	} else if ( gain != '\0' ) {
+		Serial.println( F( "   >> Unknown gain, use p/i (current), P/D (position) or l (trim limit)." ) );
+	}
+
+	// Serial response
+	Serial.print( F( "   >> Gains: current Kp " ) );
+	Serial.print( Shared->Drive.Control.currentKp, 3 );
+	Serial.print( F( ", Ki " ) );
+	Serial.print( Shared->Drive.Control.currentKi, 3 );
+	Serial.print( F( ", position Kp " ) );
+	Serial.print( Shared->Drive.Control.positionKp, 5 );
+	Serial.print( F( ", Kd " ) );
+	Serial.print( Shared->Drive.Control.positionKd, 5 );
+	Serial.print( F( ", trim limit " ) );
+	Serial.print( Shared->Drive.Control.trimLimitAmps, 3 );
+	Serial.println( F( " A" ) );
+}
+
+/**
+ * @brief Setpoint stream commands
+ * 
+ * pp<us>,<heading>,<magnitude>   queue a polar setpoint (deg, %)
+ * pa<us>,<a>,<b>,<c>             queue a cable setpoint (%)
+ * pe                             end of stream (playback stops after the last setpoint)
+ * ps                             start playback
+ * px                             stop playback and clear the buffer
+ * pl / pc                        linear / cubic interpolation
+ * pg<heading>,<offset>,<amplitude>,<hz>,<ms>   generate a sine on the device
+ * p                              print stream status
+ */
+void InputClass::SetSetpointStream() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	SetpointStreamStruct& Stream = Shared->Drive.Stream;
+	char				  option = incomingSerialString.charAt( 1 );
+
+	// Queue a setpoint
+	if ( option == 'p' || option == 'a' ) {
+
+		SetpointFormatEnum format	 = ( option == 'p' ) ? SetpointFormatEnum::POLAR : SetpointFormatEnum::ABC;
+		uint8_t			   expected	 = ( option == 'p' ) ? 2 : 3;
+		int				   comma	 = incomingSerialString.indexOf( ',' );
+		float			   values[3] = { 0.0f, 0.0f, 0.0f };
+
+		if ( comma < 0 || !isdigit( incomingSerialString.charAt( 2 ) ) || ParseValues( incomingSerialString.substring( comma + 1 ), values, 3 ) != expected ) {
+			Serial.println( F( "   >> Invalid setpoint, expected pp<us>,<heading>,<magnitude> or pa<us>,<a>,<b>,<c>." ) );
+			return;
+		}
+
+		SetpointStruct newPoint;
+		newPoint.timeUs	  = strtoul( incomingSerialString.substring( 2, comma ).c_str(), nullptr, 10 );
+		newPoint.value[0] = values[0];
+		newPoint.value[1] = values[1];
+		newPoint.value[2] = values[2];
+
+		// Reply with the free space so the host can pace itself
+		if ( Stream.Push( format, newPoint ) ) {
+			Serial.print( F( "   >> Queued, free " ) );
+		} else {
+			Serial.print( F( "   >> Rejected (full, out of order, mixed format or ended), free " ) );
+		}
+		Serial.println( Stream.Free() );
+		return;
+	}
+
+	// End of stream
+	if ( option == 'e' ) {
+		Stream.isEndOfStream = true;
+		Serial.println( F( "   >> End of setpoint stream marked." ) );
+		return;
+	}
+
+	// Start playback
+	if ( option == 's' ) {
+		Stream.isStartRequested = true;
+		Serial.println( F( "   >> Starting setpoint playback." ) );
+		return;
+	}
+
+	// Stop playback and clear
+	if ( option == 'x' ) {
+		Stream.RequestStop();
+		Serial.println( F( "   >> Setpoint playback stopping, buffer cleared on the next output tick." ) );
+		return;
+	}
+
+	// Interpolation
+	if ( option == 'l' || option == 'c' ) {
+		Stream.interpolation = ( option == 'l' ) ? SetpointInterpolationEnum::LINEAR : SetpointInterpolationEnum::CUBIC;
+		Serial.println( ( option == 'l' ) ? F( "   >> Linear setpoint interpolation." ) : F( "   >> Cubic setpoint interpolation." ) );
+		return;
+	}
+
+	// Generate a sine on the device
+	if ( option == 'g' ) {
+
+		float values[5];
+		if ( ParseValues( incomingSerialString.substring( 2 ), values, 5 ) != 5 || values[3] <= 0.0f || values[4] <= 0.0f ) {
+			Serial.println( F( "   >> Invalid generator, expected pg<heading>,<offset>,<amplitude>,<hz>,<ms>." ) );
+			return;
+		}
+		Stream.ServiceStop();
+		if ( Stream.isPlaying || Stream.isClearPending ) {
+			Serial.println( F( "   >> Setpoint stream is playing, stop it first (px)." ) );
+			return;
+		}
+
+		Stream.Clear();
+		Stream.Generator.headingDeg		  = values[0];
+		Stream.Generator.offsetPercent	  = values[1];
+		Stream.Generator.amplitudePercent = values[2];
+		Stream.Generator.frequencyHz	  = values[3];
+		Stream.Generator.durationUs		  = uint32_t( values[4] * 1000.0f );
+		Stream.Generator.nextUs			  = 0;
+		Stream.Generator.isRunning		  = true;
+		Stream.ServiceGenerator();
+		Serial.println( F( "   >> Generating setpoints, start playback with ps." ) );
+		return;
+	}
+
+	PrintSetpointStream();
+}
+
+/**
+ * @brief Print setpoint stream status
+ * 
+ */
+void InputClass::PrintSetpointStream() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	SetpointStreamStruct& Stream = Shared->Drive.Stream;
+
+	Serial.print( F( "   >> Stream " ) );
+	Serial.print( Stream.isPlaying ? F( "playing" ) : F( "stopped" ) );
+	Serial.print( F( " at " ) );
+	Serial.print( Stream.latestUs );
+	Serial.print( F( " us, " ) );
+	Serial.print( Stream.format == SetpointFormatEnum::POLAR ? F( "polar" ) : F( "ABC" ) );
+	Serial.print( Stream.interpolation == SetpointInterpolationEnum::LINEAR ? F( ", linear" ) : F( ", cubic" ) );
+	Serial.print( Stream.isEndOfStream ? F( ", ended" ) : F( "" ) );
+	Serial.print( F( "  queued: " ) );
+	Serial.print( Stream.Count() );
+	Serial.print( F( "  played: " ) );
+	Serial.print( Stream.pointsPlayed );
+	Serial.print( F( "  underruns: " ) );
+	Serial.print( Stream.underrunEvents );
+	Serial.print( F( " (" ) );
+	Serial.print( Stream.underrunTicks );
+	Serial.print( F( " ticks)  rejected: " ) );
+	Serial.println( Stream.rejected );
+}
+
+/**
+ * @brief Set one cue parameter or print the profile ("q")
+ * 
+ * qm<%> magnitude, qu<ms> ramp up, qh<ms> hold, qd<ms> ramp down,
+ * qf<Hz> carrier frequency (0 = off), qa<%> carrier amplitude
+ */
+void InputClass::SetCueProfile() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	HapticCueProfileStruct& Profile = Shared->Tasks.DiscriminationTask.CueProfile;
+	HapticCueProfileStruct	updated = Profile;
+	char					option	= incomingSerialString.charAt( 1 );
+	float					value	= incomingSerialString.substring( 2 ).toFloat();
+
+	if ( option != '\0' && value < 0.0f ) {
+		Serial.println( F( "   >> Cue values must not be negative, ignoring command." ) );
+		return;
+	}
+
+	if ( option == 'm' ) updated.magnitudePercent = value;
+	if ( option == 'u' ) updated.rampUpMs = uint16_t( value );
+	if ( option == 'h' ) updated.holdMs = uint16_t( value );
+	if ( option == 'd' ) updated.rampDownMs = uint16_t( value );
+	if ( option == 'f' ) updated.carrierHz = value;
+	if ( option == 'a' ) updated.carrierPercent = value;
+
+	// Must fit in the cue table
+	if ( updated.LengthMs() == 0 || updated.LengthMs() > CONST_CUE_MAX_SAMPLES ) {
+		Serial.print( F( "   >> Cue must last 1 to " ) );
+		Serial.print( CONST_CUE_MAX_SAMPLES );
+		Serial.println( F( " ms, ignoring command." ) );
+		return;
+	}
+	Profile = updated;
+
+	// Serial response
+	Serial.print( F( "   >> Cue: " ) );
+	Serial.print( Profile.magnitudePercent, 1 );
+	Serial.print( F( "%, ramp " ) );
+	Serial.print( Profile.rampUpMs );
+	Serial.print( F( "/" ) );
+	Serial.print( Profile.holdMs );
+	Serial.print( F( "/" ) );
+	Serial.print( Profile.rampDownMs );
+	Serial.print( F( " ms, carrier " ) );
+	Serial.print( Profile.carrierHz, 1 );
+	Serial.print( F( " Hz at " ) );
+	Serial.print( Profile.carrierPercent, 1 );
+	Serial.println( F( "%" ) );
+}
+
+/**
+ * @brief Toggle encoder limit enforcement, reporting the session's overshoot when it ends
+ * 
+ */
+void InputClass::SetEncoderLimitsEnabled() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Check: limits must have been measured
+	if ( !Shared->Sensors.MotorEncoders.Limits.isSet ) {
+		Serial.println( F( "   >> Encoder limits have not been measured, ignoring command." ) );
+		return;
+	}
+
+	// Update state
+	bool oldState								 = Shared->Sensors.MotorEncoders.Limits.isEnabled;
+	Shared->Sensors.MotorEncoders.Limits.isEnabled = !oldState;
+
+	// Report the session that just ended
+	if ( oldState ) {
+		Shared->ActionQueue.printEncoderLimitSession = true;
+	}
+
+	// Debug text
+	Serial.println( F( "   >> Toggling encoder limits." ) );
+}
+
+/**
+ * @brief Slew limiter commands
+ * 
+ * w toggles the limiter, ws toggles S-curve ramps,
+ * wd<counts> sets the largest PWM change per tick,
+ * wa<counts> sets the largest change of that rate per tick
+ */
+void InputClass::SetSlewLimit() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	PWMClass& Pwm	 = Shared->Drive.Pwm;
+	char	  option = incomingSerialString.charAt( 1 );
+	float	  value	 = incomingSerialString.substring( 2 ).toFloat();
+
+	if ( option == '\0' ) {
+		Pwm.isSlewLimitEnabled = !Pwm.isSlewLimitEnabled;
+	} else if ( option == 's' ) {
+		Pwm.isSCurveEnabled = !Pwm.isSCurveEnabled;
+	} else if ( ( option == 'd' || option == 'a' ) && value > 0.0f ) {
+		if ( option == 'd' ) Pwm.slewMaxDelta = value;
+		if ( option == 'a' ) Pwm.slewMaxAccel = value;
+	} else {
+		Serial.println( F( "   >> Invalid slew command, use w, ws, wd<counts> or wa<counts> (positive values)." ) );
+		return;
+	}
+
+	// Serial response
+	Serial.print( F( "   >> Slew limit " ) );
+	Serial.print( Pwm.isSlewLimitEnabled ? F( "on" ) : F( "off" ) );
+	Serial.print( Pwm.isSCurveEnabled ? F( " (S-curve)" ) : F( "" ) );
+	Serial.print( F( ", max " ) );
+	Serial.print( Pwm.slewMaxDelta, 1 );
+	Serial.print( F( " counts/tick, rate change " ) );
+	Serial.print( Pwm.slewMaxAccel, 1 );
+	Serial.println( F( " counts/tick^2" ) );
+}
+
+/**
+ * @brief Range-of-motion map commands
+ * 
+ * r starts or finishes (and saves) a guided map recording, rl starts or
+ * stops measuring the per-motor encoder limits the recording checks against,
+ * rs starts or stops the automated limit sweep (which sets both),
+ * rm toggles clamping commands to the map, rp prints the map
+ */
+void InputClass::SetRomMap() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	EncoderLimitsClass& Limits = Shared->Sensors.MotorEncoders.Limits;
+	char				option = incomingSerialString.length() > 1 ? incomingSerialString.charAt( 1 ) : ' ';
+
+	// Automated limit sweep
+	if ( option == 's' ) {
+		if ( Limits.isBeingTested ) {
+			Shared->ActionQueue.stopRomSweep = true;
+			Serial.println( F( "   >> Stopping limit sweep." ) );
+		} else {
+			Shared->ActionQueue.startRomSweep = true;
+			Serial.println( F( "   >> Starting limit sweep." ) );
+		}
+		return;
+	}
+
+	// Per-motor encoder limits
+	if ( option == 'l' ) {
+		if ( Limits.isBeingMeasured ) {
+			Shared->ActionQueue.stopMeasuringLimits = true;
+			Serial.println( F( "   >> Finishing encoder limit measurement." ) );
+		} else {
+			Shared->ActionQueue.startMeasuringLimits = true;
+			Serial.println( F( "   >> Measuring encoder limits, move each motor through its range." ) );
+		}
+		return;
+	}
+
+	// Clamp commands to the map
+	if ( option == 'm' ) {
+		if ( !Limits.isMapSet ) {
+			Serial.println( F( "   >> Heading map has not been recorded, ignoring command." ) );
+			return;
+		}
+		Limits.isMapEnabled = !Limits.isMapEnabled;
+		Serial.print( F( "   >> Heading map clamp " ) );
+		Serial.println( Limits.isMapEnabled ? F( "enabled." ) : F( "disabled." ) );
+		return;
+	}
+
+	// Print
+	if ( option == 'p' ) {
+		Shared->ActionQueue.printRomMap = true;
+		return;
+	}
+
+	// Start or finish a recording
+	if ( Limits.isMapBeingRecorded ) {
+		Shared->ActionQueue.finishRomMap = true;
+		Serial.println( F( "   >> Finishing heading map recording." ) );
+		return;
+	}
+	if ( !Limits.isSet ) {
+		Serial.println( F( "   >> Encoder limits have not been measured, ignoring command." ) );
+		return;
+	}
+	Shared->ActionQueue.startRomMap = true;
+	Serial.println( F( "   >> Recording heading map, sweep every heading up to the limits." ) );
+}
+
+/**
+ * @brief Parse comma-separated numbers
+ * 
+ * @return Number of values found
+ */
+uint8_t InputClass::ParseValues( const String& text, float* values, uint8_t maxValues ) {
+
+	uint8_t count = 0;
+	int		start = 0;
+
+	while ( count < maxValues && start < int( text.length() ) ) {
+		int end = text.indexOf( ',', start );
+		if ( end < 0 ) end = text.length();
+		values[count++] = text.substring( start, end ).toFloat();
+		start			= end + 1;
+	}
+
+	return count;
+}
+
 /**
  * @brief Zero platform encoders
  * 
@@ -564,6 +1192,12 @@ void InputClass::SetDiscriminationTaskCardinalStart() {
 		// Make sure tension is limited to 20 percent
 		if ( nReps > 0 && nReps <= 10 ) {
 
+			// The sweep owns the output until it ends, so cues would never start
+			if ( Shared->Sensors.MotorEncoders.Limits.isBeingTested ) {
+				Serial.println( F( "   >> Limit sweep is running, stop it first." ) );
+				return;
+			}
+
 			// Store value
 			Shared->Tasks.DiscriminationTask.CardinalDirections.nRepetitions = nReps;
 
@@ -604,6 +1238,12 @@ void InputClass::SetDiscriminationTaskOctantStart() {
 		// Make sure tension is limited to 20 percent
 		if ( nReps > 0 && nReps <= 10 ) {
 
+			// The sweep owns the output until it ends, so cues would never start
+			if ( Shared->Sensors.MotorEncoders.Limits.isBeingTested ) {
+				Serial.println( F( "   >> Limit sweep is running, stop it first." ) );
+				return;
+			}
+
 			// Store value
 			Shared->Tasks.DiscriminationTask.OctantDirections.nRepetitions = nReps;
 
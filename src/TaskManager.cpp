@@ -58,33 +58,66 @@ void CardinalDirectionsRuntimeClass::Loop() {
 			// Move state forward
 			Shared->Tasks.DiscriminationTask.CardinalDirections.currentState = EnumsClass::DiscriminationTaskStateEnum::WAITING_FOR_DELAY;
 
+			// Configure drive trace during the delay
+			Shared->ActionQueue.armTraceCapture = true;
+
 			// Start delay timer
 			timeDelayStartMs = millis();
+			timeDelayStartUs = micros();
+			isCueArmed		 = false;
 			break;
 		}
 
 		case EnumsClass::DiscriminationTaskStateEnum::WAITING_FOR_DELAY: {
 
-			// Check if delay time has elapsed
-			if ( millis() - timeDelayStartMs >= userResponses.at( currentTrialNumber ).promptDelayTimeMs ) {
+			// Precompute the cue while the delay runs, so it begins on the tick the delay ends
+			if ( !isCueArmed ) {
+				isCueArmed = true;
+				isCueReady = Shared->Drive.Cue.Synthesize( Shared->Tasks.DiscriminationTask.CueProfile, MapDirectionToHeadingDeg( userResponses.at( currentTrialNumber ).promptVal ) );
+				if ( isCueReady ) {
+					Shared->Drive.Cue.Arm( timeDelayStartUs + userResponses.at( currentTrialNumber ).promptDelayTimeMs * 1000 );
+				} else {
+					Serial.print( F( "(no cue) " ) );
+				}
+			}
+
+			// Prompt begins at cue onset (or once the delay has elapsed without a cue)
+			bool isPromptDue = isCueReady ? bool( Shared->Drive.Cue.hasStarted ) : ( millis() - timeDelayStartMs >= userResponses.at( currentTrialNumber ).promptDelayTimeMs );
+
+			// Cue held back past its onset (another path owns the output), fall back to the delay
+			if ( isCueReady && !isPromptDue && int32_t( micros() - Shared->Drive.Cue.onsetTargetUs ) >= int32_t( CONST_CUE_ONSET_GRACE_US ) ) {
+				isCueReady	= !Shared->Drive.Cue.Cancel();
+				isPromptDue = true;
+				if ( !isCueReady ) Serial.print( F( "(cue missed) " ) );
+			}
+			if ( isPromptDue ) {
 
 				// Move to rendering prompt state
 				Shared->Tasks.DiscriminationTask.CardinalDirections.currentState = EnumsClass::DiscriminationTaskStateEnum::RENDERING_PROMPT;
 
 				// Record prompt start time
 				timePromptStartMs = millis();
+
+				// Record cue onset to the microsecond
+				userResponses.at( currentTrialNumber ).cueOnsetUs = isCueReady ? Shared->Drive.Cue.onsetUs : micros();
+
+				// Capture drive trace from prompt onset
+				Shared->ActionQueue.triggerTraceCapture = true;
 			}
 			break;
 		}
 
 		case EnumsClass::DiscriminationTaskStateEnum::RENDERING_PROMPT: {
 
-			// Clear button pressed flag
-			Shared->Interface.Gamepad.isInputWaiting = false;
+			// Discard presses made before the prompt
+			Shared->Interface.Gamepad.Events.Clear();
 
-			// Print prompt for now
+			// Print prompt (the cue itself is already playing from the output ISR)
 			Serial.print( F( "Prompt: " ) );
 			Serial.print( userResponses.at( currentTrialNumber ).promptString );
+			Serial.print( F( " at " ) );
+			Serial.print( userResponses.at( currentTrialNumber ).cueOnsetUs );
+			Serial.print( F( " us" ) );
 
 			// Move to waiting for response state
 			Shared->Tasks.DiscriminationTask.CardinalDirections.currentState = EnumsClass::DiscriminationTaskStateEnum::WAITING_FOR_RESPONSE;
@@ -98,21 +131,19 @@ void CardinalDirectionsRuntimeClass::Loop() {
 		case EnumsClass::DiscriminationTaskStateEnum::WAITING_FOR_RESPONSE: {
 
 			// Check if response has been entered
-			if ( Shared->Interface.Gamepad.isInputWaiting ) {
+			GamepadEventStruct Response;
+			if ( Shared->Interface.Gamepad.Events.Pop( Response ) ) {
 
-				// Record response time
-				userResponses.at( currentTrialNumber ).responseTimeMs = millis() - timePromptStartMs;
+				// Record response time (from the press, not from when it was read)
+				userResponses.at( currentTrialNumber ).responseTimeMs = Response.timeMs - timePromptStartMs;
 
 				// Record response value
-				userResponses.at( currentTrialNumber ).responseVal	  = Shared->Interface.Gamepad.buttonPressed;
-				userResponses.at( currentTrialNumber ).responseString = Shared->Enumerators.MapDiscriminationDirectionsToString( Shared->Interface.Gamepad.buttonPressed );
+				userResponses.at( currentTrialNumber ).responseVal	  = Response.button;
+				userResponses.at( currentTrialNumber ).responseString = Shared->Enumerators.MapDiscriminationDirectionsToString( Response.button );
 
 				// Check if response correct
 				userResponses.at( currentTrialNumber ).isResponseCorrect = ( userResponses.at( currentTrialNumber ).responseVal == userResponses.at( currentTrialNumber ).promptVal );
 
-				// Reset gamepad flag
-				Shared->Interface.Gamepad.isInputWaiting = false;
-
 				Serial.println( "\t\tResponse captured." );
 
 				// Move to next state
@@ -222,6 +253,7 @@ void CardinalDirectionsRuntimeClass::InitializeRandomCardinalPool( uint16_t nRep
 		entry.responseString	= "None";	 // Response string
 		entry.responseTimeMs	= 0;		 // Response time
 		entry.isResponseCorrect = false;	 // Default response
+		entry.cueOnsetUs		= 0;		 // Not yet presented
 	}
 
 	// Set current trial number
@@ -238,7 +270,7 @@ void CardinalDirectionsRuntimeClass::PrintCardinalDirectionTable() {
 	// Print heading
 	Serial.println();
 	Serial.println( F( "=== Cardinal Direction Responses ============================================" ) );
-	Serial.println( F( "Trial#\tPrompt\tDelayMs\t\tResponse\tTimeMs\tResult" ) );
+	Serial.println( F( "Trial#\tPrompt\tDelayMs\t\tResponse\tTimeMs\tResult\tOnsetUs" ) );
 
 	// Iterate over elements
 	for ( std::size_t e = 0; e < userResponses.size(); e++ ) {
@@ -258,6 +290,8 @@ void CardinalDirectionsRuntimeClass::PrintCardinalDirectionTable() {
 		Serial.print( userResponses.at( e ).responseTimeMs );
 		Serial.print( F( "\t" ) );
 		Serial.print( userResponses.at( e ).isResponseCorrect ? "CORRECT" : "WRONG" );
+		Serial.print( F( "\t" ) );
+		Serial.print( userResponses.at( e ).cueOnsetUs );
 		Serial.println();
 	}
 
@@ -321,33 +355,66 @@ void OctantDirectionsRuntimeClass::Loop() {
 			// Move state forward
 			Shared->Tasks.DiscriminationTask.OctantDirections.currentState = EnumsClass::DiscriminationTaskStateEnum::WAITING_FOR_DELAY;
 
+			// Configure drive trace during the delay
+			Shared->ActionQueue.armTraceCapture = true;
+
 			// Start delay timer
 			timeDelayStartMs = millis();
+			timeDelayStartUs = micros();
+			isCueArmed		 = false;
 			break;
 		}
 
 		case EnumsClass::DiscriminationTaskStateEnum::WAITING_FOR_DELAY: {
 
-			// Check if delay time has elapsed
-			if ( millis() - timeDelayStartMs >= userResponses.at( currentTrialNumber ).promptDelayTimeMs ) {
+			// Precompute the cue while the delay runs, so it begins on the tick the delay ends
+			if ( !isCueArmed ) {
+				isCueArmed = true;
+				isCueReady = Shared->Drive.Cue.Synthesize( Shared->Tasks.DiscriminationTask.CueProfile, MapDirectionToHeadingDeg( userResponses.at( currentTrialNumber ).promptVal ) );
+				if ( isCueReady ) {
+					Shared->Drive.Cue.Arm( timeDelayStartUs + userResponses.at( currentTrialNumber ).promptDelayTimeMs * 1000 );
+				} else {
+					Serial.print( F( "(no cue) " ) );
+				}
+			}
+
+			// Prompt begins at cue onset (or once the delay has elapsed without a cue)
+			bool isPromptDue = isCueReady ? bool( Shared->Drive.Cue.hasStarted ) : ( millis() - timeDelayStartMs >= userResponses.at( currentTrialNumber ).promptDelayTimeMs );
+
+			// Cue held back past its onset (another path owns the output), fall back to the delay
+			if ( isCueReady && !isPromptDue && int32_t( micros() - Shared->Drive.Cue.onsetTargetUs ) >= int32_t( CONST_CUE_ONSET_GRACE_US ) ) {
+				isCueReady	= !Shared->Drive.Cue.Cancel();
+				isPromptDue = true;
+				if ( !isCueReady ) Serial.print( F( "(cue missed) " ) );
+			}
+			if ( isPromptDue ) {
 
 				// Move to rendering prompt state
 				Shared->Tasks.DiscriminationTask.OctantDirections.currentState = EnumsClass::DiscriminationTaskStateEnum::RENDERING_PROMPT;
 
 				// Record prompt start time
 				timePromptStartMs = millis();
+
+				// Record cue onset to the microsecond
+				userResponses.at( currentTrialNumber ).cueOnsetUs = isCueReady ? Shared->Drive.Cue.onsetUs : micros();
+
+				// Capture drive trace from prompt onset
+				Shared->ActionQueue.triggerTraceCapture = true;
 			}
 			break;
 		}
 
 		case EnumsClass::DiscriminationTaskStateEnum::RENDERING_PROMPT: {
 
-			// Clear button pressed flag
-			Shared->Interface.Gamepad.isInputWaiting = false;
+			// Discard presses made before the prompt
+			Shared->Interface.Gamepad.Events.Clear();
 
-			// Print prompt for now
+			// Print prompt (the cue itself is already playing from the output ISR)
 			Serial.print( F( "Prompt: " ) );
 			Serial.print( userResponses.at( currentTrialNumber ).promptString );
+			Serial.print( F( " at " ) );
+			Serial.print( userResponses.at( currentTrialNumber ).cueOnsetUs );
+			Serial.print( F( " us" ) );
 
 			// Move to waiting for response state
 			Shared->Tasks.DiscriminationTask.OctantDirections.currentState = EnumsClass::DiscriminationTaskStateEnum::WAITING_FOR_RESPONSE;
@@ -361,21 +428,19 @@ void OctantDirectionsRuntimeClass::Loop() {
 		case EnumsClass::DiscriminationTaskStateEnum::WAITING_FOR_RESPONSE: {
 
 			// Check if response has been entered
-			if ( Shared->Interface.Gamepad.isInputWaiting ) {
+			GamepadEventStruct Response;
+			if ( Shared->Interface.Gamepad.Events.Pop( Response ) ) {
 
-				// Record response time
-				userResponses.at( currentTrialNumber ).responseTimeMs = millis() - timeTotalTask;
+				// Record response time (from the press, not from when it was read)
+				userResponses.at( currentTrialNumber ).responseTimeMs = Response.timeMs - timeTotalTask;
 
 				// Record response value
-				userResponses.at( currentTrialNumber ).responseVal	  = Shared->Interface.Gamepad.buttonPressed;
-				userResponses.at( currentTrialNumber ).responseString = Shared->Enumerators.MapDiscriminationDirectionsToString( Shared->Interface.Gamepad.buttonPressed );
+				userResponses.at( currentTrialNumber ).responseVal	  = Response.button;
+				userResponses.at( currentTrialNumber ).responseString = Shared->Enumerators.MapDiscriminationDirectionsToString( Response.button );
 
 				// Check if response correct
 				userResponses.at( currentTrialNumber ).isResponseCorrect = ( userResponses.at( currentTrialNumber ).responseVal == userResponses.at( currentTrialNumber ).promptVal );
 
-				// Reset gamepad flag
-				Shared->Interface.Gamepad.isInputWaiting = false;
-
 				Serial.println( "\t\tResponse captured." );
 
 				// Move to next state
@@ -482,6 +547,7 @@ void OctantDirectionsRuntimeClass::InitializeRandomOctantPool( uint16_t nRepetit
 		entry.responseString	= "None";	 // Response string
 		entry.responseTimeMs	= 0;		 // Response time
 		entry.isResponseCorrect = false;	 // Default response
+		entry.cueOnsetUs		= 0;		 // Not yet presented
 	}
 
 	// Set current trial number
@@ -498,7 +564,7 @@ void OctantDirectionsRuntimeClass::PrintOctantDirectionTable() {
 	// Print heading
 	Serial.println();
 	Serial.println( F( "=== Octant Direction Responses ============================================" ) );
-	Serial.println( F( "Trial#\tPrompt\t\tDelayMs\t\tResponse\tTimeMs\tResult" ) );
+	Serial.println( F( "Trial#\tPrompt\t\tDelayMs\t\tResponse\tTimeMs\tResult\tOnsetUs" ) );
 
 	// Iterate over elements
 	for ( std::size_t e = 0; e < userResponses.size(); e++ ) {
@@ -518,6 +584,8 @@ void OctantDirectionsRuntimeClass::PrintOctantDirectionTable() {
 		Serial.print( userResponses.at( e ).responseTimeMs );
 		Serial.print( F( "\t" ) );
 		Serial.print( userResponses.at( e ).isResponseCorrect ? "CORRECT" : "WRONG" );
+		Serial.print( F( "\t" ) );
+		Serial.print( userResponses.at( e ).cueOnsetUs );
 		Serial.println();
 	}
 
@@ -21,6 +21,8 @@
 #include "SerialInterface.h"	// Keyboard serial input
 #include "SharedMemory.h"		// Shared memory management
 #include "TaskManager.h"		// Task manager
+#include "LoopProfiler.h"		// Cycle counts per subsystem
+#include "TickScheduler.h"		// Master tick and periodic jobs
 
 
 
@@ -31,24 +33,33 @@ ArmEncoderClass			ArmEncoders;		   // Read experimental platform encoders
 SerialInterfaceClass	SerialInterface;	   // Software serial I/O handling
 GamepadClass			Gamepad;			   // Read experimental platform gamepad
 TaskManagerRuntimeClass TaskManagerRuntime;	   // Task manager
+LoopProfilerStruct		LoopProfiler;		   // Cycle counts per subsystem and ISR
 
 
 
 // === INTERVAL TIMERS AND CALLBACKS ===========================================================
-IntervalTimer IT_ReadAmplifierSensorsTimer;
-IntervalTimer IT_AmplifierOutputTimer;
-IntervalTimer IT_DisplaySerialOutputTimer;	  // Serial scroll timer (2 hz)
+IntervalTimer		IT_TickTimer;				 // Master tick (CONST_TICK_HZ)
+IntervalTimer		IT_AmplifierReceiveTimer;	 // UART receive service (CONST_AMP_RX_SERVICE_HZ)
+TickSchedulerStruct TickScheduler;				 // Periodic jobs run from the master tick
 
-void ITCALLBACK_DisplaySerialOutput();	   // Prints the system serial scroll
-void ITCALLBACK_ReadAmplifierSensors();	   // Update the amplifer throught he interval timer
-void ITCALLBACK_AmplifierOutput();
+void ITCALLBACK_Tick();						 // Runs the due periodic jobs
+void ITCALLBACK_DisplaySerialOutput();		 // Prints the system serial scroll
+void ITCALLBACK_ReadAmplifierSensors();		 // Update the amplifer throught he interval timer
+void ITCALLBACK_ComputeAmplifierOutput();	 // Work out the raw PWM
+void ITCALLBACK_AmplifierOutput();			 // Write the PWM
+void ITCALLBACK_AmplifierReceive();			 // Parse amplifier responses independently of loop()
 
 // === Forward Declarations =======================================================================
 
 void ToggleGlobalFlags();		 // Collection of flags to toggle
 void ActionQueueManager();		 // Handles waiting actions
+void HandleAmplifierEvent( EnumsClass::AmplifierEventEnum event );	  // Handles an event queued outside loop()
 void RunSystemStateMachine();	 // System-wide State machine
 void RunTaskStateMachine();		 // Task-specific State machine
+void PrintTickSchedulerStats();	 // Print and clear the periodic job timing
+void PrintLoopProfile();		 // Print and clear the loop profile
+void PrintEventQueueStats( const char* label, uint32_t pushed, uint32_t dropped, uint16_t highWater );	  // One event ring on the scheduler report
+void LogLoopProfile();			 // Write the loop profile to the log
 
 // void CheckPeripherals();				   // Update all peripherals (spins every loop)
 // void CheckGamepadInput();				   // Parse gamepad inputs
@@ -97,9 +108,6 @@ void setup() {
 	// Start software serial port (over USB)
 	Serial.begin( 9600 );
 	while ( !Serial );	  // Waiting until serial connected
-
-	// Allow time for Serial interface to spin up
-	delay( 1000 );
 	Serial.println( "Initializing subsystems..." );
 
 	// Configure debug output
@@ -112,8 +120,8 @@ void setup() {
 	SerialInterface.Output.Begin();	   // Software serial interface for outputting text
 	SerialInterface.Input.Begin();	   // Software serial interface getting keyboard input
 
-	// Initialize amplifier
-	Amplifier.Begin();	  // Amplifier controls for BLDC
+	// Initialize amplifier (continues in the background from Amplifier.Loop())
+	Amplifier.Begin( EnumsClass::AmplifierProtocolEnum::ASCII );	// Amplifier controls for BLDC (BINARY for Copley binary sensor queries)
 
 	// Initialize platform encoders
 	ArmEncoders.Begin();	// Experimental platform encoders
@@ -121,13 +129,16 @@ void setup() {
 	// Initiasdalize gamepad
 	Gamepad.Begin();	// Experimental platform gamepad
 
-	// Start interval timers
-	IT_AmplifierOutputTimer.begin( ITCALLBACK_AmplifierOutput, 1000000 / 1000 );
-	IT_ReadAmplifierSensorsTimer.begin( ITCALLBACK_ReadAmplifierSensors, 1000000 / 300 );
-	IT_DisplaySerialOutputTimer.begin( ITCALLBACK_DisplaySerialOutput, 1000000 / 2 );
+	// Periodic jobs (name, job, phase, every n ticks, on tick, deadline after tick start [us])
+	TickScheduler.Begin( CONST_TICK_HZ );
+	TickScheduler.Add( "Sensors", ITCALLBACK_ReadAmplifierSensors, TickPhaseEnum::READ, 3, 0, 100 );				 // 333 Hz
+	TickScheduler.Add( "Compute", ITCALLBACK_ComputeAmplifierOutput, TickPhaseEnum::COMPUTE, 1, 0, 300 );		 // 1 kHz
+	TickScheduler.Add( "Actuate", ITCALLBACK_AmplifierOutput, TickPhaseEnum::ACTUATE, 1, 0, 400 );				 // 1 kHz
+	TickScheduler.Add( "Status", ITCALLBACK_DisplaySerialOutput, TickPhaseEnum::REPORT, CONST_TICK_HZ / 2, 1, 900 );	 // 2 Hz, off the sensor ticks
 
-	// Delay to clear everything
-	delay( 1000 );
+	// Start interval timers
+	IT_TickTimer.begin( ITCALLBACK_Tick, 1000000 / CONST_TICK_HZ );
+	IT_AmplifierReceiveTimer.begin( ITCALLBACK_AmplifierReceive, 1000000 / CONST_AMP_RX_SERVICE_HZ );
 
 	Serial.println( "ALL SYSTEMS NOMINAL." );
 	Serial.println();
@@ -147,23 +158,56 @@ void setup() {
  */
 void loop() {
 
+	ProfileScopeStruct loopProbe( LoopProfiler.Get( ProfileProbeEnum::LOOP ) );
+
+	// Loop length for the sample age report
+	Amplifier.RecordLoopStart();
+
 	// Run actions manager
-	ActionQueueManager();
+	{
+		ProfileScopeStruct probe( LoopProfiler.Get( ProfileProbeEnum::ACTIONS ) );
+		ActionQueueManager();
+	}
 
 	// Update arm encoders
-	ArmEncoders.Loop();
+	{
+		ProfileScopeStruct probe( LoopProfiler.Get( ProfileProbeEnum::ARM_ENCODERS ) );
+		ArmEncoders.Loop();
+	}
 
 	// Update amplifiers
-	Amplifier.Loop();
+	{
+		ProfileScopeStruct probe( LoopProfiler.Get( ProfileProbeEnum::AMPLIFIER ) );
+		Amplifier.Loop();
+	}
 
 	// Update gamepad
-	Gamepad.Loop();
+	{
+		ProfileScopeStruct probe( LoopProfiler.Get( ProfileProbeEnum::GAMEPAD ) );
+		Gamepad.Loop();
+	}
 
 	// Shared memory alias
 	static auto Shared = SYSTEM_GLOBAL.GetData();
 
 	// State machine
-	RunSystemStateMachine();
+	{
+		ProfileScopeStruct probe( LoopProfiler.Get( ProfileProbeEnum::STATE_MACHINE ) );
+		RunSystemStateMachine();
+	}
+
+	// Status line writer
+	{
+		ProfileScopeStruct probe( LoopProfiler.Get( ProfileProbeEnum::STATUS_WRITER ) );
+		SerialInterface.Output.Loop();
+	}
+
+	// Periodic profile log
+	if ( Shared->Interface.SWSerial.isProfileLogEnabled && micros() - LoopProfiler.lastLogUs >= CONST_PROFILE_LOG_MS * 1000 ) {
+		LoopProfiler.lastLogUs = micros();
+		LogLoopProfile();
+		LoopProfiler.ClearAll();	// One row per window
+	}
 
 
 	// Shared Memory Alias
@@ -296,7 +340,16 @@ void RunTaskStateMachine() {
 
 
 /**
- * @brief IntervalTimer callback to read amplifier encoders and current sensors
+ * @brief IntervalTimer callback for the master tick
+ */
+void ITCALLBACK_Tick() {
+	ProfileScopeStruct probe( LoopProfiler.Get( ProfileProbeEnum::TICK_ISR ) );
+	TickScheduler.Run();
+}
+
+
+/**
+ * @brief Tick job to read amplifier encoders and current sensors
  */
 void ITCALLBACK_ReadAmplifierSensors() {
 
@@ -306,15 +359,32 @@ void ITCALLBACK_ReadAmplifierSensors() {
 
 
 /**
- * @brief IntervalTimer callback to drive motor output
+ * @brief Tick job to work out the motor output
+ */
+void ITCALLBACK_ComputeAmplifierOutput() {
+	Amplifier.ComputeMotorOutputs();
+}
+
+
+/**
+ * @brief Tick job to drive motor output
  */
 void ITCALLBACK_AmplifierOutput() {
-	Amplifier.DriveMotorOutputs();
+	Amplifier.ActuateMotorOutputs();
+}
+
+
+/**
+ * @brief IntervalTimer callback to parse amplifier responses
+ */
+void ITCALLBACK_AmplifierReceive() {
+	ProfileScopeStruct probe( LoopProfiler.Get( ProfileProbeEnum::RECEIVE_ISR ) );
+	Amplifier.ServiceReceive();
 }
 
 
 /**
- * @brief IntervalTimer callback to show serial scroll
+ * @brief Tick job to show serial scroll
  */
 void ITCALLBACK_DisplaySerialOutput() {
 
@@ -324,8 +394,8 @@ void ITCALLBACK_DisplaySerialOutput() {
 	// Check if scrolling is enabled
 	if ( Shared->Interface.SWSerial.isScrollingLineEnabled ) {
 
-		// Print the scroll line
-		SerialInterface.Output.PrintStatusLine();
+		// Rendered and written from loop()
+		SerialInterface.Output.RequestStatusLine();
 	}
 }
 
@@ -402,4 +472,240 @@ void ActionQueueManager() {
 	if ( Shared->ActionQueue.zeroPlatformEncoders ) ArmEncoders.ZeroArmEncoders();	  // Zero encoders
 	if ( Shared->ActionQueue.zeroMotorEncoders ) Amplifier.ZeroMotorEncoders();		  // Zero motor encoders
 	if ( Shared->ActionQueue.setMotorTension ) Amplifier.SetTension();				  // Set tension
+	if ( Shared->ActionQueue.printAmplifierLinkStats ) Amplifier.PrintLinkStats();	  // Print amplifier link statistics
+	if ( Shared->ActionQueue.armTraceCapture ) Amplifier.ArmTraceCapture();			  // Configure drive trace
+	if ( Shared->ActionQueue.triggerTraceCapture ) Amplifier.TriggerTraceCapture();	  // Start drive trace
+	if ( Shared->ActionQueue.printEncoderLimitSession ) Amplifier.PrintEncoderLimitSession();	  // Report encoder limit overshoot
+	if ( Shared->ActionQueue.startMeasuringLimits ) Amplifier.StartMeasuringRangeOfMotionLimits();	  // Start recording per-motor encoder limits
+	if ( Shared->ActionQueue.stopMeasuringLimits ) Amplifier.StopMeasuringRangeOfMotionLimits();	  // Finish recording per-motor encoder limits
+	if ( Shared->ActionQueue.startRomMap ) Amplifier.StartRomMap();									  // Start recording the heading map
+	if ( Shared->ActionQueue.finishRomMap ) Amplifier.FinishRomMap();								  // Finish and store the heading map
+	if ( Shared->ActionQueue.printRomMap ) Amplifier.PrintRomMap();									  // Print the heading map
+	if ( Shared->ActionQueue.startRomSweep ) Amplifier.StartTestingRangeOfMotionLimits();			  // Start the automated limit sweep
+	if ( Shared->ActionQueue.stopRomSweep ) Amplifier.StopTestingRangeOfMotionLimits();				  // Abandon the automated limit sweep
+	if ( Shared->ActionQueue.printTickSchedulerStats ) PrintTickSchedulerStats();						  // Report periodic job timing
+	if ( Shared->ActionQueue.printLoopProfile ) PrintLoopProfile();										  // Report loop and ISR cycle counts
+
+	// Events raised outside loop()
+	EnumsClass::AmplifierEventEnum event;
+	while ( Shared->ActionQueue.TickEvents.Pop( event ) ) HandleAmplifierEvent( event );
+	while ( Shared->ActionQueue.ReceiveEvents.Pop( event ) ) HandleAmplifierEvent( event );
+}
+
+
+/**
+ * @brief Run the action for an event queued by an ISR or the receive path
+ */
+void HandleAmplifierEvent( EnumsClass::AmplifierEventEnum event ) {
+
+	switch ( event ) {
+		case EnumsClass::AmplifierEventEnum::LOG_TRACE_CAPTURE:
+			Amplifier.LogTraceCapture();	// Log uploaded drive trace
+			break;
+		case EnumsClass::AmplifierEventEnum::STOP_ROM_SWEEP:
+			Amplifier.StopTestingRangeOfMotionLimits();	   // Abandon the automated limit sweep
+			break;
+		case EnumsClass::AmplifierEventEnum::FINISH_ROM_SWEEP:
+			Amplifier.FinishRangeOfMotionSweep();	 // Apply the finished limit sweep
+			break;
+		case EnumsClass::AmplifierEventEnum::CURRENT_MODE_REJECTED_A:
+			Serial.println( F( "Amplifier A current command change failed!" ) );
+			break;
+		case EnumsClass::AmplifierEventEnum::CURRENT_MODE_REJECTED_B:
+			Serial.println( F( "Amplifier B current command change failed!" ) );
+			break;
+		case EnumsClass::AmplifierEventEnum::CURRENT_MODE_REJECTED_C:
+			Serial.println( F( "Amplifier C current command change failed!" ) );
+			break;
+	}
+}
+
+
+/**
+ * @brief Print one snapshot's copy cost and retry rate on a profiler line
+ */
+template <typename T>
+void PrintSnapshotStats( const char* label, const SnapshotStruct<T>& Snapshot, float cyclesPerUs ) {
+	Serial.print( F( "PROFILER:      " ) );
+	Serial.print( label );
+	Serial.print( F( "  published: " ) );
+	Serial.print( Snapshot.publishes );
+	Serial.print( F( "  reads: " ) );
+	Serial.print( Snapshot.reads );
+	Serial.print( F( "  retries: " ) );
+	Serial.print( Snapshot.retries );
+	Serial.print( F( " (" ) );
+	Serial.print( Snapshot.reads ? 100.0f * Snapshot.retries / Snapshot.reads : 0.0f, 3 );
+	Serial.print( F( " %)  failed: " ) );
+	Serial.print( Snapshot.failures );
+	Serial.print( F( "  read mean/max: " ) );
+	Serial.print( Snapshot.reads ? Snapshot.copyCyclesTotal / Snapshot.reads / cyclesPerUs : 0.0f, 2 );
+	Serial.print( F( "/" ) );
+	Serial.print( Snapshot.copyCyclesMax / cyclesPerUs, 2 );
+	Serial.print( F( " us  publish max: " ) );
+	Serial.print( Snapshot.publishCyclesMax / cyclesPerUs, 2 );
+	Serial.print( F( " us  frame: " ) );
+	Serial.print( sizeof( T ) );
+	Serial.println( F( " bytes" ) );
+}
+
+
+/**
+ * @brief Print the loop profile, write it to the log and start a new window
+ */
+void PrintLoopProfile() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.printLoopProfile );
+
+	const float cyclesPerUs = ProfilerCyclesPerUs();
+	uint32_t	nowUs		= ProfilerMicros();
+
+	for ( uint8_t i = 0; i < uint8_t( ProfileProbeEnum::COUNT ); i++ ) {
+
+		const ProfileProbeStruct& Probe		= LoopProfiler.Probe[i];
+		float					  windowSec = ( nowUs - Probe.windowStartUs ) / 1000000.0f;
+
+		Serial.print( F( "PROFILER:      " ) );
+		Serial.print( PROFILE_PROBE_NAMES[i] );
+		Serial.print( F( "  calls: " ) );
+		Serial.print( Probe.calls );
+		Serial.print( F( " (" ) );
+		Serial.print( windowSec > 0 ? Probe.calls / windowSec : 0.0f, 0 );
+		Serial.print( F( " Hz)  cycles min/mean/p99/max: " ) );
+		Serial.print( Probe.calls ? Probe.cyclesMin : 0 );
+		Serial.print( F( "/" ) );
+		Serial.print( Probe.calls ? uint32_t( Probe.cyclesTotal / Probe.calls ) : 0 );
+		Serial.print( F( "/" ) );
+		Serial.print( Probe.PercentileCycles( 99 ) );
+		Serial.print( F( "/" ) );
+		Serial.print( Probe.cyclesMax );
+		Serial.print( F( "  max " ) );
+		Serial.print( Probe.cyclesMax / cyclesPerUs, 1 );
+		Serial.println( F( " us" ) );
+	}
+
+	// Shared snapshots
+	PrintSnapshotStats( "SensorSnapshot", Shared->Sensors.Snapshot, cyclesPerUs );
+	PrintSnapshotStats( "DriveSnapshot", Shared->Drive.Snapshot, cyclesPerUs );
+	Shared->Sensors.Snapshot.ClearStats();
+	Shared->Drive.Snapshot.ClearStats();
+
+	LogLoopProfile();
+	LoopProfiler.ClearAll();
+}
+
+
+/**
+ * @brief Write the loop profile to the log, one row per probe
+ */
+void LogLoopProfile() {
+
+	uint32_t nowUs = ProfilerMicros();
+
+	Serial.println( F( "PROFILE,Time[us],Section,Calls,Rate[Hz],Min[cycles],Mean[cycles],P99[cycles],Max[cycles]" ) );
+
+	for ( uint8_t i = 0; i < uint8_t( ProfileProbeEnum::COUNT ); i++ ) {
+
+		const ProfileProbeStruct& Probe		= LoopProfiler.Probe[i];
+		float					  windowSec = ( nowUs - Probe.windowStartUs ) / 1000000.0f;
+
+		Serial.print( F( "PROFILE," ) );
+		Serial.print( nowUs );
+		Serial.print( F( "," ) );
+		Serial.print( PROFILE_PROBE_NAMES[i] );
+		Serial.print( F( "," ) );
+		Serial.print( Probe.calls );
+		Serial.print( F( "," ) );
+		Serial.print( windowSec > 0 ? Probe.calls / windowSec : 0.0f, 1 );
+		Serial.print( F( "," ) );
+		Serial.print( Probe.calls ? Probe.cyclesMin : 0 );
+		Serial.print( F( "," ) );
+		Serial.print( Probe.calls ? uint32_t( Probe.cyclesTotal / Probe.calls ) : 0 );
+		Serial.print( F( "," ) );
+		Serial.print( Probe.PercentileCycles( 99 ) );
+		Serial.print( F( "," ) );
+		Serial.println( Probe.cyclesMax );
+	}
+}
+
+
+/**
+ * @brief Print and clear the timing of every periodic job
+ */
+void PrintTickSchedulerStats() {
+
+	// Shared Memory Alias
+	static auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Reset action flag
+	SYSTEM_GLOBAL.ResetActionFlag( Shared->ActionQueue.printTickSchedulerStats );
+
+	const float cyclesPerUs = F_CPU_ACTUAL / 1000000.0f;
+	float		windowSec	= ( TickScheduler.tick - TickScheduler.statsStartTick ) / float( CONST_TICK_HZ );
+
+	Serial.print( F( "SCHEDULER:     " ) );
+	Serial.print( CONST_TICK_HZ );
+	Serial.print( F( " Hz tick over " ) );
+	Serial.print( windowSec, 1 );
+	Serial.print( F( " s, longest tick " ) );
+	Serial.print( TickScheduler.tickCyclesMax / cyclesPerUs, 1 );
+	Serial.print( F( " us, latest start " ) );
+	Serial.print( TickScheduler.startLateCyclesMax / cyclesPerUs, 1 );
+	Serial.print( F( " us, overruns: " ) );
+	Serial.println( TickScheduler.tickOverruns );
+
+	for ( uint8_t i = 0; i < TickScheduler.jobCount; i++ ) {
+
+		const TickJobStruct& Job = TickScheduler.job[i];
+
+		Serial.print( F( "SCHEDULER:     " ) );
+		Serial.print( Job.name );
+		Serial.print( F( "  runs: " ) );
+		Serial.print( Job.runs );
+		Serial.print( F( "  mean/max: " ) );
+		Serial.print( Job.runs ? Job.cyclesTotal / Job.runs / cyclesPerUs : 0.0f, 1 );
+		Serial.print( F( "/" ) );
+		Serial.print( Job.cyclesMax / cyclesPerUs, 1 );
+		Serial.print( F( " us  latest finish: " ) );
+		Serial.print( Job.finishMax / cyclesPerUs, 1 );
+		Serial.print( F( "/" ) );
+		Serial.print( Job.deadlineCycles / cyclesPerUs, 0 );
+		Serial.print( F( " us  overruns: " ) );
+		Serial.println( Job.overruns );
+	}
+
+	Serial.print( F( "SCHEDULER:     Status writer  requested: " ) );
+	Serial.print( SerialInterface.Output.linesRequested );
+	Serial.print( F( "  written: " ) );
+	Serial.print( SerialInterface.Output.linesWritten );
+	Serial.print( F( "  dropped: " ) );
+	Serial.print( SerialInterface.Output.linesDropped );
+	Serial.print( F( "  partial writes: " ) );
+	Serial.println( SerialInterface.Output.partialWrites );
+
+	// Event rings (totals since start)
+	PrintEventQueueStats( "Tick events    ", Shared->ActionQueue.TickEvents.pushed, Shared->ActionQueue.TickEvents.dropped, Shared->ActionQueue.TickEvents.highWater );
+	PrintEventQueueStats( "Receive events ", Shared->ActionQueue.ReceiveEvents.pushed, Shared->ActionQueue.ReceiveEvents.dropped, Shared->ActionQueue.ReceiveEvents.highWater );
+	PrintEventQueueStats( "Gamepad events ", Shared->Interface.Gamepad.Events.pushed, Shared->Interface.Gamepad.Events.dropped, Shared->Interface.Gamepad.Events.highWater );
+
+	TickScheduler.ClearStats();
+}
+
+
+/**
+ * @brief Print one event ring's counters on a scheduler line
+ */
+void PrintEventQueueStats( const char* label, uint32_t pushed, uint32_t dropped, uint16_t highWater ) {
+	Serial.print( F( "SCHEDULER:     " ) );
+	Serial.print( label );
+	Serial.print( F( " queued: " ) );
+	Serial.print( pushed );
+	Serial.print( F( "  dropped: " ) );
+	Serial.print( dropped );
+	Serial.print( F( "  most waiting: " ) );
+	Serial.println( highWater );
 }
\ No newline at end of file
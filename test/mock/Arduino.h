@@ -0,0 +1,416 @@
+/**
+ * @file Arduino.h
+ * @author Tomasz Trzpit
+ * @brief Host stand-in for the parts of the Teensy core the amplifier code uses
+ * @version 0.1
+ * @date 2025-10-06
+ *
+ * Only used by the native test build. Time moves only when a test advances
+ * it, pins are plain arrays, and each hardware serial port hands the bytes
+ * written to it to whatever device the test attached. The cycle counter is
+ * the exception: it follows the host clock, so costs the firmware measures
+ * in cycles are real host costs. Everything is inline so the test build
+ * needs no extra sources.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+
+typedef uint8_t byte;
+
+#define F( string_literal ) ( string_literal )
+#define HIGH				1
+#define LOW					0
+#define INPUT				0
+#define OUTPUT				1
+#define INPUT_PULLUP		2
+#define INPUT_PULLDOWN		3
+#define BIN					2
+#define DEC					10
+#define HEX					16
+#define PI					3.1415926535897932384626433832795
+#define DEG_TO_RAD			0.017453292519943295769236907684886
+#define RAD_TO_DEG			57.295779513082320876798154814105
+#define radians( deg )		( ( deg ) * DEG_TO_RAD )
+#define degrees( rad )		( ( rad ) * RAD_TO_DEG )
+#define constrain( amt, low, high ) ( ( amt ) < ( low ) ? ( low ) : ( ( amt ) > ( high ) ? ( high ) : ( amt ) ) )
+#define F_CPU_ACTUAL		600000000
+#define F_CPU				600000000
+
+
+// === TIME AND PINS ==============================================================================
+
+namespace MockArduino {
+
+const uint8_t CONST_PIN_COUNT = 64;	   // Teensy 4.1 pins (plus spares)
+
+inline uint32_t nowUs					= 0;	 // Simulated micros()
+inline uint8_t	pinLevel[CONST_PIN_COUNT] = {};	 // Last level written or set by the test
+inline uint8_t	pinMode[CONST_PIN_COUNT]  = {};	 // Last mode configured
+inline int		analogOut[CONST_PIN_COUNT] = {};	 // Last analogWrite() value
+
+inline void AdvanceUs( uint32_t us ) {
+	nowUs += us;
+}
+
+}	 // namespace MockArduino
+
+inline uint32_t micros() {
+	return MockArduino::nowUs;
+}
+
+inline uint32_t millis() {
+	return MockArduino::nowUs / 1000;
+}
+
+inline void delay( uint32_t ms ) {
+	MockArduino::nowUs += ms * 1000;
+}
+
+inline void delayMicroseconds( uint32_t us ) {
+	MockArduino::nowUs += us;
+}
+
+inline void yield() {}
+
+// Cycle counter follows the host clock (in Teensy cycles), so measured costs are real host costs
+#define ARM_DWT_CYCCNT ( uint32_t( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() * ( F_CPU_ACTUAL / 1000000 ) / 1000 ) )
+
+inline void pinMode( uint8_t pin, uint8_t mode ) {
+	MockArduino::pinMode[pin % MockArduino::CONST_PIN_COUNT] = mode;
+}
+
+inline void digitalWrite( uint8_t pin, uint8_t level ) {
+	MockArduino::pinLevel[pin % MockArduino::CONST_PIN_COUNT] = level ? HIGH : LOW;
+}
+
+inline void digitalWriteFast( uint8_t pin, uint8_t level ) {
+	digitalWrite( pin, level );
+}
+
+inline int digitalRead( uint8_t pin ) {
+	return MockArduino::pinLevel[pin % MockArduino::CONST_PIN_COUNT];
+}
+
+inline int digitalReadFast( uint8_t pin ) {
+	return digitalRead( pin );
+}
+
+inline void analogWrite( uint8_t pin, int value ) {
+	MockArduino::analogOut[pin % MockArduino::CONST_PIN_COUNT] = value;
+}
+
+inline int	analogRead( uint8_t ) { return 0; }
+inline void analogWriteResolution( uint8_t ) {}
+inline void analogWriteFrequency( uint8_t, float ) {}
+inline void analogReadResolution( uint8_t ) {}
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+
+
+// === STRING =====================================================================================
+
+/**
+ * @brief Arduino String over std::string (short strings stay off the heap, unlike the real one)
+ */
+class String : public std::string {
+
+	public:
+	String() {}
+	String( const char* text ) : std::string( text ) {}
+	String( const std::string& text ) : std::string( text ) {}
+	String( char c ) : std::string( 1, c ) {}
+	String( int value ) : std::string( std::to_string( value ) ) {}
+	String( unsigned int value ) : std::string( std::to_string( value ) ) {}
+	String( long value ) : std::string( std::to_string( value ) ) {}
+	String( unsigned long value ) : std::string( std::to_string( value ) ) {}
+	String( double value, int digits = 2 ) {
+		char text[32];
+		snprintf( text, sizeof( text ), "%.*f", digits, value );
+		assign( text );
+	}
+
+	unsigned int length() const { return unsigned( size() ); }
+	char		 charAt( unsigned int index ) const { return index < size() ? ( *this )[index] : 0; }
+	String		 substring( unsigned int from ) const { return from < size() ? String( substr( from ) ) : String(); }
+	String		 substring( unsigned int from, unsigned int to ) const { return from < size() ? String( substr( from, to - from ) ) : String(); }
+	long		 toInt() const { return atol( c_str() ); }
+	float		 toFloat() const { return float( atof( c_str() ) ); }
+	int			 indexOf( char c ) const { return indexOf( c, 0 ); }
+	int			 indexOf( char c, unsigned int from ) const {
+		size_t position = find( c, from );
+		return position == npos ? -1 : int( position );
+	}
+	bool equals( const String& other ) const { return *this == other; }
+	bool startsWith( const String& prefix ) const { return rfind( prefix, 0 ) == 0; }
+	void remove( unsigned int index ) {
+		if ( index < size() ) erase( index );
+	}
+	void remove( unsigned int index, unsigned int count ) {
+		if ( index < size() ) erase( index, count );
+	}
+	void trim() {
+		size_t first = find_first_not_of( " \t\r\n" );
+		size_t last	 = find_last_not_of( " \t\r\n" );
+		assign( first == npos ? std::string() : substr( first, last - first + 1 ) );
+	}
+	void toCharArray( char* destination, unsigned int size ) const {
+		strncpy( destination, c_str(), size );
+		if ( size > 0 ) destination[size - 1] = 0;
+	}
+
+	String& operator+=( const String& other ) {
+		append( other );
+		return *this;
+	}
+	String& operator+=( const char* other ) {
+		append( other );
+		return *this;
+	}
+	String& operator+=( char c ) {
+		push_back( c );
+		return *this;
+	}
+	String& operator+=( int value ) {
+		append( std::to_string( value ) );
+		return *this;
+	}
+	String& operator+=( unsigned int value ) {
+		append( std::to_string( value ) );
+		return *this;
+	}
+	String& operator+=( long value ) {
+		append( std::to_string( value ) );
+		return *this;
+	}
+	String& operator+=( unsigned long value ) {
+		append( std::to_string( value ) );
+		return *this;
+	}
+	String& operator+=( double value ) {
+		append( String( value ) );
+		return *this;
+	}
+};
+
+inline String operator+( const String& a, const String& b ) {
+	return String( std::string( a ) + std::string( b ) );
+}
+
+inline String operator+( const String& a, const char* b ) {
+	return String( std::string( a ) + b );
+}
+
+inline String operator+( const char* a, const String& b ) {
+	return String( a + std::string( b ) );
+}
+
+
+// === PRINT AND STREAMS ==========================================================================
+
+/**
+ * @brief Formatting on top of a byte sink, without allocating
+ */
+class Print {
+
+	public:
+	virtual ~Print() = default;
+	virtual size_t write( uint8_t c ) = 0;
+
+	size_t write( const uint8_t* buffer, size_t size ) {
+		for ( size_t i = 0; i < size; i++ ) write( buffer[i] );
+		return size;
+	}
+	size_t write( const char* buffer, size_t size ) {
+		return write( reinterpret_cast<const uint8_t*>( buffer ), size );
+	}
+
+	size_t print( const char* text ) { return write( text, strlen( text ) ); }
+	size_t print( const String& text ) { return write( text.c_str(), text.size() ); }
+	size_t print( char c ) { return write( uint8_t( c ) ); }
+	size_t print( unsigned char value, int base = DEC ) { return PrintUnsigned( value, base ); }
+	size_t print( int value, int base = DEC ) { return PrintSigned( value, base ); }
+	size_t print( unsigned int value, int base = DEC ) { return PrintUnsigned( value, base ); }
+	size_t print( long value, int base = DEC ) { return PrintSigned( value, base ); }
+	size_t print( unsigned long value, int base = DEC ) { return PrintUnsigned( value, base ); }
+	size_t print( long long value, int base = DEC ) { return PrintSigned( value, base ); }
+	size_t print( unsigned long long value, int base = DEC ) { return PrintUnsigned( value, base ); }
+	size_t print( double value, int digits = 2 ) {
+		char text[48];
+		int	 length = snprintf( text, sizeof( text ), "%.*f", digits, value );
+		return write( text, size_t( std::clamp( length, 0, int( sizeof( text ) - 1 ) ) ) );
+	}
+
+	size_t println() { return print( "\r\n" ); }
+	template <typename T>
+	size_t println( const T& value ) {
+		size_t n = print( value );
+		return n + println();
+	}
+	template <typename T>
+	size_t println( const T& value, int format ) {
+		size_t n = print( value, format );
+		return n + println();
+	}
+
+	int printf( const char* format, ... ) {
+		char	text[256];
+		va_list args;
+		va_start( args, format );
+		int length = vsnprintf( text, sizeof( text ), format, args );
+		va_end( args );
+		return int( write( text, size_t( std::clamp( length, 0, int( sizeof( text ) - 1 ) ) ) ) );
+	}
+
+	virtual int	 availableForWrite() { return 64; }
+	virtual void flush() {}
+
+	private:
+	size_t PrintUnsigned( unsigned long long value, int base ) {
+		char  text[66];
+		char* end = text + sizeof( text );
+		char* c	  = end;
+		if ( base < 2 ) base = DEC;
+		do {
+			unsigned digit = unsigned( value % base );
+			*--c		   = char( digit < 10 ? '0' + digit : 'A' + digit - 10 );
+			value /= base;
+		} while ( value > 0 );
+		return write( c, size_t( end - c ) );
+	}
+	size_t PrintSigned( long long value, int base ) {
+		if ( value < 0 && base == DEC ) return print( '-' ) + PrintUnsigned( 0ULL - static_cast<unsigned long long>( value ), base );
+		return PrintUnsigned( static_cast<unsigned long long>( value ), base );
+	}
+};
+
+
+class Stream : public Print {
+
+	public:
+	virtual int available() { return 0; }
+	virtual int read() { return -1; }
+	virtual int peek() { return -1; }
+};
+
+
+/**
+ * @brief USB serial, keeps what was printed for the test to inspect
+ */
+class usb_serial_class : public Stream {
+
+	public:
+	static const size_t CONST_CAPTURE_SIZE = 16384;	   // Output kept (the rest is only counted)
+
+	uint64_t bytesWritten = 0;		  // Everything ever printed
+	size_t	 captured	  = 0;		  // Bytes held in text
+	char	 text[CONST_CAPTURE_SIZE + 1] = {};	   // Start of the output since the last ClearOutput()
+	bool	 isEcho		  = false;	  // Also copy to stdout
+
+	void begin( uint32_t ) {}
+	explicit operator bool() const { return true; }
+
+	using Print::write;
+	size_t write( uint8_t c ) override {
+		bytesWritten++;
+		if ( captured < CONST_CAPTURE_SIZE ) text[captured++] = char( c );
+		if ( isEcho ) fputc( c, stdout );
+		return 1;
+	}
+
+	void ClearOutput() {
+		captured = 0;
+		memset( text, 0, sizeof( text ) );
+	}
+};
+
+
+/**
+ * @brief Far end of a hardware serial port (a simulated amplifier)
+ */
+class MockSerialDevice {
+
+	public:
+	virtual ~MockSerialDevice()								   = default;
+	virtual void OnHostByte( uint8_t c, uint32_t hostBaud ) = 0;	// Byte written by the firmware at hostBaud
+};
+
+
+/**
+ * @brief Hardware UART, with a receive buffer the attached device fills
+ */
+class HardwareSerial : public Stream {
+
+	public:
+	static const uint16_t CONST_RX_SIZE = 1024;	   // Receive buffer (power of two)
+
+	MockSerialDevice* device   = nullptr;	 // Far end
+	uint32_t		  baudRate = 0;			 // Rate the port was opened at
+	bool			  isOpen   = false;		 // Between begin() and end()
+	uint32_t		  bytesSent	   = 0;		 // Bytes written by the firmware
+	uint32_t		  bytesDelivered = 0;	 // Bytes received from the device
+	uint32_t		  overruns	   = 0;		 // Bytes lost to a full receive buffer
+
+	void begin( uint32_t baud, uint16_t = 0 ) {
+		baudRate = baud;
+		isOpen	 = true;
+	}
+	void end() {
+		isOpen = false;
+		rxTail = rxHead;
+	}
+	void clear() { rxTail = rxHead; }
+	void addMemoryForRead( void*, size_t ) {}
+	void addMemoryForWrite( void*, size_t ) {}
+
+	int available() override { return int( rxHead - rxTail ); }
+	int read() override { return rxHead == rxTail ? -1 : rx[rxTail++ & ( CONST_RX_SIZE - 1 )]; }
+	int peek() override { return rxHead == rxTail ? -1 : rx[rxTail & ( CONST_RX_SIZE - 1 )]; }
+
+	using Print::write;
+	size_t write( uint8_t c ) override {
+		bytesSent++;
+		if ( isOpen && device ) device->OnHostByte( c, baudRate );
+		return 1;
+	}
+
+	// Device side: a byte arrives on the wire
+	void Deliver( uint8_t c ) {
+		if ( !isOpen ) return;
+		if ( rxHead - rxTail >= CONST_RX_SIZE ) {
+			overruns++;
+			return;
+		}
+		rx[rxHead++ & ( CONST_RX_SIZE - 1 )] = c;
+		bytesDelivered++;
+	}
+
+	private:
+	uint8_t	 rx[CONST_RX_SIZE] = {};	// Receive ring
+	uint32_t rxHead			   = 0;		// Next slot written by Deliver()
+	uint32_t rxTail			   = 0;		// Next slot read by the firmware
+};
+
+
+inline usb_serial_class Serial;
+inline usb_serial_class SerialUSB1;
+inline usb_serial_class SerialUSB2;
+inline HardwareSerial	Serial1;
+inline HardwareSerial	Serial2;
+inline HardwareSerial	Serial3;
+inline HardwareSerial	Serial4;
+inline HardwareSerial	Serial5;
+inline HardwareSerial	Serial6;
+inline HardwareSerial	Serial7;
+inline HardwareSerial	Serial8;
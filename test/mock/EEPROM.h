@@ -0,0 +1,43 @@
+/**
+ * @file EEPROM.h
+ * @author Tomasz Trzpit
+ * @brief Host stand-in for the Teensy EEPROM emulation (erased at start, lost at exit)
+ * @version 0.1
+ * @date 2025-10-06
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+
+class EEPROMClass {
+
+	public:
+	static const uint16_t CONST_EEPROM_SIZE = 4284;	   // Teensy 4.1 emulated EEPROM
+
+	EEPROMClass() { memset( data, 0xFF, sizeof( data ) ); }
+
+	template <typename T>
+	T& get( int address, T& value ) {
+		memcpy( &value, data + address, sizeof( T ) );
+		return value;
+	}
+
+	template <typename T>
+	const T& put( int address, const T& value ) {
+		memcpy( data + address, &value, sizeof( T ) );
+		return value;
+	}
+
+	uint8_t read( int address ) { return data[address]; }
+	void	write( int address, uint8_t value ) { data[address] = value; }
+	void	update( int address, uint8_t value ) { data[address] = value; }
+	uint16_t length() { return CONST_EEPROM_SIZE; }
+
+	private:
+	uint8_t data[CONST_EEPROM_SIZE];
+};
+
+inline EEPROMClass EEPROM;
@@ -0,0 +1,523 @@
+/**
+ * @file SimulatedAmp.h
+ * @author Tomasz Trzpit
+ * @brief Stand-in Copley amplifier on a mock hardware serial port, plus the bench that runs AmplifierClass against three of them
+ * @version 0.1
+ * @date 2025-10-06
+ *
+ * The amplifier answers Copley ASCII ("g r0x0c" -> "v 123") and binary
+ * (get-parameter packets) on the same port, like the real drive. It boots
+ * at 9600 baud whenever its enable pin is released, only understands bytes
+ * sent at its own rate, and switches rate after acknowledging "s r0x90".
+ * Replies leave after a turnaround delay at the wire rate of the link.
+ *
+ * Faults are injected per reply: dropped, one byte corrupted, or the last
+ * byte cut off (so the reply runs into the next one). Above cleanBaud every
+ * byte is damaged in both directions, as on a link that cannot carry the
+ * rate.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "Amplifier.h"
+
+
+const uint16_t CONST_SIM_LINE_SIZE	   = 64;	   // Longest command the amplifier buffers
+const uint16_t CONST_SIM_PENDING_SIZE  = 512;	   // Reply bytes on the wire (power of two)
+const uint8_t  CONST_SIM_REGISTER_SIZE = 16;	   // Registers the amplifier holds
+const uint8_t  CONST_SIM_GARBLE_MASK   = 0x01;	   // Bit flipped in every byte above cleanBaud
+const uint8_t  CONST_SIM_ERROR_UNKNOWN = 3;		   // "e 3": unknown command or register
+const uint8_t  CONST_SIM_ERROR_RANGE   = 33;	   // "e 33": value out of range (unsupported baud)
+
+
+class SimulatedAmpClass : public MockSerialDevice {
+
+	public:
+	// Behaviour
+	uint32_t maxBaud		   = 1000000;	 // Fastest rate "s r0x90" accepts
+	uint32_t cleanBaud		   = 1000000;	 // Fastest rate the wire carries without damage
+	uint32_t latencyUs		   = 150;		 // Turnaround before the first reply byte
+	bool	 isModeRejected	   = false;		 // Answer "s r0x24" with an error
+	uint16_t overrideRegister  = 0;			 // ASCII register whose reply text is replaced (0 = none)
+	char	 overrideText[24]  = {};		 // Replacement text after "v "
+
+	// Faults on the next replies
+	uint32_t dropNext		   = 0;	   // Replies swallowed
+	uint32_t corruptNext	   = 0;	   // Replies with one byte damaged
+	uint32_t truncateNext	   = 0;	   // Replies missing their last byte
+	uint16_t faultPerMille	   = 0;	   // Random drop or corruption rate for sensor replies
+	uint32_t seed			   = 1;	   // Random fault generator state
+
+	// Counters
+	uint32_t asciiQueries	 = 0;	 // ASCII commands understood
+	uint32_t binaryQueries	 = 0;	 // Binary packets understood
+	uint32_t baudQueries	 = 0;	 // Reads of the baud register (the resync query)
+	uint32_t replies		 = 0;	 // Replies sent (faults included)
+	uint32_t faults			 = 0;	 // Replies dropped, corrupted or cut
+	uint32_t garbled		 = 0;	 // Bytes that arrived at the wrong rate or damaged
+	uint32_t rejected		 = 0;	 // Commands answered with an error
+	uint32_t resets			 = 0;	 // Times the enable pin held the amplifier in reset
+	uint32_t baudChanges	 = 0;	 // Rate switches after "s r0x90"
+
+	SimulatedAmpClass( HardwareSerial& newPort, uint8_t newEnablePin, const char* newName ) : port( newPort ), enablePin( newEnablePin ) {
+		strncpy( name, newName, sizeof( name ) - 1 );
+		port.device = this;
+		Reboot();
+	}
+
+	~SimulatedAmpClass() {
+		port.device = nullptr;
+	}
+
+	uint32_t Baud() const { return baud; }
+	bool	 IsInReset() const { return isInReset; }
+
+	int32_t Register( uint16_t id ) const {
+		for ( uint8_t i = 0; i < registerCount; i++ ) {
+			if ( registerId[i] == id ) return registerValue[i];
+		}
+		return 0;
+	}
+
+	void SetRegister( uint16_t id, int32_t value ) {
+		for ( uint8_t i = 0; i < registerCount; i++ ) {
+			if ( registerId[i] == id ) {
+				registerValue[i] = value;
+				return;
+			}
+		}
+		if ( registerCount < CONST_SIM_REGISTER_SIZE ) {
+			registerId[registerCount]	   = id;
+			registerValue[registerCount++] = value;
+		}
+	}
+
+	void OverrideAscii( uint16_t id, const char* text ) {
+		overrideRegister = id;
+		strncpy( overrideText, text, sizeof( overrideText ) - 1 );
+	}
+
+	/**
+	 * @brief Follow the enable pin and put due reply bytes on the wire
+	 */
+	void Update( uint32_t nowUs ) {
+
+		// Enable low holds the amplifier in reset, release boots it at the reset rate
+		if ( !digitalRead( enablePin ) ) {
+			if ( !isInReset ) {
+				Reboot();
+				resets++;
+			}
+			isInReset = true;
+			return;
+		}
+		isInReset = false;
+
+		// Reply bytes whose time has come
+		while ( pendingHead != pendingTail && int32_t( nowUs - pendingUs[pendingTail & ( CONST_SIM_PENDING_SIZE - 1 )] ) >= 0 ) {
+			uint8_t c = pendingByte[pendingTail & ( CONST_SIM_PENDING_SIZE - 1 )];
+			pendingTail++;
+			if ( baud > cleanBaud ) c ^= CONST_SIM_GARBLE_MASK;
+			if ( port.baudRate != baud ) c = uint8_t( ~c );
+			port.Deliver( c );
+		}
+
+		// Rate switch once the acknowledgement has left
+		if ( isBaudChangePending && pendingHead == pendingTail && int32_t( nowUs - wireFreeUs ) >= 0 ) {
+			baud				= pendingBaud;
+			isBaudChangePending = false;
+			baudChanges++;
+		}
+	}
+
+	// Firmware wrote a byte
+	void OnHostByte( uint8_t c, uint32_t hostBaud ) override {
+
+		if ( isInReset ) return;
+
+		// Wrong rate or damaged link, the command is lost
+		if ( hostBaud != baud || baud > cleanBaud ) {
+			garbled++;
+			lineLength	 = 0;
+			packetLength = 0;
+			isBinary	 = false;
+			return;
+		}
+
+		// Binary packets start with the node ID, ASCII commands with a letter
+		if ( lineLength == 0 && packetLength == 0 ) {
+			isBinary = ( c == CONST_COPLEY_BINARY_NODE );
+		}
+
+		if ( isBinary ) {
+			packet[packetLength++] = c;
+			if ( packetLength >= CONST_COPLEY_BINARY_HEADER_SIZE && packetLength == CONST_COPLEY_BINARY_HEADER_SIZE + 2 * packet[2] ) {
+				HandleBinary();
+				packetLength = 0;
+				isBinary	 = false;
+			} else if ( packetLength >= sizeof( packet ) ) {
+				packetLength = 0;
+				isBinary	 = false;
+			}
+			return;
+		}
+
+		if ( c == '\r' ) {
+			line[lineLength] = 0;
+			HandleAscii( lineLength + 1 );
+			lineLength = 0;
+			return;
+		}
+		if ( lineLength < CONST_SIM_LINE_SIZE - 1 ) {
+			line[lineLength++] = char( c );
+		}
+	}
+
+	private:
+	HardwareSerial& port;				// Link to the firmware
+	uint8_t			enablePin;			// Held low to reset
+	char			name[24] = {};		// Reply to "g f0x92"
+	bool			isInReset = true;	// Enable pin low
+	uint32_t		baud	  = CONST_AMP_INITIAL_BAUD;
+
+	// Rate switch after the acknowledgement
+	bool	 isBaudChangePending = false;
+	uint32_t pendingBaud		 = 0;
+
+	// Command assembly
+	char	line[CONST_SIM_LINE_SIZE] = {};
+	uint8_t lineLength				  = 0;
+	uint8_t packet[CONST_SIM_LINE_SIZE] = {};
+	uint8_t packetLength				= 0;
+	bool	isBinary					= false;
+
+	// Reply bytes and the time each reaches the firmware
+	uint8_t	 pendingByte[CONST_SIM_PENDING_SIZE] = {};
+	uint32_t pendingUs[CONST_SIM_PENDING_SIZE]	 = {};
+	uint32_t pendingHead						 = 0;
+	uint32_t pendingTail						 = 0;
+	uint32_t wireFreeUs							 = 0;	 // Time the last queued byte finishes
+
+	// Registers
+	uint16_t registerId[CONST_SIM_REGISTER_SIZE]	= {};
+	int32_t	 registerValue[CONST_SIM_REGISTER_SIZE] = {};
+	uint8_t	 registerCount							= 0;
+
+	void Reboot() {
+		baud				= CONST_AMP_INITIAL_BAUD;
+		isBaudChangePending = false;
+		lineLength			= 0;
+		packetLength		= 0;
+		isBinary			= false;
+		pendingTail			= pendingHead;
+		SetRegister( CONST_COPLEY_REG_BAUD, int32_t( CONST_AMP_INITIAL_BAUD ) );
+	}
+
+	static bool IsLongRegister( uint16_t id ) {
+		return id == CONST_COPLEY_REG_POSITION || id == CONST_COPLEY_REG_BAUD || id == CONST_COPLEY_REG_STATUS || id == CONST_COPLEY_REG_FAULT_LATCH;
+	}
+
+	bool HasRegister( uint16_t id ) const {
+		for ( uint8_t i = 0; i < registerCount; i++ ) {
+			if ( registerId[i] == id ) return true;
+		}
+		return false;
+	}
+
+	uint32_t NextRandom() {
+		seed = seed * 1664525UL + 1013904223UL;
+		return seed >> 8;
+	}
+
+	/**
+	 * @brief Queue a reply behind the command that triggered it, applying any fault
+	 *
+	 * @param commandBytes Length of the command, which has to cross the wire first
+	 * @param isSensorRead Reply to a register read (random faults only hit these)
+	 */
+	void Reply( const uint8_t* bytes, uint16_t length, uint16_t commandBytes, bool isSensorRead ) {
+
+		replies++;
+
+		// Pick the fault for this reply
+		enum { NONE, DROP, CORRUPT, TRUNCATE } fault = NONE;
+		if ( dropNext > 0 ) {
+			dropNext--;
+			fault = DROP;
+		} else if ( corruptNext > 0 ) {
+			corruptNext--;
+			fault = CORRUPT;
+		} else if ( truncateNext > 0 ) {
+			truncateNext--;
+			fault = TRUNCATE;
+		} else if ( isSensorRead && faultPerMille > 0 && NextRandom() % 1000 < faultPerMille ) {
+			fault = ( NextRandom() & 1 ) ? DROP : CORRUPT;
+		}
+		if ( fault != NONE ) faults++;
+		if ( fault == DROP ) return;
+
+		// Bytes leave after the command has arrived and the amplifier has turned around
+		float	 byteUs = 10.0f * 1000000.0f / baud;
+		uint32_t now	= micros();
+		uint32_t start	= now + uint32_t( commandBytes * byteUs ) + latencyUs;
+		if ( pendingHead != pendingTail && int32_t( wireFreeUs - start ) > 0 ) start = wireFreeUs;
+
+		if ( fault == TRUNCATE && length > 1 ) length--;
+		for ( uint16_t i = 0; i < length; i++ ) {
+			uint8_t c = bytes[i];
+			if ( fault == CORRUPT && i == length / 2 ) c = ( c >= '0' && c <= '9' ) ? uint8_t( 'x' ) : uint8_t( c ^ 0x55 );
+			if ( pendingHead - pendingTail >= CONST_SIM_PENDING_SIZE ) break;
+			uint32_t at									   = start + uint32_t( ( i + 1 ) * byteUs );
+			pendingByte[pendingHead & ( CONST_SIM_PENDING_SIZE - 1 )] = c;
+			pendingUs[pendingHead & ( CONST_SIM_PENDING_SIZE - 1 )]	  = at;
+			pendingHead++;
+			wireFreeUs = at;
+		}
+	}
+
+	void ReplyAscii( const char* text, uint16_t commandBytes, bool isSensorRead ) {
+		char	 reply[CONST_SIM_LINE_SIZE];
+		uint16_t length = uint16_t( snprintf( reply, sizeof( reply ), "%s\r", text ) );
+		Reply( reinterpret_cast<const uint8_t*>( reply ), length, commandBytes, isSensorRead );
+	}
+
+	void ReplyAsciiError( uint8_t code, uint16_t commandBytes ) {
+		char text[8];
+		snprintf( text, sizeof( text ), "e %u", code );
+		rejected++;
+		ReplyAscii( text, commandBytes, false );
+	}
+
+	void HandleAscii( uint16_t commandBytes ) {
+
+		unsigned id	   = 0;
+		long	 value = 0;
+
+		// Read a register
+		if ( sscanf( line, "g r0x%x", &id ) == 1 ) {
+			asciiQueries++;
+			if ( id == CONST_COPLEY_REG_BAUD ) baudQueries++;
+			if ( !HasRegister( uint16_t( id ) ) ) {
+				ReplyAsciiError( CONST_SIM_ERROR_UNKNOWN, commandBytes );
+				return;
+			}
+			char text[CONST_SIM_LINE_SIZE];
+			if ( overrideRegister != 0 && id == overrideRegister ) {
+				snprintf( text, sizeof( text ), "v %s", overrideText );
+			} else {
+				snprintf( text, sizeof( text ), "v %ld", long( Register( uint16_t( id ) ) ) );
+			}
+			ReplyAscii( text, commandBytes, id != CONST_COPLEY_REG_BAUD );
+			return;
+		}
+
+		// Read the name
+		if ( strcmp( line, "g f0x92" ) == 0 ) {
+			asciiQueries++;
+			char text[CONST_SIM_LINE_SIZE];
+			snprintf( text, sizeof( text ), "v %s", name );
+			ReplyAscii( text, commandBytes, false );
+			return;
+		}
+
+		// Write a register
+		if ( sscanf( line, "s r0x%x %ld", &id, &value ) == 2 ) {
+			asciiQueries++;
+
+			if ( id == CONST_COPLEY_REG_BAUD ) {
+				bool isCandidate = false;
+				for ( uint8_t i = 0; i < CONST_AMP_BAUD_CANDIDATE_COUNT; i++ ) {
+					if ( uint32_t( value ) == CONST_AMP_BAUD_CANDIDATES[i] ) isCandidate = true;
+				}
+				if ( !isCandidate || uint32_t( value ) > maxBaud ) {
+					ReplyAsciiError( CONST_SIM_ERROR_RANGE, commandBytes );
+					return;
+				}
+				ReplyAscii( "ok", commandBytes, false );
+				SetRegister( CONST_COPLEY_REG_BAUD, int32_t( value ) );
+				isBaudChangePending = true;
+				pendingBaud			= uint32_t( value );
+				return;
+			}
+
+			if ( id == 0x24 && isModeRejected ) {
+				ReplyAsciiError( CONST_SIM_ERROR_RANGE, commandBytes );
+				return;
+			}
+
+			SetRegister( uint16_t( id ), int32_t( value ) );
+			ReplyAscii( "ok", commandBytes, false );
+			return;
+		}
+
+		// Reset (no reply)
+		if ( strcmp( line, "r" ) == 0 ) {
+			asciiQueries++;
+			Reboot();
+			return;
+		}
+
+		ReplyAsciiError( CONST_SIM_ERROR_UNKNOWN, commandBytes );
+	}
+
+	void HandleBinary() {
+
+		uint16_t length	  = CONST_COPLEY_BINARY_HEADER_SIZE + 2 * packet[2];
+		uint8_t	 checksum = 0;
+		for ( uint16_t i = 0; i < length; i++ ) checksum ^= packet[i];
+
+		// The drive ignores packets that fail the checksum
+		if ( checksum != CONST_COPLEY_BINARY_CHECKSUM_KEY ) {
+			garbled++;
+			return;
+		}
+		binaryQueries++;
+
+		uint8_t reply[CONST_COPLEY_BINARY_HEADER_SIZE + 4];
+		uint8_t words = 0;
+		reply[0]	  = CONST_COPLEY_BINARY_NODE;
+		reply[3]	  = 0;
+
+		uint16_t id = uint16_t( ( packet[4] << 8 ) | packet[5] );
+		if ( packet[3] != CONST_COPLEY_BINARY_OP_GET || packet[2] != 1 || !HasRegister( id ) ) {
+			reply[3] = CONST_SIM_ERROR_UNKNOWN;
+			rejected++;
+		} else {
+			if ( id == CONST_COPLEY_REG_BAUD ) baudQueries++;
+			uint32_t value = uint32_t( Register( id ) );
+			if ( IsLongRegister( id ) ) {
+				words	 = 2;
+				reply[4] = uint8_t( value >> 24 );
+				reply[5] = uint8_t( value >> 16 );
+				reply[6] = uint8_t( value >> 8 );
+				reply[7] = uint8_t( value );
+			} else {
+				words	 = 1;
+				reply[4] = uint8_t( value >> 8 );
+				reply[5] = uint8_t( value );
+			}
+		}
+
+		reply[2]			= words;
+		uint16_t replySize	= CONST_COPLEY_BINARY_HEADER_SIZE + 2 * words;
+		reply[1]			= 0;
+		uint8_t replySum	= CONST_COPLEY_BINARY_CHECKSUM_KEY;
+		for ( uint16_t i = 0; i < replySize; i++ ) replySum ^= reply[i];
+		reply[1] = replySum;
+
+		Reply( reply, replySize, length, id != CONST_COPLEY_REG_BAUD );
+	}
+};
+
+
+// === BENCH ======================================================================================
+
+const uint32_t CONST_BENCH_STEP_US		   = 5;							   // Simulation step
+const uint32_t CONST_BENCH_TICK_US		   = 1000;						   // Master tick (CONST_TICK_HZ)
+const uint8_t  CONST_BENCH_SENSOR_DIVIDER  = 3;							   // ReadSensors every 3rd tick, as in main.cpp
+const uint32_t CONST_BENCH_RECEIVE_US	   = 1000000 / CONST_AMP_RX_SERVICE_HZ;	  // Receive timer period
+const uint32_t CONST_BENCH_LOOP_US		   = 50;						   // loop() pass
+
+
+/**
+ * @brief Three simulated amplifiers on the firmware's ports, and the timers that drive AmplifierClass
+ */
+struct AmpBenchStruct {
+
+	SimulatedAmpClass A{ HWSerialA, PIN_AMPLIFIER_ENABLE_A, "SimAmpA" };	// Amplifier A
+	SimulatedAmpClass B{ HWSerialB, PIN_AMPLIFIER_ENABLE_B, "SimAmpB" };	// Amplifier B
+	SimulatedAmpClass C{ HWSerialC, PIN_AMPLIFIER_ENABLE_C, "SimAmpC" };	// Amplifier C
+
+	uint32_t ticks = 0;	   // Master ticks run
+
+	AmpBenchStruct() {
+		int32_t current[3]	= { 123, -45, 678 };
+		int32_t position[3] = { 1000, -2000, 300000 };
+		for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+			SimulatedAmpClass& Amp = Get( amp );
+			Amp.SetRegister( CONST_COPLEY_REG_CURRENT, current[amp] );
+			Amp.SetRegister( CONST_COPLEY_REG_POSITION, position[amp] );
+			Amp.SetRegister( CONST_COPLEY_REG_BUS_VOLTAGE, 480 );
+			Amp.SetRegister( CONST_COPLEY_REG_DRIVE_TEMP, 35 );
+			Amp.SetRegister( CONST_COPLEY_REG_STATUS, 0 );
+			Amp.SetRegister( CONST_COPLEY_REG_FAULT_LATCH, 0 );
+		}
+	}
+
+	SimulatedAmpClass& Get( uint8_t amp ) {
+		return ( amp == 0 ) ? A : ( amp == 1 ) ? B : C;
+	}
+
+	/**
+	 * @brief Run the firmware's timers against the amplifiers for a while
+	 *
+	 * Receive timer, master tick (sensor reads every third tick) and loop()
+	 * are interleaved as on the Teensy, one simulation step at a time.
+	 */
+	void Run( AmplifierClass& Amplifier, uint32_t durationUs ) {
+
+		for ( uint32_t elapsed = 0; elapsed < durationUs; elapsed += CONST_BENCH_STEP_US ) {
+
+			MockArduino::AdvanceUs( CONST_BENCH_STEP_US );
+			uint32_t now = micros();
+
+			A.Update( now );
+			B.Update( now );
+			C.Update( now );
+
+			if ( now % CONST_BENCH_RECEIVE_US == 0 ) {
+				Amplifier.ServiceReceive();
+			}
+			if ( now % CONST_BENCH_TICK_US == 0 ) {
+				if ( ticks++ % CONST_BENCH_SENSOR_DIVIDER == 0 ) Amplifier.ReadSensors();
+			}
+			if ( now % CONST_BENCH_LOOP_US == 0 ) {
+				Amplifier.Loop();
+			}
+		}
+	}
+
+	/**
+	 * @brief Begin() the firmware and run until every amplifier is ready or failed
+	 *
+	 * @return true once the firmware reported the end of initialization
+	 */
+	bool Start( AmplifierClass& Amplifier, EnumsClass::AmplifierProtocolEnum protocol, uint32_t timeoutUs = 10000000 ) {
+		Serial.ClearOutput();
+		Amplifier.Begin( protocol );
+		for ( uint32_t elapsed = 0; elapsed < timeoutUs; elapsed += CONST_BENCH_TICK_US ) {
+			Run( Amplifier, CONST_BENCH_TICK_US );
+			if ( strstr( Serial.text, "All amplifiers" ) ) return true;
+		}
+		return false;
+	}
+};
+
+
+// === FIXTURE ====================================================================================
+
+inline AmpBenchStruct* Bench	 = nullptr;	   // Simulated amplifiers for the running test
+inline AmplifierClass* Amplifier = nullptr;	   // Firmware under test
+
+/**
+ * @brief Fresh amplifiers and a fresh AmplifierClass (call from setUp)
+ */
+inline void CreateAmpBench() {
+	Bench	  = new AmpBenchStruct();
+	Amplifier = new AmplifierClass();
+}
+
+/**
+ * @brief Release what CreateAmpBench made (call from tearDown)
+ */
+inline void DestroyAmpBench() {
+	delete Amplifier;
+	delete Bench;
+	Amplifier = nullptr;
+	Bench	  = nullptr;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file test_main.cpp
+ * @brief Baud negotiation against simulated amplifiers with different rate limits
+ *
+ * Each amplifier is offered the candidates fastest first. A rate it refuses
+ * ("e 33") moves straight to the next one; a rate it accepts but cannot
+ * carry shows up as a garbled confirmation, which resets that amplifier and
+ * reruns init one rate lower.
+ */
+
+#include <unity.h>
+
+#include "SharedMemory.h"
+#include "SimulatedAmp.h"
+
+
+void setUp() {
+	CreateAmpBench();
+}
+
+void tearDown() {
+	DestroyAmpBench();
+}
+
+
+void test_fastest_rate_is_chosen() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+	uint32_t fallbacks = Shared->Interface.HWSerial.Connection.baudFallbacksA;
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+
+	TEST_ASSERT_EQUAL_UINT32( CONST_AMP_BAUD_CANDIDATES[0], Shared->Interface.HWSerial.Connection.baudRateA );
+	TEST_ASSERT_EQUAL_UINT32( CONST_AMP_BAUD_CANDIDATES[0], Shared->Interface.HWSerial.Connection.baudRateB );
+	TEST_ASSERT_EQUAL_UINT32( CONST_AMP_BAUD_CANDIDATES[0], Shared->Interface.HWSerial.Connection.baudRateC );
+	TEST_ASSERT_EQUAL_UINT32( CONST_AMP_BAUD_CANDIDATES[0], HWSerialA.baudRate );
+	TEST_ASSERT_EQUAL_UINT32( CONST_AMP_BAUD_CANDIDATES[0], Bench->A.Baud() );
+	TEST_ASSERT_EQUAL_UINT32( fallbacks, Shared->Interface.HWSerial.Connection.baudFallbacksA );
+	TEST_ASSERT_EQUAL_UINT32( 0, Bench->A.resets );	   // Held in reset from power-up, not reset again
+}
+
+
+void test_refused_rates_are_skipped_without_a_reset() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+	uint32_t fallbacks = Shared->Interface.HWSerial.Connection.baudFallbacksB;
+
+	// B takes nothing above 230400, C nothing above 115200
+	Bench->B.maxBaud = 230400;
+	Bench->C.maxBaud = 115200;
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+
+	TEST_ASSERT_EQUAL_UINT32( 1000000, Shared->Interface.HWSerial.Connection.baudRateA );
+	TEST_ASSERT_EQUAL_UINT32( 230400, Shared->Interface.HWSerial.Connection.baudRateB );
+	TEST_ASSERT_EQUAL_UINT32( 115200, Shared->Interface.HWSerial.Connection.baudRateC );
+	TEST_ASSERT_EQUAL_UINT32( 230400, Bench->B.Baud() );
+	TEST_ASSERT_EQUAL_UINT32( 115200, Bench->C.Baud() );
+
+	// Two and three "e 33" answers, no extra reset and no fallback counted
+	TEST_ASSERT_EQUAL_UINT32( 2, Bench->B.rejected );
+	TEST_ASSERT_EQUAL_UINT32( 3, Bench->C.rejected );
+	TEST_ASSERT_EQUAL_UINT32( 0, Bench->B.resets );
+	TEST_ASSERT_EQUAL_UINT32( fallbacks, Shared->Interface.HWSerial.Connection.baudFallbacksB );
+}
+
+
+void test_garbled_rates_fall_back_one_at_a_time() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+	uint32_t fallbacksA = Shared->Interface.HWSerial.Connection.baudFallbacksA;
+	uint32_t fallbacksC = Shared->Interface.HWSerial.Connection.baudFallbacksC;
+
+	// A accepts 1 Mbaud but its wire only carries 460800, C only 115200
+	Bench->A.cleanBaud = 460800;
+	Bench->C.cleanBaud = 115200;
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+
+	TEST_ASSERT_EQUAL_UINT32( 460800, Shared->Interface.HWSerial.Connection.baudRateA );
+	TEST_ASSERT_EQUAL_UINT32( 1000000, Shared->Interface.HWSerial.Connection.baudRateB );
+	TEST_ASSERT_EQUAL_UINT32( 115200, Shared->Interface.HWSerial.Connection.baudRateC );
+	TEST_ASSERT_EQUAL_UINT32( fallbacksA + 1, Shared->Interface.HWSerial.Connection.baudFallbacksA );
+	TEST_ASSERT_EQUAL_UINT32( fallbacksC + 3, Shared->Interface.HWSerial.Connection.baudFallbacksC );
+
+	// Each fallback reset the amplifier back to the boot rate first
+	TEST_ASSERT_EQUAL_UINT32( 1, Bench->A.resets );
+	TEST_ASSERT_EQUAL_UINT32( 3, Bench->C.resets );
+	TEST_ASSERT_GREATER_THAN_UINT32( 0, Bench->A.garbled );
+
+	// And the link works at the rate it settled on
+	Bench->Run( *Amplifier, 100000 );
+	TEST_ASSERT_EQUAL_INT32( 1000, Shared->Sensors.MotorEncoders.rawCountA );
+	TEST_ASSERT_EQUAL_INT32( 300000, Shared->Sensors.MotorEncoders.rawCountC );
+}
+
+
+void test_amplifier_with_no_usable_rate_fails_alone() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// B refuses every candidate, C garbles all of them
+	Bench->B.maxBaud   = 57600;
+	Bench->C.cleanBaud = 57600;
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+
+	TEST_ASSERT_EQUAL_UINT32( 1000000, Shared->Interface.HWSerial.Connection.baudRateA );
+	TEST_ASSERT_EQUAL_UINT32( 0, Shared->Interface.HWSerial.Connection.baudRateB );
+	TEST_ASSERT_EQUAL_UINT32( 0, Shared->Interface.HWSerial.Connection.baudRateC );
+	TEST_ASSERT_EQUAL_UINT32( CONST_AMP_BAUD_CANDIDATE_COUNT, Bench->B.rejected );
+
+	// A still polls
+	AmpSampleStruct before;
+	AmpSampleStruct after;
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 0, before ) );
+	Bench->Run( *Amplifier, 100000 );
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 0, after ) );
+	TEST_ASSERT_GREATER_THAN_UINT32( 0, after.sequence - before.sequence );
+}
+
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST( test_fastest_rate_is_chosen );
+	RUN_TEST( test_refused_rates_are_skipped_without_a_reset );
+	RUN_TEST( test_garbled_rates_fall_back_one_at_a_time );
+	RUN_TEST( test_amplifier_with_no_usable_rate_fails_alone );
+	return UNITY_END();
+}
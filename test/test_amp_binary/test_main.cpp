@@ -0,0 +1,155 @@
+/**
+ * @file test_main.cpp
+ * @brief Copley binary transport against three simulated amplifiers, and its cost next to ASCII
+ *
+ * A binary read is a 6-byte request and an 8 or 10-byte reply. The ASCII
+ * read it replaces is "g r0x17\r" out and up to "v -2147483648\r" back, all
+ * of it decimal text the ISR has to convert.
+ */
+
+#include <unity.h>
+
+#include "SharedMemory.h"
+#include "SimulatedAmp.h"
+
+
+const uint32_t CONST_RATE_WINDOW_US = 1000000;	  // Measurement window
+
+
+void setUp() {
+	CreateAmpBench();
+}
+
+void tearDown() {
+	DestroyAmpBench();
+}
+
+
+/**
+ * @brief Wire bytes, published samples and parse cost on link A over one window
+ */
+struct LinkUseStruct {
+	float	 bytesPerSample	 = 0.0f;	// Both directions
+	float	 rateHz			 = 0.0f;	// Current and position pairs per second
+	unsigned parseMeanCycles = 0;		// From PrintLinkStats
+};
+
+static LinkUseStruct MeasureLinkA( EnumsClass::AmplifierProtocolEnum protocol ) {
+
+	LinkUseStruct Use;
+	AmpSampleStruct before;
+	AmpSampleStruct after;
+
+	// Mid-run values and a rate where the wire, not the turnaround, sets the pace
+	Bench->A.maxBaud = 115200;
+	Bench->A.SetRegister( CONST_COPLEY_REG_CURRENT, -1234 );
+	Bench->A.SetRegister( CONST_COPLEY_REG_POSITION, -1234567 );
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, protocol ) );
+	Bench->Run( *Amplifier, 100000 );
+	Amplifier->PrintLinkStats();
+
+	uint32_t bytes = HWSerialA.bytesSent + HWSerialA.bytesDelivered;
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 0, before ) );
+	Bench->Run( *Amplifier, CONST_RATE_WINDOW_US );
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 0, after ) );
+	bytes = HWSerialA.bytesSent + HWSerialA.bytesDelivered - bytes;
+
+	Serial.ClearOutput();
+	Amplifier->PrintLinkStats();
+	const char* stats = strstr( Serial.text, "parse mean/max: " );
+	TEST_ASSERT_NOT_NULL( stats );
+	TEST_ASSERT_EQUAL_INT( 1, sscanf( stats, "parse mean/max: %u", &Use.parseMeanCycles ) );
+
+	uint32_t samples = after.sequence - before.sequence;
+	TEST_ASSERT_GREATER_THAN_UINT32( 0, samples );
+	Use.bytesPerSample = float( bytes ) / samples;
+	Use.rateHz		   = samples / 2.0f * 1000000.0f / CONST_RATE_WINDOW_US;
+	return Use;
+}
+
+
+void test_sensor_reads_use_binary_packets() {
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::BINARY ) );
+
+	// Init is ASCII, everything after it binary
+	uint32_t asciiQueries  = Bench->A.asciiQueries;
+	uint32_t binaryQueries = Bench->A.binaryQueries;
+	Bench->Run( *Amplifier, 100000 );
+
+	TEST_ASSERT_EQUAL_UINT32( asciiQueries, Bench->A.asciiQueries );
+	TEST_ASSERT_GREATER_THAN_UINT32( binaryQueries + 100, Bench->A.binaryQueries );
+	TEST_ASSERT_EQUAL_UINT32( 0, Bench->A.garbled );
+	TEST_ASSERT_EQUAL_UINT32( 0, Bench->A.rejected );
+}
+
+
+void test_binary_values_land_in_their_own_fields() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::BINARY ) );
+	Bench->Run( *Amplifier, 600000 );
+
+	// One-word current (signed), two-word position
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, 1.23f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsA );
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, -0.45f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsB );
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, 6.78f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsC );
+	TEST_ASSERT_EQUAL_INT32( 1000, Shared->Sensors.MotorEncoders.rawCountA );
+	TEST_ASSERT_EQUAL_INT32( -2000, Shared->Sensors.MotorEncoders.rawCountB );
+	TEST_ASSERT_EQUAL_INT32( 300000, Shared->Sensors.MotorEncoders.rawCountC );
+	TEST_ASSERT_FLOAT_WITHIN( 0.01f, 48.0f, Shared->Sensors.AmplifierTelemetry.busVoltageA );
+	TEST_ASSERT_FLOAT_WITHIN( 0.01f, 35.0f, Shared->Sensors.AmplifierTelemetry.driveTempDegCC );
+}
+
+
+void test_binary_words_keep_their_sign_and_width() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::BINARY ) );
+
+	Bench->A.SetRegister( CONST_COPLEY_REG_CURRENT, INT16_MIN );
+	Bench->A.SetRegister( CONST_COPLEY_REG_POSITION, INT32_MIN );
+	Bench->B.SetRegister( CONST_COPLEY_REG_CURRENT, INT16_MAX );
+	Bench->B.SetRegister( CONST_COPLEY_REG_POSITION, INT32_MAX );
+	Bench->C.SetRegister( CONST_COPLEY_REG_CURRENT, -1 );
+	Bench->C.SetRegister( CONST_COPLEY_REG_POSITION, -65536 );
+	Bench->Run( *Amplifier, 20000 );
+
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, -327.68f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsA );
+	TEST_ASSERT_EQUAL_INT32( INT32_MIN, Shared->Sensors.MotorEncoders.rawCountA );
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, 327.67f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsB );
+	TEST_ASSERT_EQUAL_INT32( INT32_MAX, Shared->Sensors.MotorEncoders.rawCountB );
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, -0.01f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsC );
+	TEST_ASSERT_EQUAL_INT32( -65536, Shared->Sensors.MotorEncoders.rawCountC );
+}
+
+
+void test_binary_costs_fewer_bytes_than_ascii() {
+
+	LinkUseStruct Ascii = MeasureLinkA( EnumsClass::AmplifierProtocolEnum::ASCII );
+
+	DestroyAmpBench();
+	CreateAmpBench();
+	LinkUseStruct Binary = MeasureLinkA( EnumsClass::AmplifierProtocolEnum::BINARY );
+
+	char message[200];
+	snprintf( message, sizeof( message ), "Link A at 115200: ASCII %.1f bytes/sample, %.0f Hz, parse %u cyc; binary %.1f bytes/sample, %.0f Hz, parse %u cyc",
+			  Ascii.bytesPerSample, Ascii.rateHz, Ascii.parseMeanCycles, Binary.bytesPerSample, Binary.rateHz, Binary.parseMeanCycles );
+	TEST_MESSAGE( message );
+
+	TEST_ASSERT_TRUE_MESSAGE( Binary.bytesPerSample < Ascii.bytesPerSample, message );
+	TEST_ASSERT_TRUE_MESSAGE( Binary.rateHz > Ascii.rateHz, message );
+}
+
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST( test_sensor_reads_use_binary_packets );
+	RUN_TEST( test_binary_values_land_in_their_own_fields );
+	RUN_TEST( test_binary_words_keep_their_sign_and_width );
+	RUN_TEST( test_binary_costs_fewer_bytes_than_ascii );
+	return UNITY_END();
+}
@@ -0,0 +1,187 @@
+/**
+ * @file test_main.cpp
+ * @brief Query deadlines, resync and link-loss recovery against fault-injecting simulated amplifiers
+ *
+ * Every register an amplifier reports has a distinct value, so a reply
+ * parsed against the wrong query shows up as a wrong reading. Before
+ * deadlines were added, one dropped reply shifted every later reply onto
+ * the next query and encoder counts landed in the current field.
+ */
+
+#include <unity.h>
+
+#include "SharedMemory.h"
+#include "SimulatedAmp.h"
+
+
+const uint32_t CONST_CHECK_STEP_US = 500;	 // Readings are checked this often while faults are injected
+
+
+void setUp() {
+	CreateAmpBench();
+}
+
+void tearDown() {
+	DestroyAmpBench();
+}
+
+
+/**
+ * @brief Link A counters from PrintLinkStats (starts a new stats window)
+ */
+struct LinkCountsStruct {
+	unsigned timeouts	= 0;
+	unsigned malformed	= 0;
+	unsigned resyncs	= 0;
+	bool	 isLost		= false;
+};
+
+static LinkCountsStruct ReadLinkA() {
+
+	LinkCountsStruct Counts;
+
+	Serial.ClearOutput();
+	Amplifier->PrintLinkStats();
+	const char* stats = strstr( Serial.text, "Link A" );
+	TEST_ASSERT_NOT_NULL( stats );
+	TEST_ASSERT_EQUAL_INT( 3, sscanf( strstr( stats, "timeouts: " ), "timeouts: %u  malformed: %u  overwritten: %*u  resyncs: %u", &Counts.timeouts, &Counts.malformed, &Counts.resyncs ) );
+
+	const char* nextLine = strchr( stats, '\n' );
+	const char* lost	 = strstr( stats, "(LOST)" );
+	Counts.isLost		 = lost && ( !nextLine || lost < nextLine );
+	return Counts;
+}
+
+/**
+ * @brief Run in short steps and fail on the first reading that is not amplifier A's own
+ */
+static void RunCheckingReadingsA( uint32_t durationUs ) {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	for ( uint32_t elapsed = 0; elapsed < durationUs; elapsed += CONST_CHECK_STEP_US ) {
+		Bench->Run( *Amplifier, CONST_CHECK_STEP_US );
+		TEST_ASSERT_FLOAT_WITHIN( 0.001f, 1.23f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsA );
+		TEST_ASSERT_EQUAL_INT32( 1000, Shared->Sensors.MotorEncoders.rawCountA );
+	}
+}
+
+static uint32_t SamplesA( uint32_t durationUs ) {
+	AmpSampleStruct before;
+	AmpSampleStruct after;
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 0, before ) );
+	RunCheckingReadingsA( durationUs );
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 0, after ) );
+	return after.sequence - before.sequence;
+}
+
+static void StartSettled( EnumsClass::AmplifierProtocolEnum protocol ) {
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, protocol ) );
+	Bench->Run( *Amplifier, 100000 );
+	ReadLinkA();
+}
+
+
+void test_dropped_reply_times_out_and_resyncs() {
+
+	StartSettled( EnumsClass::AmplifierProtocolEnum::ASCII );
+
+	Bench->A.dropNext = 1;
+	uint32_t samples  = SamplesA( 20000 );
+
+	LinkCountsStruct Counts = ReadLinkA();
+	TEST_ASSERT_EQUAL_UINT32( 1, Counts.timeouts );
+	TEST_ASSERT_EQUAL_UINT32( 1, Counts.resyncs );
+	TEST_ASSERT_FALSE( Counts.isLost );
+	TEST_ASSERT_GREATER_THAN_UINT32( 20, samples );	   // Polling picked up again within the window
+}
+
+
+void test_corrupted_and_cut_replies_are_rejected() {
+
+	StartSettled( EnumsClass::AmplifierProtocolEnum::ASCII );
+
+	// A cut reply runs into the next one, so either way the line does not parse
+	for ( uint8_t i = 0; i < 3; i++ ) {
+		Bench->A.corruptNext = 1;
+		RunCheckingReadingsA( 10000 );
+		Bench->A.truncateNext = 1;
+		RunCheckingReadingsA( 10000 );
+	}
+
+	LinkCountsStruct Counts = ReadLinkA();
+	TEST_ASSERT_GREATER_OR_EQUAL_UINT32( 3, Counts.malformed );
+	TEST_ASSERT_GREATER_OR_EQUAL_UINT32( 3, Counts.resyncs );
+	TEST_ASSERT_FALSE( Counts.isLost );
+	TEST_ASSERT_GREATER_THAN_UINT32( 20, SamplesA( 20000 ) );
+}
+
+
+void test_random_faults_never_misattribute_readings() {
+
+	const EnumsClass::AmplifierProtocolEnum protocols[] = { EnumsClass::AmplifierProtocolEnum::ASCII, EnumsClass::AmplifierProtocolEnum::BINARY };
+
+	for ( EnumsClass::AmplifierProtocolEnum protocol : protocols ) {
+
+		DestroyAmpBench();
+		CreateAmpBench();
+		StartSettled( protocol );
+		uint32_t cleanSamples = SamplesA( 200000 );
+
+		// One sensor reply in fifty dropped or damaged
+		Bench->A.faultPerMille = 20;
+		Bench->A.seed		   = 12345;
+		uint32_t faults		   = Bench->A.faults;
+		uint32_t samples	   = SamplesA( 1000000 );
+		faults				   = Bench->A.faults - faults;
+
+		char message[120];
+		snprintf( message, sizeof( message ), "%s: %u faults, %.0f%% of the fault-free sample rate", protocol == EnumsClass::AmplifierProtocolEnum::ASCII ? "ASCII" : "Binary",
+				  unsigned( faults ), 100.0f * samples / ( 5.0f * cleanSamples ) );
+		TEST_MESSAGE( message );
+
+		TEST_ASSERT_GREATER_THAN_UINT32( 20, faults );
+		TEST_ASSERT_FALSE( ReadLinkA().isLost );
+		TEST_ASSERT_TRUE_MESSAGE( samples > 4 * cleanSamples, message );	// Kept at least 80 % of the clean rate
+	}
+}
+
+
+void test_dead_link_backs_off_and_recovers() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	StartSettled( EnumsClass::AmplifierProtocolEnum::ASCII );
+
+	// Amplifier A stops answering
+	Bench->A.dropNext = UINT32_MAX;
+	Bench->Run( *Amplifier, 50000 );
+	TEST_ASSERT_TRUE( ReadLinkA().isLost );
+
+	// Backed off: a resync query every SENSOR_RESYNC_BACKOFF_US, not every deadline
+	uint32_t baudQueries = Bench->A.baudQueries;
+	Bench->Run( *Amplifier, 500000 );
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32( baudQueries + 6, Bench->A.baudQueries );
+	TEST_ASSERT_TRUE( ReadLinkA().isLost );
+
+	// B and C kept polling
+	Bench->B.SetRegister( CONST_COPLEY_REG_POSITION, -777 );
+	Bench->Run( *Amplifier, 10000 );
+	TEST_ASSERT_EQUAL_INT32( -777, Shared->Sensors.MotorEncoders.rawCountB );
+
+	// Answers again, picked up at the next probe
+	Bench->A.dropNext = 0;
+	Bench->Run( *Amplifier, 150000 );
+	TEST_ASSERT_FALSE( ReadLinkA().isLost );
+	TEST_ASSERT_GREATER_THAN_UINT32( 20, SamplesA( 20000 ) );
+}
+
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST( test_dropped_reply_times_out_and_resyncs );
+	RUN_TEST( test_corrupted_and_cut_replies_are_rejected );
+	RUN_TEST( test_random_faults_never_misattribute_readings );
+	RUN_TEST( test_dead_link_backs_off_and_recovers );
+	return UNITY_END();
+}
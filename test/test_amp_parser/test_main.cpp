@@ -0,0 +1,212 @@
+/**
+ * @file test_main.cpp
+ * @brief ASCII response parser: range checks, no heap use while polling, and cost against the old String path
+ *
+ * The old path appended each byte to a String, compared the outgoing
+ * command String against every AsciiStruct member and converted with
+ * substring().toInt(). LegacyParserStruct keeps that path so both can be
+ * timed on the host. The mock String is a std::string, which keeps short
+ * replies off the heap, so the old path's allocations are not counted here;
+ * on the Teensy every substring() allocates.
+ */
+
+#include <unity.h>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <new>
+
+#include "SharedMemory.h"
+#include "SimulatedAmp.h"
+
+
+// === HEAP COUNTER ===============================================================================
+
+static std::atomic<uint64_t> heapAllocations{ 0 };	  // operator new calls since start
+
+// GCC flags the free() below once it inlines these into each other; they do pair up
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new( size_t size ) {
+	heapAllocations++;
+	void* block = malloc( size ? size : 1 );
+	if ( !block ) throw std::bad_alloc();
+	return block;
+}
+
+void operator delete( void* block ) noexcept {
+	free( block );
+}
+
+void operator delete( void* block, size_t ) noexcept {
+	free( block );
+}
+
+
+// === OLD PATH ===================================================================================
+
+/**
+ * @brief The String-based receive and parse path the ring and integer parser replaced
+ */
+struct LegacyParserStruct {
+
+	String getCurrentReading = "g r0x0c\r";
+	String getEncoderCount	 = "g r0x17\r";
+	String getBaud			 = "g r0x90\r";
+	String getName			 = "g f0x92\r";
+	String outgoingQuery;
+	String respondingQuery;
+	float  currentAmps = 0.0f;
+	int32_t encoderCount = 0;
+
+	void ReceiveByte( char incomingChar ) {
+		if ( incomingChar == '\r' || incomingChar == '\n' ) {
+			if ( respondingQuery != "" ) Parse();
+		} else {
+			respondingQuery += incomingChar;
+		}
+	}
+
+	void Parse() {
+		String response = respondingQuery;
+		if ( outgoingQuery == getBaud ) {
+			encoderCount = response.substring( 2, response.length() ).toInt();
+		}
+		if ( outgoingQuery == getCurrentReading ) {
+			int32_t count = response.substring( 2, response.length() ).toInt();
+			currentAmps	  = float( count / 100.0f );
+		}
+		if ( outgoingQuery == getEncoderCount ) {
+			encoderCount = response.substring( 2, response.length() ).toInt();
+		}
+		if ( outgoingQuery == getName ) {
+			outgoingQuery = response.substring( 2, response.length() );
+		}
+		respondingQuery = "";
+	}
+};
+
+
+// === TESTS ======================================================================================
+
+
+void setUp() {
+	CreateAmpBench();
+}
+
+void tearDown() {
+	DestroyAmpBench();
+}
+
+
+void test_int32_extremes_are_accepted() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+
+	Bench->A.OverrideAscii( CONST_COPLEY_REG_POSITION, "-2147483648" );
+	Bench->B.OverrideAscii( CONST_COPLEY_REG_POSITION, "2147483647" );
+	Bench->C.OverrideAscii( CONST_COPLEY_REG_POSITION, "-0000000000042" );
+	Bench->Run( *Amplifier, 20000 );
+
+	TEST_ASSERT_EQUAL_INT32( INT32_MIN, Shared->Sensors.MotorEncoders.rawCountA );
+	TEST_ASSERT_EQUAL_INT32( INT32_MAX, Shared->Sensors.MotorEncoders.rawCountB );
+	TEST_ASSERT_EQUAL_INT32( -42, Shared->Sensors.MotorEncoders.rawCountC );
+}
+
+
+void test_values_outside_int32_are_malformed() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+	Bench->Run( *Amplifier, 20000 );
+
+	// Just past either end, and far past (would wrap a 32-bit accumulator back into range)
+	const char* outOfRange[] = { "2147483648", "-2147483649", "4294967297", "99999999999" };
+
+	for ( const char* text : outOfRange ) {
+
+		uint32_t resyncsBefore = Bench->A.baudQueries;
+		Bench->A.OverrideAscii( CONST_COPLEY_REG_POSITION, text );
+		Bench->Run( *Amplifier, 20000 );
+
+		// Never stored, and each one makes the firmware realign the link
+		TEST_ASSERT_EQUAL_INT32( 1000, Shared->Sensors.MotorEncoders.rawCountA );
+		TEST_ASSERT_GREATER_THAN_UINT32( resyncsBefore, Bench->A.baudQueries );
+	}
+
+	// Good values are picked up again
+	Bench->A.OverrideAscii( 0, "" );
+	Bench->A.SetRegister( CONST_COPLEY_REG_POSITION, 777 );
+	Bench->Run( *Amplifier, 20000 );
+	TEST_ASSERT_EQUAL_INT32( 777, Shared->Sensors.MotorEncoders.rawCountA );
+}
+
+
+void test_polling_does_not_allocate() {
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+	Bench->Run( *Amplifier, 100000 );
+
+	uint32_t replies	 = Bench->A.replies + Bench->B.replies + Bench->C.replies;
+	uint64_t allocations = heapAllocations;
+	Bench->Run( *Amplifier, 500000 );
+	replies = Bench->A.replies + Bench->B.replies + Bench->C.replies - replies;
+
+	TEST_ASSERT_GREATER_THAN_UINT32( 1000, replies );
+	TEST_ASSERT_EQUAL_UINT64( allocations, heapAllocations.load() );
+}
+
+
+void test_benchmark_against_the_string_path() {
+
+	const uint32_t CONST_LEGACY_REPLIES = 200000;
+
+	// Current path: the firmware times each ParseQuery call with the cycle counter (host clock here)
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+	Bench->Run( *Amplifier, 100000 );
+	Amplifier->PrintLinkStats();
+	Bench->Run( *Amplifier, 1000000 );
+	Serial.ClearOutput();
+	Amplifier->PrintLinkStats();
+
+	unsigned	parseMeanCycles = 0;
+	unsigned	parseMaxCycles	= 0;
+	const char* stats			= strstr( Serial.text, "parse mean/max: " );
+	TEST_ASSERT_NOT_NULL( stats );
+	TEST_ASSERT_EQUAL_INT( 2, sscanf( stats, "parse mean/max: %u/%u", &parseMeanCycles, &parseMaxCycles ) );
+	double newNs = parseMeanCycles * 1000.0 / ( F_CPU_ACTUAL / 1000000 );
+
+	// Old path on the same kind of replies (framing included)
+	LegacyParserStruct Legacy;
+	const char*		   reply[2] = { "v 123\r", "v 300000\r" };
+	const String*	   query[2] = { &Legacy.getCurrentReading, &Legacy.getEncoderCount };
+	auto			   start	= std::chrono::steady_clock::now();
+	for ( uint32_t i = 0; i < CONST_LEGACY_REPLIES; i++ ) {
+		Legacy.outgoingQuery = *query[i & 1];
+		for ( const char* c = reply[i & 1]; *c; c++ ) Legacy.ReceiveByte( *c );
+	}
+	double legacyNs = double( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count() ) / CONST_LEGACY_REPLIES;
+
+	TEST_ASSERT_EQUAL_INT32( 300000, Legacy.encoderCount );
+
+	char message[160];
+	snprintf( message, sizeof( message ), "Host time per reply: integer parser %.0f ns (max %.0f ns), String path %.0f ns", newNs, parseMaxCycles * 1000.0 / ( F_CPU_ACTUAL / 1000000 ), legacyNs );
+	TEST_MESSAGE( message );
+
+	TEST_ASSERT_GREATER_THAN_UINT32( 0, parseMeanCycles );
+}
+
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST( test_int32_extremes_are_accepted );
+	RUN_TEST( test_values_outside_int32_are_malformed );
+	RUN_TEST( test_polling_does_not_allocate );
+	RUN_TEST( test_benchmark_against_the_string_path );
+	return UNITY_END();
+}
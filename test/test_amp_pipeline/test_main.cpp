@@ -0,0 +1,187 @@
+/**
+ * @file test_main.cpp
+ * @brief Per-port sensor query pipeline against three simulated amplifiers
+ *
+ * Each port keeps its own query in flight and every response triggers the
+ * next one, so all three amplifiers are polled at once. The old round-robin
+ * asked one amplifier per 300 Hz tick, so each motor updated at 50 Hz.
+ */
+
+#include <unity.h>
+
+#include "SharedMemory.h"
+#include "SimulatedAmp.h"
+
+
+const float	   CONST_ROUND_ROBIN_RATE_HZ = 50.0f;	  // Current / position rate per motor before the pipeline
+const uint32_t CONST_RATE_WINDOW_US		 = 1000000;	  // Measurement window
+
+
+void setUp() {
+	CreateAmpBench();
+}
+
+void tearDown() {
+	DestroyAmpBench();
+}
+
+
+void test_every_amplifier_comes_up() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+	TEST_ASSERT_TRUE( Shared->Interface.HWSerial.isConnected );
+	TEST_ASSERT_TRUE( Shared->Drive.Flags.isCurrentControlled );
+	TEST_ASSERT_EQUAL_STRING( "SimAmpA", Shared->Interface.HWSerial.Connection.ampNameA.c_str() );
+	TEST_ASSERT_EQUAL_STRING( "SimAmpB", Shared->Interface.HWSerial.Connection.ampNameB.c_str() );
+	TEST_ASSERT_EQUAL_STRING( "SimAmpC", Shared->Interface.HWSerial.Connection.ampNameC.c_str() );
+}
+
+
+void test_each_motor_updates_at_least_three_times_faster() {
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+	Bench->Run( *Amplifier, 100000 );
+
+	// Each published sample is one current or one position reading
+	AmpSampleStruct before[CONST_AMP_COUNT];
+	AmpSampleStruct after[CONST_AMP_COUNT];
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( amp, before[amp] ) );
+	Bench->Run( *Amplifier, CONST_RATE_WINDOW_US );
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( amp, after[amp] ) );
+
+	for ( uint8_t amp = 0; amp < CONST_AMP_COUNT; amp++ ) {
+		float rateHz = ( after[amp].sequence - before[amp].sequence ) / 2.0f * 1000000.0f / CONST_RATE_WINDOW_US;
+
+		char message[80];
+		snprintf( message, sizeof( message ), "Amplifier %c: %.0f Hz current and position (was %.0f Hz)", 'A' + amp, rateHz, CONST_ROUND_ROBIN_RATE_HZ );
+		TEST_MESSAGE( message );
+
+		TEST_ASSERT_TRUE_MESSAGE( rateHz >= 3.0f * CONST_ROUND_ROBIN_RATE_HZ, message );
+	}
+}
+
+
+void test_ports_are_polled_at_the_same_time() {
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+
+	// Count the steps during which all three amplifiers have a reply on the wire
+	uint32_t sent[CONST_AMP_COUNT] = { Bench->A.replies, Bench->B.replies, Bench->C.replies };
+	uint32_t stepsAllBusy		   = 0;
+	for ( uint32_t step = 0; step < 1000; step++ ) {
+		Bench->Run( *Amplifier, 100 );
+		if ( Bench->A.replies > sent[0] && Bench->B.replies > sent[1] && Bench->C.replies > sent[2] ) stepsAllBusy++;
+		sent[0] = Bench->A.replies;
+		sent[1] = Bench->B.replies;
+		sent[2] = Bench->C.replies;
+	}
+
+	// Round-robin would never answer on more than one port in the same 100 us
+	TEST_ASSERT_GREATER_THAN( 100, stepsAllBusy );
+}
+
+
+void test_values_land_in_their_own_fields() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+	Bench->Run( *Amplifier, 600000 );
+
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, 1.23f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsA );
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, -0.45f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsB );
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, 6.78f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsC );
+	TEST_ASSERT_EQUAL_INT32( 1000, Shared->Sensors.MotorEncoders.rawCountA );
+	TEST_ASSERT_EQUAL_INT32( -2000, Shared->Sensors.MotorEncoders.rawCountB );
+	TEST_ASSERT_EQUAL_INT32( 300000, Shared->Sensors.MotorEncoders.rawCountC );
+	TEST_ASSERT_FLOAT_WITHIN( 0.01f, 48.0f, Shared->Sensors.AmplifierTelemetry.busVoltageA );
+	TEST_ASSERT_FLOAT_WITHIN( 0.01f, 35.0f, Shared->Sensors.AmplifierTelemetry.driveTempDegCC );
+}
+
+
+void test_readings_follow_the_amplifier() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+	Bench->Run( *Amplifier, 100000 );
+
+	Bench->B.SetRegister( CONST_COPLEY_REG_CURRENT, 250 );
+	Bench->B.SetRegister( CONST_COPLEY_REG_POSITION, -123456 );
+	Bench->Run( *Amplifier, 10000 );
+
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, 2.5f, Shared->Sensors.MotorCurrents.measuredCurrentAmpsB );
+	TEST_ASSERT_EQUAL_INT32( -123456, Shared->Sensors.MotorEncoders.rawCountB );
+
+	AmpSampleStruct sample;
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 1, sample ) );
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, 2.5f, sample.currentAmps );
+}
+
+
+void test_failed_amplifier_does_not_stall_the_others() {
+
+	auto Shared = SYSTEM_GLOBAL.GetData();
+
+	// Amplifier C never answers
+	Bench->C.dropNext = UINT32_MAX;
+	TEST_ASSERT_TRUE( Bench->Start( *Amplifier, EnumsClass::AmplifierProtocolEnum::ASCII ) );
+	TEST_ASSERT_EQUAL_UINT32( 0, Shared->Interface.HWSerial.Connection.baudRateC );
+
+	AmpSampleStruct before;
+	AmpSampleStruct after;
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 0, before ) );
+	Bench->Run( *Amplifier, 100000 );
+	TEST_ASSERT_TRUE( Amplifier->ReadLatestSample( 0, after ) );
+	TEST_ASSERT_GREATER_OR_EQUAL_UINT32( uint32_t( 2 * 3 * CONST_ROUND_ROBIN_RATE_HZ / 10 ), after.sequence - before.sequence );	// 100 ms at three times the old rate, two samples per reading
+}
+
+
+void test_poll_table_keeps_divisors_in_phase() {
+
+	PollTableStruct Table;
+	int32_t			value = 0;
+	Table.Add( CONST_COPLEY_REG_CURRENT, 0, 1, &value, nullptr, 1.0f );
+	Table.Add( CONST_COPLEY_REG_STATUS, 0, 3, &value, nullptr, 1.0f );
+	Table.Add( CONST_COPLEY_REG_BUS_VOLTAGE, 0, 10, &value, nullptr, 1.0f );
+	Table.Add( CONST_COPLEY_REG_POSITION, 1, 1, &value, nullptr, 1.0f );
+
+	// Run across the point where a 16-bit pass count would wrap
+	uint8_t	 cursor		 = 0;
+	uint32_t pass		 = 65536 - 30;
+	uint32_t polled[3]	 = {};
+	uint32_t lastPass[3] = {};
+	while ( pass < 65536 + 30 ) {
+		int8_t entry = Table.Next( 0, cursor, pass );
+		TEST_ASSERT_TRUE( entry >= 0 && entry < 3 );
+
+		// Every poll of an entry is exactly its divisor passes after the previous one
+		if ( polled[entry] > 0 ) TEST_ASSERT_EQUAL_UINT32( Table.entry[entry].rateDivisor, pass - lastPass[entry] );
+		lastPass[entry] = pass;
+		polled[entry]++;
+	}
+	TEST_ASSERT_EQUAL_UINT32( 20, polled[1] );
+	TEST_ASSERT_EQUAL_UINT32( 6, polled[2] );
+
+	// An amplifier with nothing in the table costs one pass over it, not a long search
+	cursor		   = 0;
+	uint32_t start = pass;
+	TEST_ASSERT_EQUAL_INT( -1, Table.Next( 2, cursor, pass ) );
+	TEST_ASSERT_EQUAL_UINT8( 0, cursor );
+	TEST_ASSERT_EQUAL_UINT32( start + 1, pass );
+}
+
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST( test_every_amplifier_comes_up );
+	RUN_TEST( test_each_motor_updates_at_least_three_times_faster );
+	RUN_TEST( test_ports_are_polled_at_the_same_time );
+	RUN_TEST( test_values_land_in_their_own_fields );
+	RUN_TEST( test_readings_follow_the_amplifier );
+	RUN_TEST( test_failed_amplifier_does_not_stall_the_others );
+	RUN_TEST( test_poll_table_keeps_divisors_in_phase );
+	return UNITY_END();
+}
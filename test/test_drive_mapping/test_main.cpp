@@ -0,0 +1,193 @@
+/**
+ * @file test_main.cpp
+ * @brief Fixed-point and table drive mappings against the float sector blend
+ *
+ * MapFloatReference is the float path of MapPolarTermsToCommandOutput and
+ * MapPercentageToPwmABC without the shared PWM fields, so every heading is
+ * compared with its own reference and nothing else writes to it.
+ */
+
+#include <unity.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Amplifier.h"
+
+
+const uint8_t CONST_CHECK_MAGNITUDES[] = { 0, 1, 10, 25, 33, 50, 75, 99, 100 };	   // Percent
+
+static const MappingStruct Mapping;
+static volatile int32_t	   sink = 0;	// Keeps the timed loops from being optimized away
+
+
+/**
+ * @brief Float sector blend and PWM conversion, as in the firmware's float path
+ */
+static void MapFloatReference( float theta, float magnitude, int16_t* pwm ) {
+
+	if ( theta < 0 ) theta += 360.0f;
+
+	float thetaTarget	  = radians( theta );
+	float targetMagnitude = magnitude / 100.0f;
+	float thetaAT		  = 0.0f;
+	float thetaBT		  = 0.0f;
+	float thetaCT		  = 0.0f;
+	float percentage[3]	  = {};
+
+	if ( thetaTarget >= Mapping.thetaC || thetaTarget < Mapping.thetaA ) {
+		if ( thetaTarget < Mapping.thetaA ) {
+			thetaAT = Mapping.thetaA - thetaTarget;
+			thetaCT = Mapping.angleAC - thetaAT;
+		}
+		if ( thetaTarget >= Mapping.thetaC ) {
+			thetaCT = thetaTarget - Mapping.thetaC;
+			thetaAT = Mapping.angleAC - thetaCT;
+		}
+		percentage[0] = ( 1.0f - ( thetaAT / Mapping.angleAC ) ) * targetMagnitude;
+		percentage[2] = ( 1.0f - ( thetaCT / Mapping.angleAC ) ) * targetMagnitude;
+	} else if ( thetaTarget < Mapping.thetaB ) {
+		thetaAT		  = thetaTarget - Mapping.thetaA;
+		thetaBT		  = Mapping.angleAB - thetaAT;
+		percentage[0] = ( 1.0f - ( thetaAT / Mapping.angleAB ) ) * targetMagnitude;
+		percentage[1] = ( 1.0f - ( thetaBT / Mapping.angleAB ) ) * targetMagnitude;
+	} else {
+		thetaBT		  = thetaTarget - Mapping.thetaB;
+		thetaCT		  = Mapping.angleBC - thetaBT;
+		percentage[1] = ( 1.0f - ( thetaBT / Mapping.angleBC ) ) * targetMagnitude;
+		percentage[2] = ( 1.0f - ( thetaCT / Mapping.angleBC ) ) * targetMagnitude;
+	}
+
+	for ( uint8_t channel = 0; channel < 3; channel++ ) {
+		pwm[channel] = int16_t( std::clamp( 2048 - int( percentage[channel] * 2047 ), 4, 2044 ) );
+	}
+}
+
+
+void setUp() {}
+
+void tearDown() {}
+
+
+/**
+ * @brief Largest difference from the reference over every centidegree at every check magnitude
+ */
+static int16_t MaxDiffFromReference( void ( *Map )( int32_t, int32_t, int16_t* ), uint32_t& outOfTolerance ) {
+
+	int16_t maxDiff = 0;
+	outOfTolerance	= 0;
+
+	for ( uint8_t magnitude : CONST_CHECK_MAGNITUDES ) {
+		for ( int32_t headingCdeg = 0; headingCdeg < CONST_MAP_CDEG_FULL; headingCdeg++ ) {
+
+			int16_t reference[3];
+			int16_t pwm[3];
+			MapFloatReference( headingCdeg / 100.0f, float( magnitude ), reference );
+			Map( headingCdeg, int32_t( magnitude ) * CONST_Q15_ONE / 100, pwm );
+
+			for ( uint8_t channel = 0; channel < 3; channel++ ) {
+				int16_t diff = int16_t( abs( pwm[channel] - reference[channel] ) );
+				if ( diff > maxDiff ) maxDiff = diff;
+				if ( diff > CONST_MAP_PWM_TOLERANCE ) outOfTolerance++;
+			}
+		}
+	}
+	return maxDiff;
+}
+
+
+void test_q15_mapping_matches_the_float_reference() {
+
+	uint32_t outOfTolerance = 0;
+	int16_t	 maxDiff		= MaxDiffFromReference( MapPolarTermsToPwmQ15, outOfTolerance );
+
+	char message[80];
+	snprintf( message, sizeof( message ), "Q15: max diff %d counts, %u outside +/-%d", maxDiff, unsigned( outOfTolerance ), CONST_MAP_PWM_TOLERANCE );
+	TEST_MESSAGE( message );
+	TEST_ASSERT_EQUAL_UINT32( 0, outOfTolerance );
+}
+
+
+void test_table_mapping_matches_the_float_reference() {
+
+	uint32_t outOfTolerance = 0;
+	int16_t	 maxDiff		= MaxDiffFromReference( MapPolarTermsToPwmLut, outOfTolerance );
+
+	char message[80];
+	snprintf( message, sizeof( message ), "Table: max diff %d counts, %u outside +/-%d", maxDiff, unsigned( outOfTolerance ), CONST_MAP_PWM_TOLERANCE );
+	TEST_MESSAGE( message );
+	TEST_ASSERT_EQUAL_UINT32( 0, outOfTolerance );
+}
+
+
+void test_headings_wrap_outside_one_turn() {
+
+	int16_t expected[3];
+	int16_t pwm[3];
+
+	const int32_t headings[] = { 0, 3500, 12345, 27000, 35999 };
+	for ( int32_t headingCdeg : headings ) {
+
+		MapPolarTermsToPwmQ15( headingCdeg, CONST_Q15_ONE / 2, expected );
+
+		MapPolarTermsToPwmQ15( headingCdeg - CONST_MAP_CDEG_FULL, CONST_Q15_ONE / 2, pwm );
+		TEST_ASSERT_EQUAL_INT16_ARRAY( expected, pwm, 3 );
+		MapPolarTermsToPwmQ15( headingCdeg + 2 * CONST_MAP_CDEG_FULL, CONST_Q15_ONE / 2, pwm );
+		TEST_ASSERT_EQUAL_INT16_ARRAY( expected, pwm, 3 );
+		MapPolarTermsToPwmLut( headingCdeg - CONST_MAP_CDEG_FULL, CONST_Q15_ONE / 2, pwm );
+		TEST_ASSERT_EQUAL_INT16_ARRAY( expected, pwm, 3 );
+	}
+}
+
+
+void test_benchmark_the_three_paths() {
+
+	const uint8_t CONST_REPEATS = 20;
+	int16_t		  pwm[3];
+
+	auto start = std::chrono::steady_clock::now();
+	for ( uint8_t repeat = 0; repeat < CONST_REPEATS; repeat++ ) {
+		for ( int32_t headingCdeg = 0; headingCdeg < CONST_MAP_CDEG_FULL; headingCdeg++ ) {
+			MapFloatReference( headingCdeg / 100.0f, 50.0f, pwm );
+			sink = sink + pwm[0];
+		}
+	}
+	auto floatDone = std::chrono::steady_clock::now();
+	for ( uint8_t repeat = 0; repeat < CONST_REPEATS; repeat++ ) {
+		for ( int32_t headingCdeg = 0; headingCdeg < CONST_MAP_CDEG_FULL; headingCdeg++ ) {
+			MapPolarTermsToPwmQ15( headingCdeg, CONST_Q15_ONE / 2, pwm );
+			sink = sink + pwm[0];
+		}
+	}
+	auto fixedDone = std::chrono::steady_clock::now();
+	for ( uint8_t repeat = 0; repeat < CONST_REPEATS; repeat++ ) {
+		for ( int32_t headingCdeg = 0; headingCdeg < CONST_MAP_CDEG_FULL; headingCdeg++ ) {
+			MapPolarTermsToPwmLut( headingCdeg, CONST_Q15_ONE / 2, pwm );
+			sink = sink + pwm[0];
+		}
+	}
+	auto tableDone = std::chrono::steady_clock::now();
+
+	double calls   = double( CONST_REPEATS ) * CONST_MAP_CDEG_FULL;
+	double floatNs = std::chrono::duration<double, std::nano>( floatDone - start ).count() / calls;
+	double fixedNs = std::chrono::duration<double, std::nano>( fixedDone - floatDone ).count() / calls;
+	double tableNs = std::chrono::duration<double, std::nano>( tableDone - fixedDone ).count() / calls;
+
+	char message[100];
+	snprintf( message, sizeof( message ), "Host time per mapping: float %.1f ns, Q15 %.1f ns, table %.1f ns", floatNs, fixedNs, tableNs );
+	TEST_MESSAGE( message );
+	TEST_ASSERT_TRUE( floatNs > 0.0 && fixedNs > 0.0 && tableNs > 0.0 );
+}
+
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST( test_q15_mapping_matches_the_float_reference );
+	RUN_TEST( test_table_mapping_matches_the_float_reference );
+	RUN_TEST( test_headings_wrap_outside_one_turn );
+	RUN_TEST( test_benchmark_the_three_paths );
+	return UNITY_END();
+}
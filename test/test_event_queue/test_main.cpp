@@ -0,0 +1,170 @@
+/**
+ * @file test_main.cpp
+ * @brief EventQueueStruct under a producer thread and a consumer thread
+ *
+ * Each event carries its sequence number several times over, so an event
+ * read while it was still being written, read twice, skipped or reordered
+ * shows up as a mismatch. On the Teensy the producer is an ISR and cannot
+ * wait; here it can, which is what the lossless test relies on.
+ */
+
+#include <unity.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "EventQueue.h"
+
+
+const uint32_t CONST_STRESS_EVENTS	 = 2000000;	   // Events per run
+const uint16_t CONST_STRESS_CAPACITY = 64;		   // Ring size under test
+
+/**
+ * @brief Event wider than one store, so a torn read is visible
+ */
+struct StressEventStruct {
+	uint32_t sequence	= 0;	 // Push order
+	uint32_t inverse	= 0;	 // ~sequence
+	uint32_t payload[4] = {};	 // sequence * ( i + 1 )
+};
+
+static StressEventStruct MakeEvent( uint32_t sequence ) {
+	StressEventStruct Event;
+	Event.sequence = sequence;
+	Event.inverse  = ~sequence;
+	for ( uint8_t i = 0; i < 4; i++ ) Event.payload[i] = sequence * ( i + 1 );
+	return Event;
+}
+
+static bool IsIntact( const StressEventStruct& Event ) {
+	if ( Event.inverse != ~Event.sequence ) return false;
+	for ( uint8_t i = 0; i < 4; i++ ) {
+		if ( Event.payload[i] != Event.sequence * ( i + 1 ) ) return false;
+	}
+	return true;
+}
+
+
+void setUp() {}
+
+void tearDown() {}
+
+
+void test_every_event_arrives_once_and_in_order() {
+
+	static EventQueueStruct<StressEventStruct, CONST_STRESS_CAPACITY> Queue;
+
+	// Producer retries on a full ring
+	uint32_t fullRetries = 0;
+	std::thread producer( [&]() {
+		for ( uint32_t sequence = 0; sequence < CONST_STRESS_EVENTS; sequence++ ) {
+			StressEventStruct Event = MakeEvent( sequence );
+			while ( !Queue.Push( Event ) ) {
+				fullRetries++;
+				std::this_thread::yield();
+			}
+		}
+	} );
+
+	uint32_t		  expected	 = 0;
+	uint32_t		  torn		 = 0;
+	uint32_t		  outOfOrder = 0;
+	StressEventStruct Event;
+	while ( expected < CONST_STRESS_EVENTS ) {
+		if ( !Queue.Pop( Event ) ) {
+			std::this_thread::yield();
+			continue;
+		}
+		if ( !IsIntact( Event ) ) torn++;
+		if ( Event.sequence != expected ) outOfOrder++;
+		expected = Event.sequence + 1;
+	}
+	producer.join();
+
+	char message[120];
+	snprintf( message, sizeof( message ), "%u events, %u pushes refused on a full ring, high water %u", unsigned( CONST_STRESS_EVENTS ), unsigned( fullRetries ), unsigned( Queue.highWater ) );
+	TEST_MESSAGE( message );
+
+	TEST_ASSERT_EQUAL_UINT32( 0, torn );
+	TEST_ASSERT_EQUAL_UINT32( 0, outOfOrder );
+	TEST_ASSERT_FALSE( Queue.Pop( Event ) );
+	TEST_ASSERT_EQUAL_UINT32( CONST_STRESS_EVENTS, Queue.pushed );
+	TEST_ASSERT_EQUAL_UINT32( fullRetries, Queue.dropped );
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32( CONST_STRESS_CAPACITY, Queue.highWater );
+}
+
+
+void test_full_ring_drops_new_events_and_counts_them() {
+
+	static EventQueueStruct<StressEventStruct, CONST_STRESS_CAPACITY> Queue;
+
+	// Producer never waits, like an ISR; the consumer is slowed down so the ring fills
+	std::atomic<bool> isDone{ false };
+	std::thread producer( [&]() {
+		for ( uint32_t sequence = 0; sequence < CONST_STRESS_EVENTS; sequence++ ) {
+			Queue.Push( MakeEvent( sequence ) );
+			if ( ( sequence & 0xFF ) == 0 ) std::this_thread::yield();
+		}
+		isDone = true;
+	} );
+
+	uint32_t		  received = 0;
+	uint32_t		  torn	   = 0;
+	uint32_t		  repeated = 0;
+	int64_t			  last	   = -1;
+	StressEventStruct Event;
+	while ( true ) {
+		bool wasDone = isDone;
+		if ( !Queue.Pop( Event ) ) {
+			if ( wasDone ) break;
+			std::this_thread::yield();
+			continue;
+		}
+		if ( !IsIntact( Event ) ) torn++;
+		if ( int64_t( Event.sequence ) <= last ) repeated++;
+		last = Event.sequence;
+		received++;
+		if ( ( received & 0x3F ) == 0 ) std::this_thread::yield();
+	}
+	producer.join();
+
+	char message[120];
+	snprintf( message, sizeof( message ), "%u of %u events received, %u dropped", unsigned( received ), unsigned( CONST_STRESS_EVENTS ), unsigned( Queue.dropped ) );
+	TEST_MESSAGE( message );
+
+	// Gaps are allowed, going backwards (an overwritten slot read late) is not
+	TEST_ASSERT_EQUAL_UINT32( 0, torn );
+	TEST_ASSERT_EQUAL_UINT32( 0, repeated );
+	TEST_ASSERT_EQUAL_UINT32( Queue.pushed, received );
+	TEST_ASSERT_EQUAL_UINT32( CONST_STRESS_EVENTS, Queue.pushed + Queue.dropped );
+}
+
+
+void test_clear_discards_only_what_was_pushed() {
+
+	EventQueueStruct<StressEventStruct, CONST_STRESS_CAPACITY> Queue;
+	StressEventStruct										   Event;
+
+	for ( uint32_t sequence = 0; sequence < CONST_STRESS_CAPACITY; sequence++ ) TEST_ASSERT_TRUE( Queue.Push( MakeEvent( sequence ) ) );
+	TEST_ASSERT_FALSE( Queue.Push( MakeEvent( CONST_STRESS_CAPACITY ) ) );
+	TEST_ASSERT_EQUAL_UINT16( CONST_STRESS_CAPACITY, Queue.Count() );
+
+	Queue.Clear();
+	TEST_ASSERT_TRUE( Queue.IsEmpty() );
+	TEST_ASSERT_FALSE( Queue.Pop( Event ) );
+
+	TEST_ASSERT_TRUE( Queue.Push( MakeEvent( 7 ) ) );
+	TEST_ASSERT_TRUE( Queue.Pop( Event ) );
+	TEST_ASSERT_EQUAL_UINT32( 7, Event.sequence );
+	TEST_ASSERT_EQUAL_UINT32( 1, Queue.dropped );
+}
+
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST( test_every_event_arrives_once_and_in_order );
+	RUN_TEST( test_full_ring_drops_new_events_and_counts_them );
+	RUN_TEST( test_clear_discards_only_what_was_pushed );
+	return UNITY_END();
+}
@@ -0,0 +1,193 @@
+/**
+ * @file test_main.cpp
+ * @brief Current trim and position hold against the motor/cable plant model
+ *
+ * The controller runs at the 1 kHz output rate and sees current and position
+ * every third tick, as the amplifier pipeline delivers them. The plant's drive
+ * has a gain and offset error, so an open-loop command misses its current,
+ * and a disturbance pushes on the cable halfway through each run.
+ */
+
+#include <unity.h>
+
+#include <cstdio>
+
+#include "MotorControl.h"
+
+
+const float	   CONST_RUN_COMMAND_AMPS	  = 0.5f;		// Open-loop current command
+const float	   CONST_RUN_DISTURBANCE	  = -4000.0f;	// Disturbance acceleration (counts/s^2)
+const uint16_t CONST_RUN_DISTURBANCE_TICK = 1500;		// Disturbance starts (and hold engages)
+const uint16_t CONST_RUN_TICKS			  = 2500;		// Run length (1 ms ticks)
+const uint8_t  CONST_RUN_SAMPLE_TICKS	  = 3;			// Ticks between sensor samples
+const float	   CONST_RUN_DT_S			  = 0.001f;		// Tick period
+
+
+enum class ControlCaseEnum : uint8_t { OPEN_LOOP, CURRENT_TRIM, TRIM_AND_HOLD };
+
+/**
+ * @brief What one run measured
+ */
+struct ControlRunStruct {
+	float	 currentErrorAmps = 0.0f;	 // |command - delivered| just before the disturbance
+	float	 peakDeviation	  = 0.0f;	 // Largest position change after the disturbance (counts)
+	float	 finalDeviation	  = 0.0f;	 // Position change at the end of the run (counts)
+	uint32_t saturations	  = 0;		 // Ticks with the output clamped
+};
+
+static ControlRunStruct RunCase( ControlCaseEnum controlCase ) {
+
+	const MotorControlGainsStruct Gains;
+	MotorPlantModelStruct		  Plant;
+	MotorControllerStruct		  Control;
+	ControlRunStruct			  Run;
+
+	uint32_t sampleUs	 = 0;
+	float	 sampleAmps	 = 0.0f;
+	int32_t	 sampleCount = 0;
+	float	 holdRef	 = 0.0f;
+
+	for ( uint16_t tick = 0; tick < CONST_RUN_TICKS; tick++ ) {
+
+		// Sampled sensors
+		if ( tick % CONST_RUN_SAMPLE_TICKS == 0 ) {
+			sampleAmps	= Plant.currentAmps;
+			sampleCount = int32_t( lroundf( Plant.positionCounts ) );
+			sampleUs	= uint32_t( tick + 1 ) * 1000;
+			Control.OnPosition( sampleCount, sampleUs );
+		}
+
+		if ( tick == CONST_RUN_DISTURBANCE_TICK ) {
+			Run.currentErrorAmps = fabsf( CONST_RUN_COMMAND_AMPS - Plant.currentAmps );
+			holdRef				 = Plant.positionCounts;
+			if ( controlCase == ControlCaseEnum::TRIM_AND_HOLD ) Control.StartHold( sampleCount );
+		}
+
+		float output = CONST_RUN_COMMAND_AMPS;
+		if ( controlCase != ControlCaseEnum::OPEN_LOOP ) {
+			output = Control.Update( Gains, CONST_RUN_COMMAND_AMPS, sampleAmps, sampleUs, sampleCount );
+		}
+
+		Plant.Step( output, tick >= CONST_RUN_DISTURBANCE_TICK ? CONST_RUN_DISTURBANCE : 0.0f, CONST_RUN_DT_S );
+
+		if ( tick >= CONST_RUN_DISTURBANCE_TICK ) {
+			Run.finalDeviation = fabsf( Plant.positionCounts - holdRef );
+			if ( Run.finalDeviation > Run.peakDeviation ) Run.peakDeviation = Run.finalDeviation;
+		}
+	}
+
+	Run.saturations = Control.saturations;
+	return Run;
+}
+
+static void Report( const char* name, const ControlRunStruct& Run ) {
+	char message[120];
+	snprintf( message, sizeof( message ), "%s: current error %.3f A, disturbance peak/final %.1f/%.1f counts, saturated %u",
+			  name, Run.currentErrorAmps, Run.peakDeviation, Run.finalDeviation, unsigned( Run.saturations ) );
+	TEST_MESSAGE( message );
+}
+
+
+/**
+ * @brief Run at the nominal command for a second, return the last tick the current was more than 10 mA off
+ */
+static uint16_t SettleTicks( const MotorControlGainsStruct& Gains, MotorPlantModelStruct& Plant, MotorControllerStruct& Control, uint16_t firstTick ) {
+
+	uint16_t settleTicks = 0;
+	uint32_t sampleUs	 = 0;
+	float	 sampleAmps	 = 0.0f;
+
+	for ( uint16_t tick = firstTick; tick < firstTick + 1000; tick++ ) {
+		if ( tick == firstTick || tick % CONST_RUN_SAMPLE_TICKS == 0 ) {
+			sampleAmps = Plant.currentAmps;
+			sampleUs   = uint32_t( tick + 1 ) * 1000;
+		}
+		Plant.Step( Control.Update( Gains, CONST_RUN_COMMAND_AMPS, sampleAmps, sampleUs, 0 ), 0.0f, CONST_RUN_DT_S );
+		if ( fabsf( CONST_RUN_COMMAND_AMPS - Plant.currentAmps ) >= 0.01f ) settleTicks = uint16_t( tick - firstTick + 1 );
+	}
+	return settleTicks;
+}
+
+
+void setUp() {}
+
+void tearDown() {}
+
+
+void test_current_trim_removes_the_drive_error() {
+
+	ControlRunStruct OpenLoop = RunCase( ControlCaseEnum::OPEN_LOOP );
+	ControlRunStruct Trim	  = RunCase( ControlCaseEnum::CURRENT_TRIM );
+	Report( "Open loop", OpenLoop );
+	Report( "Current trim", Trim );
+
+	// Plant delivers 0.8 * 0.5 - 0.05 = 0.35 A open loop
+	TEST_ASSERT_FLOAT_WITHIN( 0.005f, 0.15f, OpenLoop.currentErrorAmps );
+	TEST_ASSERT_TRUE( Trim.currentErrorAmps < 0.01f );
+	TEST_ASSERT_EQUAL_UINT32( 0, Trim.saturations );
+}
+
+
+void test_position_hold_rejects_the_disturbance() {
+
+	ControlRunStruct Trim = RunCase( ControlCaseEnum::CURRENT_TRIM );
+	ControlRunStruct Hold = RunCase( ControlCaseEnum::TRIM_AND_HOLD );
+	Report( "Current trim", Trim );
+	Report( "Trim and hold", Hold );
+
+	// Holding keeps the current error down as well
+	TEST_ASSERT_TRUE( Hold.currentErrorAmps < 0.01f );
+	TEST_ASSERT_TRUE( Hold.peakDeviation < 0.5f * Trim.peakDeviation );
+	TEST_ASSERT_TRUE( Hold.finalDeviation < 0.25f * Trim.finalDeviation );
+}
+
+
+void test_integrator_does_not_wind_up_while_saturated() {
+
+	const MotorControlGainsStruct Gains;
+	MotorPlantModelStruct		  Plant;
+	MotorControllerStruct		  Control;
+
+	// Full-scale command: the drive delivers less than asked, so the output pins at full scale
+	float	 integralAtSaturation = 0.0f;
+	bool	 hasSaturated		  = false;
+	uint32_t sampleUs			  = 0;
+	float	 sampleAmps			  = 0.0f;
+	for ( uint16_t tick = 0; tick < 1000; tick++ ) {
+		if ( tick % CONST_RUN_SAMPLE_TICKS == 0 ) {
+			sampleAmps = Plant.currentAmps;
+			sampleUs   = uint32_t( tick + 1 ) * 1000;
+		}
+		float output = Control.Update( Gains, CONST_CONTROL_FULL_SCALE_AMPS, sampleAmps, sampleUs, 0 );
+		if ( Control.saturations > 0 && !hasSaturated ) {
+			hasSaturated		 = true;
+			integralAtSaturation = Control.integralAmps;
+		}
+		Plant.Step( output, 0.0f, CONST_RUN_DT_S );
+	}
+
+	TEST_ASSERT_TRUE( hasSaturated );
+	TEST_ASSERT_GREATER_THAN_UINT32( 900, Control.saturations );
+	TEST_ASSERT_FLOAT_WITHIN( 0.001f, integralAtSaturation, Control.integralAmps );
+	TEST_ASSERT_TRUE( Control.integralAmps < Gains.trimLimitAmps );
+
+	// Back inside the range, the trim settles about as fast as from rest
+	MotorPlantModelStruct RestPlant;
+	MotorControllerStruct RestControl;
+	uint16_t			  restTicks	  = SettleTicks( Gains, RestPlant, RestControl, 0 );
+	uint16_t			  settleTicks = SettleTicks( Gains, Plant, Control, 1000 );
+
+	char message[100];
+	snprintf( message, sizeof( message ), "Saturated %u ticks, settled in %u ms (%u ms from rest)", unsigned( Control.saturations ), unsigned( settleTicks ), unsigned( restTicks ) );
+	TEST_MESSAGE( message );
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32( restTicks + 20, settleTicks );
+}
+
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST( test_current_trim_removes_the_drive_error );
+	RUN_TEST( test_position_hold_rejects_the_disturbance );
+	RUN_TEST( test_integrator_does_not_wind_up_while_saturated );
+	return UNITY_END();
+}